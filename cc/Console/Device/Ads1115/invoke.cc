@@ -2,6 +2,7 @@
 
 #include <Device/Ads1115/Bang/Host.h>
 #include <Device/Ads1115/Bang/Generator.h>
+#include <Device/Ads1115/Bsc/Host.h>
 #include "../invoke.h"
 #include <Neat/cast.h>
 #include <Ui/strto.h>
@@ -9,6 +10,7 @@
 #include <deque>
 #include <iostream>
 #include <math.h>
+#include <thread>
 
 using namespace Device::Ads1115 ; // Circuit
 using namespace Bang ; // Config,Record,Generator,Host
@@ -82,6 +84,52 @@ static void resetInvoke(Rpi::Peripheral *rpi,Config const &config,Ui::ArgL *argL
     std::cout << (success ? "success\n" : "error\n") ;
 }
     
+static void streamInvoke(Rpi::Peripheral *rpi,Config const &config,Ui::ArgL *argL)
+{
+    auto n = Ui::strto<size_t>(argL->pop()) ;
+    auto word = Ui::strto<uint16_t>(argL->option("-w","0x04e0")) ;
+    auto rdy = argL->pop_if("-r") ;
+    auto rdyPin = rdy ? Ui::strto(argL->pop(),Rpi::Pin()) : Rpi::Pin() ;
+    argL->finalize() ;
+    
+    Host host(rpi,config) ;
+    if (rdy)
+    {
+	auto records = host.ready(rdyPin) ;
+	if (!records[0].verify(config.sdaPin).success() ||
+	    !records[1].verify(config.sdaPin).success())
+	    throw std::runtime_error("Ads1115:cannot write thresholds") ;
+    }
+    if (!host.startContinuous(word).verify(config.sdaPin).success())
+	throw std::runtime_error("Ads1115:cannot write config") ;
+
+    auto timeout = static_cast<uint32_t>(Rpi::ArmTimer(rpi).frequency() / 4) ;
+    // ...the slowest data-rate is 8/s
+
+    size_t nerrors = 0 ; size_t ntimeouts = 0 ; int64_t total = 0 ;
+    auto t0 = std::chrono::steady_clock::now() ;
+    for (decltype(n) i=0 ; i<n ; ++i)
+    {
+	if (rdy && !host.waitReady(timeout))
+	    ++ntimeouts ;
+	auto record = host.readNext() ;
+	if (!record.verify(config.sdaPin).success())
+	    ++nerrors ;
+	total += static_cast<int16_t>(record.fetch(config.sdaPin)) ;
+    }
+    auto t1 = std::chrono::steady_clock::now() ;
+
+    auto rate = static_cast<double>(n)/std::chrono::duration<double>(t1-t0).count() ;
+    auto avg = static_cast<double>(total) / static_cast<double>(n) ;
+
+    std::cout.setf(std::ios::scientific) ;
+    std::cout.precision(2) ;
+    std::cout << "errors: " << nerrors << '\n' ;
+    if (rdy)
+	std::cout << "timeouts: " << ntimeouts << '\n' ;
+    std::cout << rate << "/s (" << avg << ")\n" ;
+}
+    
 static void sampleInvoke(Rpi::Peripheral *rpi,Config const &config,Ui::ArgL *argL)
 {
     argL->finalize() ;
@@ -92,20 +140,140 @@ static void sampleInvoke(Rpi::Peripheral *rpi,Config const &config,Ui::ArgL *arg
     std::cout << static_cast<int16_t>(record.fetch(config.sdaPin)) << '\n' ;
 }
 
+// ----[ I2C controller (BSC) ]----------------------------------------
+
+static void bscConfigInvoke(Bsc::Host *host,Ui::ArgL *argL)
+{
+    if (argL->empty())
+    {
+	std::cout << std::hex << host->readConfig() << '\n' ;
+    }
+    else
+    {
+	auto word = Ui::strto<uint16_t>(argL->pop()) ;
+	argL->finalize() ;
+	host->writeConfig(word) ;
+    }
+}
+
+static void bscRateInvoke(Bsc::Host *host,Ui::ArgL *argL)
+{
+    auto n = Ui::strto<size_t>(argL->pop()) ;
+    argL->finalize() ;
+    int64_t total = 0 ;
+    auto t0 = std::chrono::steady_clock::now() ;
+    for (decltype(n) i=0 ; i<n ; ++i)
+	total += static_cast<int16_t>(host->convert(0x8583)) ;
+    auto t1 = std::chrono::steady_clock::now() ;
+
+    auto rate = static_cast<double>(n)/std::chrono::duration<double>(t1-t0).count() ;
+    auto avg = 2.048 / 0x8000 * static_cast<double>(total) / static_cast<double>(n) ;
+
+    std::cout.setf(std::ios::scientific) ;
+    std::cout.precision(2) ;
+    std::cout << rate << "/s (" << avg << ")\n" ;
+}
+
+static void bscStreamInvoke(Bsc::Host *host,Ui::ArgL *argL)
+{
+    auto n = Ui::strto<size_t>(argL->pop()) ;
+    auto word = Ui::strto<uint16_t>(argL->option("-w","0x04e0")) ;
+    argL->finalize() ;
+
+    static double const rates[] = { 8,16,32,64,128,250,475,860 } ;
+    auto period = std::chrono::duration<double>(1 / rates[(word >> 5) & 0x7]) ;
+    // ...sleep until the next read is due (instead of a busy loop)
+    
+    host->startContinuous(word) ;
+    int64_t total = 0 ;
+    auto t0 = std::chrono::steady_clock::now() ;
+    for (decltype(n) i=0 ; i<n ; ++i)
+    {
+	auto due = t0 + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+	    period * static_cast<double>(i+1)) ;
+	std::this_thread::sleep_until(due) ;
+	// ...paced by the clock, so the reads don't add to the period
+	total += static_cast<int16_t>(host->readNext()) ;
+    }
+    auto t1 = std::chrono::steady_clock::now() ;
+
+    auto rate = static_cast<double>(n)/std::chrono::duration<double>(t1-t0).count() ;
+    auto avg = static_cast<double>(total) / static_cast<double>(n) ;
+
+    std::cout.setf(std::ios::scientific) ;
+    std::cout.precision(2) ;
+    std::cout << rate << "/s (" << avg << ")\n" ;
+}
+
+static void help()
+{
+    std::cout << "arguments: SCL SDA ADDR [-m] MODE\n"
+	      << "         | bsc INDEX ADDR [-d DIV] BSC-MODE\n"
+	      << '\n'
+	      << " SCL: Pi's pin to set the ADS1115's SCL pin\n"
+	      << " SDA: Pi's pin to r/w the ADS1115's SDA pin\n"
+	      << "ADDR: 0..127\n"
+	      << '\n'
+	      << "MODE : config       # read configuration register\n"
+	      << "     | config WORD  # write configuration register\n"
+	      << "     | rate N       # determine sample-rate\n"
+	      << "     | reset        # write reset command\n"
+	      << "     | sample       # read sample register\n"
+	      << "     | stream N [-w WORD] [-r RDY] # continuous conversion\n"
+	      << '\n'
+	      << "WORD: config for continuous mode (default 0x04e0: 860/s)\n"
+	      << " RDY: Pi's pin to read the ADS1115's ALERT/RDY pin\n"
+	      << '\n'
+	      << "INDEX: 0:BSC0 1:BSC1 (the Pi's I2C controller)\n"
+	      << "  DIV: SCL clock divider (core-clock / DIV)\n"
+	      << '\n'
+	      << "BSC-MODE : config       # read configuration register\n"
+	      << "         | config WORD  # write configuration register\n"
+	      << "         | rate N       # determine sample-rate\n"
+	      << "         | reset        # write reset command (general call)\n"
+	      << "         | sample       # read sample register\n"
+	      << "         | stream N [-w WORD] # continuous conversion\n" ;
+}
+
+static void bscInvoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
+{
+    if (argL->empty() || argL->peek() == "help")
+    {
+	help() ;
+	return ;
+    }
+    auto index = Ui::strto(argL->pop(),Rpi::Bsc::Index()) ;
+    auto addr = Ui::strto(argL->pop(),Circuit::Addr()) ;
+    auto div = argL->option("-d") ;
+    
+    Bsc::Host host(rpi,index,addr) ;
+    if (div)
+	host.bsc().setDivider(Ui::strto<uint16_t>(*div)) ;
+    
+    auto arg = argL->pop() ;
+    if (false) ;
+    
+    else if (arg == "config") bscConfigInvoke(&host,argL) ;
+    else if (arg ==   "rate")   bscRateInvoke(&host,argL) ;
+    else if (arg ==  "reset") { argL->finalize() ; host.reset() ; }
+    else if (arg == "sample") { argL->finalize() ; std::cout << static_cast<int16_t>(host.readSample()) << '\n' ; }
+    else if (arg == "stream") bscStreamInvoke(&host,argL) ;
+    
+    else throw std::runtime_error("not supported option:<"+arg+'>') ;
+}
+
+// --------------------------------------------------------------------
+
 void Console::Device::Ads1115::invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
 {
     if (argL->empty() || argL->peek() == "help") {
-	std::cout << "arguments: SCL SDA ADDR [-m] MODE\n"
-		  << '\n'
-		  << " SCL: Pi's pin to set the ADS1115's SCL pin\n"
-		  << " SDA: Pi's pin to r/w the ADS1115's SDA pin\n"
-		  << "ADDR: 0..127\n"
-		  << '\n'
-		  << "MODE : config       # read configuration register\n"
-		  << "     | config WORD  # write configuration register\n"
-		  << "     | rate N       # determine sample-rate\n"
-		  << "     | reset        # write reset command\n"
-		  << "     | sample       # read sample register\n" ;
+	help() ;
+	return ;
+    }
+
+    if (argL->pop_if("bsc"))
+    {
+	bscInvoke(rpi,argL) ;
 	return ;
     }
   
@@ -146,6 +314,7 @@ void Console::Device::Ads1115::invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
     else if (arg ==  "rate")    rateInvoke(rpi,config,argL) ;
     else if (arg ==  "reset")  resetInvoke(rpi,config,argL) ;
     else if (arg == "sample") sampleInvoke(rpi,config,argL) ;
+    else if (arg == "stream") streamInvoke(rpi,config,argL) ;
     
     else throw std::runtime_error("not supported option:<"+arg+'>') ;
 }
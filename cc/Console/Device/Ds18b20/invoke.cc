@@ -6,6 +6,8 @@
 #include <Protocol/OneWire/Bang/crc.h>
 #include <Protocol/OneWire/Bang/Error.h>
 #include <Ui/strto.h>
+#include <algorithm> // reverse
+#include <array>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
@@ -376,7 +378,7 @@ static void write(OneWire::Master *master,Ui::ArgL *argL)
 static void help()
 {
     std::cout
-	<< "arguments: [-f FREQ | -s] PIN COMMAND...\n"
+	<< "arguments: [-f FREQ | -s] [-j BOUND] PIN COMMAND...\n"
 	<< '\n'
 	<< "convert ADDRESS [-d] [-r] [-w]\n"
 	<< "pad     ADDRESS [-d] [-r]\n"
@@ -417,6 +419,8 @@ static void help()
 	<< "[-d] display debug messages\n"
 	<< "[-r] retry if timing wasn't met\n"
 	<< "[-s] omit frequency info message\n"
+	<< "[-j] abort a time-slot if a busy-wait got suspended\n"
+	<< "     for more than BOUND seconds (a timing error, see -r)\n"
 	<< '\n'
 	<< "ADDRESS: [-a XX:XX...]\n"
 	<< "    do Match-ROM command instead of Skip-ROM\n"
@@ -453,9 +457,13 @@ void Console::Device::Ds18b20::invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
     }
     auto timing = OneWire::Timing::xlat(f) ;
     // [todo] make timing a command line argument
+    auto bound = Ui::strto<double>(argL->option("-j","0")) ;
     
     auto pin = Ui::strto(argL->pop(),Rpi::Pin()) ;
     OneWire::Master master(rpi,pin,timing) ;
+    RpiExt::Jitter jitter(static_cast<uint32_t>(bound * f + .5)) ;
+    if (bound > 0)
+	master.monitor(&jitter) ;
     
     std::map<std::string,void(*)(OneWire::Master*,Ui::ArgL*)> map =
     {
@@ -1,12 +1,17 @@
 // BSD 2-Clause License, see github.com/ma16/rpio
 
 #include "../invoke.h"
+#include <chrono>
 #include <deque>
 #include <fstream>
 #include <iostream>
 #include <Device/Max7219/Bang.h>
+#include <Device/Max7219/Chain.h>
+#include <Device/Max7219/Frames.h>
 #include <Device/Max7219/Parser.h>
+#include <Neat/stream.h>
 #include <Posix/base.h> // nanosleep
+#include <Posix/MMap.h>
 #include <Ui/strto.h>
 
 using namespace Device::Max7219 ;
@@ -22,6 +27,37 @@ dataInvoke(Rpi::Peripheral *rpi,Bang *bang,Ui::ArgL *argL)
     RpiExt::Bang(rpi).execute(script.vector()) ;
 }
     
+static void
+rateInvoke(Rpi::Peripheral *rpi,Bang *bang,Ui::ArgL *argL)
+{
+    auto n = Ui::strto<size_t>(argL->pop()) ;
+    auto compiled = argL->pop_if("-c") ;
+    argL->finalize() ;
+    std::vector<uint16_t> v(n,0x0000) ; // No-Op
+    std::chrono::steady_clock::time_point t0,t1 ;
+    if (compiled)
+    {
+	t0 = std::chrono::steady_clock::now() ;
+	bang->write(v.data(),v.size()) ;
+	t1 = std::chrono::steady_clock::now() ;
+    }
+    else
+    {
+	RpiExt::Bang::Enqueue q ;
+	for (auto data: v)
+	    bang->send(&q,data) ;
+	bang->load(&q) ;
+	auto script = q.vector() ;
+	RpiExt::Bang host(rpi) ;
+	t0 = std::chrono::steady_clock::now() ;
+	host.execute(script) ;
+	t1 = std::chrono::steady_clock::now() ;
+	// ...without building the script
+    }
+    auto rate = 16.0 * static_cast<double>(n) / std::chrono::duration<double>(t1-t0).count() ;
+    std::cout << rate << " bit/s" << std::endl ;
+}
+    
 static void
 fileInvoke(Rpi::Peripheral *rpi,Bang *bang,Ui::ArgL *argL)
 {
@@ -73,6 +109,99 @@ fileInvoke(Rpi::Peripheral *rpi,Bang *bang,Ui::ArgL *argL)
     }
 }
     
+static void
+playInvoke(Bang *bang,Ui::ArgL *argL)
+{
+    auto fd = Posix::Fd::open(argL->pop().c_str(),Posix::Fd::Open::RO) ;
+    auto n = Ui::strto<unsigned>(argL->option("-r","1")) ;
+    auto ndevices = Ui::strto<size_t>(argL->option("-c","0")) ;
+    argL->finalize() ;
+
+    // with a cascade, only the changed rows are sent; a frame is
+    // latched once, so only its last ndevices words land (the word
+    // shifted last in device #0); the others are shifted through
+    Chain chain(ndevices) ;
+    std::vector<uint16_t> words ; words.reserve(8 * ndevices) ;
+    auto diff = [&](Frames::Record const &r) {
+	if (ndevices == 0 || r.n < ndevices)
+	    return false ;
+	auto w = r.data + (r.n - ndevices) ;
+	for (size_t j=0 ; j<ndevices ; ++j)
+	    if (((w[j] >> 8) & 0xf) > 8)
+		return false ;
+	// ...digit registers only
+	for (size_t j=0 ; j<ndevices ; ++j)
+	    chain.apply(ndevices - 1 - j,w[j]) ;
+	words.clear() ;
+	if (chain.update(&words) > 0)
+	    bang->write(words.data(),words.size(),ndevices) ;
+	return true ;
+    } ;
+    auto raw = [&](Frames::Record const &r) {
+	bang->write(r.data,r.n) ;
+	for (size_t d=0 ; d<ndevices ; ++d)
+	{
+	    if (d < r.n)
+		chain.latched(d,r.data[r.n - 1 - d]) ;
+	    else chain.invalidate(d) ;
+	    // ...the device latches whatever was left in its shift
+	    //    register (not tracked)
+	}
+    } ;
+    size_t nwords = 0 ;
+    
+    auto size = fd->size().as_unsigned() ;
+    auto mmap = Posix::MMap::make(fd.get(),Posix::Fd::uoff_t::make<0>(),size,Posix::MMap::Prot::RO,false) ;
+    Frames frames(mmap->front(),size) ;
+
+    // no allocations beyond this point
+    auto t0 = std::chrono::steady_clock::now() ;
+    size_t nframes = 0 ;
+    for (auto i=0u ; i<n ; ++i)
+    {
+	auto c = frames.begin() ;
+	Frames::Record r ;
+	while (c.next(&r))
+	{
+	    switch (r.kind)
+	    {
+	    case Frames::Record::Kind::Frame:
+		if (diff(r))
+		    nwords += words.size() ;
+		else
+		{
+		    raw(r) ;
+		    nwords += r.n ;
+		}
+		++nframes ;
+		break ;
+	    case Frames::Record::Kind::Delay:
+		Posix::nanosleep(1e3 * r.us) ;
+		break ;
+	    case Frames::Record::Kind::Echo:
+		std::cout.write(reinterpret_cast<char const*>(r.data),static_cast<std::streamsize>(r.n)) ;
+		std::cout.flush() ;
+		break ;
+	    }
+	}
+    }
+    auto t1 = std::chrono::steady_clock::now() ;
+    std::cout << static_cast<double>(nframes) / std::chrono::duration<double>(t1-t0).count() << " frames/s "
+	      << "(" << nwords << " words shifted)" << std::endl ;
+}
+    
+static void
+compileInvoke(Ui::ArgL *argL)
+{
+    auto iname = argL->pop() ;
+    auto oname = argL->pop() ;
+    argL->finalize() ;
+    std::ifstream is ; Neat::open(&is,iname) ;
+    std::ofstream os ; Neat::open(&os,oname,std::ios::binary) ;
+    auto n = Frames::compile(&is,&os) ;
+    std::cout << n << " records\n" ;
+}
+    
 static Bang::Seconds getTiming(Ui::ArgL *argL)
 {
     if (argL->pop_if("-t"))
@@ -93,6 +222,7 @@ void Console::Device::Max7219::invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
 {
     if (argL->empty() || argL->peek() == "help") {
 	std::cout << "arguments: DIN LOAD CLK [-f FREQ] MODE\n"
+		  << "         | compile FILE BINARY\n"
 		  << '\n'
 		  << " DIN : Pi's pin number connected to MAX7219  DIN pin\n"
 		  << "LOAD : Pi's pin number connected to MAX7219 LOAD pin\n"
@@ -100,11 +230,15 @@ void Console::Device::Max7219::invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
 		  << '\n'
 		  << "FREQ: ARM counter frequency that has been set up\n"
 		  << '\n'
-		  << "MODE : -d DATA+ | -f FILE [-r N]\n"
+		  << "MODE : -d DATA+ | -s FILE [-r N] | -p BINARY [-r N] [-c N] | rate N [-c]\n"
 		  << '\n'
 		  << " -d : shift DATA+ and latch\n"
 		  << " -r : execute N times (default 1)\n"
 		  << " -s : read COMMAND+ until eof from FILE and execute\n"
+		  << " -p : play a compiled BINARY file (see compile)\n"
+		  << "      -c: N cascaded devices; send only the changed rows\n"
+		  << "rate: shift N No-Op words and latch (throughput test)\n"
+		  << " -c : use a compile-time script instead of Bang's\n"
 		  << '\n'
 		  << "COMMAND+ : COMMAND | COMMAND COMMAND+\n"
 		  << "   DATA+ :    DATA |    DATA    DATA+\n"
@@ -112,7 +246,15 @@ void Console::Device::Max7219::invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
 		  << " COMMAND : '>' DATA     # 16-bit word to serialize\n"
 		  << "         | '+' SECONDS  # number of seconds to sleep\n"
 		  << "         | '!'          # activate LOAD pin\n"
-		  << "         | '\"' TEXT '\"' # print text to stdout\n" ;
+		  << "         | '\"' TEXT '\"' # print text to stdout\n"
+		  << '\n'
+		  << "compile: translate a FILE of COMMAND+ to a BINARY file\n" ;
+	return ;
+    }
+
+    if (argL->pop_if("compile"))
+    {
+	compileInvoke(argL) ;
 	return ;
     }
 
@@ -141,6 +283,8 @@ void Console::Device::Max7219::invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
     auto arg = argL->pop() ;
     if      (arg == "-d") dataInvoke(rpi,&bang,argL) ;
     else if (arg == "-s") fileInvoke(rpi,&bang,argL) ;
+    else if (arg == "-p") playInvoke(&bang,argL) ;
+    else if (arg == "rate") rateInvoke(rpi,&bang,argL) ;
 
     else throw std::runtime_error("not supported option:<"+arg+'>') ;
 }
@@ -2,16 +2,22 @@
 
 #include "../invoke.h"
 
+#include <algorithm>
 #include <chrono>
 #include <deque>
+#include <fstream>
 #include <iostream>
 #include <math.h>
 
 #include <Device/Mcp3008/Bang.h>
+#include <Device/Mcp3008/Schedule.h>
 #include <Device/Mcp3008/Spi0.h>
 #include <Device/Mcp3008/Spi1.h>
+#include <Device/Mcp3008/Stream.h>
 #include <Neat/cast.h>
 #include <Posix/base.h>
+#include <Rpi/Ui/Bus/Memory.h>
+#include <RpiExt/VcMem.h>
 #include <Ui/strto.h>
 
 using namespace Device::Mcp3008 ;
@@ -34,23 +40,19 @@ static void bangRate(Rpi::Peripheral *rpi,Bang *host,bool monitor,Ui::ArgL *argL
 {
     auto n = Ui::strto<size_t>(argL->pop()) ;
     auto source = Ui::strto(argL->option("-s","0"),Circuit::Source()) ;
+    auto compiled = argL->pop_if("-c") ;
     argL->finalize() ;
 
-    Bang::Record record ;
-    auto script = host->makeScript(source,monitor,&record) ;
+    std::vector<Bang::Record> v(n) ;
+    auto script = host->makeScript(source,monitor,v.data(),n) ;
+    // ...a single loop that fills the whole array (rather than to
+    // execute the script and to copy the record for each sample)
     
     RpiExt::Bang scheduler(rpi) ;
-    std::vector<Bang::Record> v(n) ;
     
     auto t0 = std::chrono::steady_clock::now() ;
-    for (decltype(n) i=0 ; i<n ; ++i)
-    {
-	scheduler.execute(script) ;
-	v[i] = record ;
-	// the alternative is to compile a long script which already
-	// includes all the iterations. this is however not that fast
-	// (maybe the cache prediction isn't good enough for this).
-    }
+    if (compiled) host->acquire(source,monitor,v.data(),n) ;
+    else          scheduler.execute(script) ;
     auto t1 = std::chrono::steady_clock::now() ;
     
     if (monitor)
@@ -58,8 +60,11 @@ static void bangRate(Rpi::Peripheral *rpi,Bang *host,bool monitor,Ui::ArgL *argL
 	decltype(n) array[0x100] = { 0 } ;
 	for (decltype(n) i=0 ; i<n ; ++i)
 	{
-	    uint8_t code = host->error(v[i]).value() ;
-	    ++array[code] ;
+	    for (size_t j=0 ; j<host->size() ; ++j)
+	    {
+		uint8_t code = host->error(v[i],j).value() ;
+		++array[code] ;
+	    }
 	}
 	for (unsigned code=1 ; code<0x100 ; ++code)
 	{
@@ -70,48 +75,64 @@ static void bangRate(Rpi::Peripheral *rpi,Bang *host,bool monitor,Ui::ArgL *argL
 	std::cout << "success: " << array[0] << '\n' ;
     }
     auto rate = n/std::chrono::duration<double>(t1-t0).count() ;
-    std::cout << rate << "/s" << std::endl ;
+    std::cout << rate * static_cast<double>(host->size()) << "/s" << std::endl ;
+    // ...all devices are sampled at once
 }
     
 static void bangSample(Rpi::Peripheral*,Bang *host,bool monitor,Ui::ArgL *argL)
 {
     auto sourceV = scanSources(argL) ;
+    std::vector<Circuit::Sample> msb(host->size()) ;
     for (auto source: sourceV)
     {
 	auto sample = host->query(source,monitor) ;
 	if (monitor)
 	{
-	    std::cout << '('
-		      << std::dec << host->msb(sample).value() << ',' 
-		      << host->lsb(sample).value() << ',' 
-		      << std::hex << (unsigned)host->error(sample).value()
-		      << ") " ;
+	    for (size_t j=0 ; j<host->size() ; ++j)
+	    {
+		std::cout << '('
+			  << std::dec << host->msb(sample,j).value() << ',' 
+			  << host->lsb(sample,j).value() << ',' 
+			  << std::hex << (unsigned)host->error(sample,j).value()
+			  << ") " ;
+	    }
 	}
-	else std::cout << host->msb(sample).value() << ' ' ;
+	else
+	{
+	    host->msb(sample,msb.data()) ;
+	    for (auto &x: msb)
+		std::cout << x.value() << ' ' ;
+	}
+	if (host->size() > 1)
+	    std::cout << '\n' ; // ...one line per source
     }
-    std::cout << std::endl ;
+    if (host->size() == 1)
+	std::cout << '\n' ;
+    std::cout << std::flush ;
 }
 
 void bangInvoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
 {
     if (argL->empty() || argL->peek() == "help")
     {
-	std::cout << "arguments: CS DIN DOUT CLK [-m] [-f FREQ] MODE\n"
+	std::cout << "arguments: CS DIN DOUT CLK [-p DOUT]* [-m] [-f FREQ] MODE\n"
 		  << '\n'
 		  << "  CS: Pi's pin to feed MCP's   CS pin @10\n"
 		  << " DIN: Pi's pin to feed MCP's  DIN pin @11\n"
 		  << "DOUT: Pi's pin to read MCP's DOUT pin @12\n"
 		  << " CLK: Pi's pin to feed MCP's  CLK pin @13\n"
 		  << '\n'
+		  << "-p: DOUT of a further MCP (that shares CS, DIN and CLK)\n"
 		  << "-m: enable monitoring to detect communication problems\n"
 		  << '\n'
 		  << "FREQ: ARM counter frequency that has been set up\n"
 		  << '\n'
-		  << "MODE : rate N [-s SOURCE]  # perform throughput test\n"
-		  << "     | sample SOURCE+      # read one or more samples\n" 
+		  << "MODE : rate N [-s SOURCE] [-c]  # perform throughput test\n"
+		  << "     | sample SOURCE+           # read one or more samples\n" 
 		  << '\n'
 		  << "N - the number of consecutive samples to take\n" 
-		  << "SOURCE - the MCP3008-channel to sample (0..15)\n" ;
+		  << "SOURCE - the MCP3008-channel to sample (0..15)\n"
+		  << "-c - use a compile-time script instead of Bang's\n" ;
 	return ;
     }
   
@@ -120,6 +141,10 @@ void bangInvoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
     auto doutPin = Ui::strto(argL->pop(),Rpi::Pin()) ;
     auto  clkPin = Ui::strto(argL->pop(),Rpi::Pin()) ;
 
+    std::vector<Rpi::Pin> doutPins(1,doutPin) ;
+    while (argL->pop_if("-p"))
+	doutPins.push_back(Ui::strto(argL->pop(),Rpi::Pin())) ;
+
     auto monitor = argL->pop_if("-m") ;
 
     std::cout.setf(std::ios::scientific) ;
@@ -154,7 +179,7 @@ void bangInvoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
     timing.dis  = ticks(Circuit::timing_3v.dis ) ;
     timing.bled = ticks(Circuit::timing_3v.bled) ;
 
-    Bang host(rpi,csPin,clkPin,dinPin,doutPin,timing) ;
+    Bang host(rpi,csPin,clkPin,dinPin,doutPins,timing) ;
 
     auto arg = argL->pop() ;
     if (false) ;
@@ -230,6 +255,153 @@ static void spi0Sample(Spi0 *host,bool monitor,Ui::ArgL *argL)
     std::cout << std::endl ;
 }
     
+static void spi0Stream(Rpi::Peripheral *rpi,Ui::ArgL *argL)
+{
+    auto index = Ui::strto(argL->pop(),Rpi::Dma::Ctrl::Index()) ;
+    auto allocator = Rpi::Ui::Bus::Memory::
+	getAllocator(rpi,argL,RpiExt::VcMem::defaultAllocator()) ;
+    auto nrecords = Ui::strto<size_t>(argL->option("-n","1024")) ;
+    auto rate = Ui::strto<double>(argL->option("-r","50e3")) ;
+    auto seconds = Ui::strto<double>(argL->pop()) ;
+    auto sourceV = scanSources(argL) ;
+
+    auto divider = Stream::divider(rate) ;
+    Stream stream(rpi,index,allocator.get(),sourceV,nrecords,divider) ;
+    
+    std::cout.setf(std::ios::scientific) ;
+    std::cout.precision(2) ;
+    std::cout << "divider: " << divider << " (" << Stream::rate(divider) << "/s estimated)\n" ;
+
+    std::vector<Stream::Sample> buffer(nrecords * sourceV.size()) ;
+    std::vector<double> sum(sourceV.size(),0) ;
+    size_t nsamples = 0 ; size_t nerrors = 0 ;
+    uint32_t t0 = 0, t1 = 0 ;
+    
+    stream.start() ;
+    auto start = std::chrono::steady_clock::now() ;
+    auto duration = std::chrono::duration<double>(seconds) ;
+    while (std::chrono::steady_clock::now() - start < duration)
+    {
+	Posix::nanosleep(1e6) ;
+	auto n = stream.fetch(buffer.data(),buffer.size()) ;
+	for (size_t i=0 ; i<n ; ++i)
+	{
+	    auto const &sample = buffer[i] ;
+	    if (!sample.error.ok())
+		++nerrors ;
+	    sum[i % sourceV.size()] += sample.value.value() ;
+	}
+	if (n > 0)
+	{
+	    if (nsamples == 0)
+		t0 = buffer[0].t ;
+	    t1 = buffer[n-1].t ;
+	}
+	nsamples += n ;
+    }
+    stream.stop() ;
+
+    std::cout << "samples: " << nsamples << '\n'
+	      << "errors: " << nerrors << '\n'
+	      << "overruns: " << stream.overruns() << '\n' ;
+    if (nsamples > 1)
+	std::cout << "rate: " << static_cast<double>(nsamples-1) / ((t1-t0) * 1e-6) << "/s\n" ;
+    // ...as given by the time-stamps
+    std::cout << "mean:" ;
+    for (auto x: sum)
+	std::cout << ' ' << x / static_cast<double>(nsamples / sourceV.size()) ;
+    std::cout << std::endl ;
+}
+
+static void spi0Schedule(Rpi::Peripheral *rpi,Ui::ArgL *argL)
+{
+    auto index = Ui::strto(argL->pop(),Rpi::Dma::Ctrl::Index()) ;
+    auto allocator = Rpi::Ui::Bus::Memory::
+	getAllocator(rpi,argL,RpiExt::VcMem::defaultAllocator()) ;
+    auto length = Ui::strto<size_t>(argL->option("-l","1024")) ;
+    auto nrecords = Ui::strto<size_t>(argL->option("-n","0")) ;
+    std::string prefix ;
+    if (argL->pop_if("-o"))
+	prefix = argL->pop() ;
+    auto seconds = Ui::strto<double>(argL->pop()) ;
+    std::vector<Schedule::Entry> entries ;
+    do
+    {
+	auto source = Ui::strto(argL->pop(),Circuit::Source()) ;
+	auto rate = Ui::strto<double>(argL->pop()) ;
+	entries.push_back(Schedule::Entry(source,rate)) ;
+    }
+    while (!argL->empty()) ;
+    argL->finalize() ;
+
+    Schedule schedule(entries,length) ;
+    auto divider = Stream::divider(schedule.rate()) ;
+    if (nrecords == 0)
+    {
+	// the ring holds 64 polls (1ms each) at least
+	auto n = ceil(64e-3 * schedule.rate() / static_cast<double>(schedule.scan().size())) ;
+	nrecords = std::max<size_t>(4,static_cast<size_t>(n)) ;
+    }
+    Stream stream(rpi,index,allocator.get(),schedule.scan(),nrecords,divider) ;
+    
+    std::cout.setf(std::ios::scientific) ;
+    std::cout.precision(2) ;
+    std::cout << "cycle: " << schedule.scan().size() << " slots\n"
+	      << "rate: " << schedule.rate() << "/s (aggregate)\n"
+	      << "decimation: " << schedule.decimation() << '\n'
+	      << "divider: " << divider << " (" << Stream::rate(divider) << "/s estimated)\n" ;
+
+    // the output streams (one per source)
+    std::vector<std::unique_ptr<std::ofstream>> os(16) ;
+    if (!prefix.empty())
+    {
+	for (auto const &entry: entries)
+	{
+	    auto name = prefix + '.' + std::to_string(entry.source.value()) ;
+	    os[entry.source.value()].reset(new std::ofstream(name)) ;
+	    if (!os[entry.source.value()]->good())
+		throw std::runtime_error("cannot open file:<"+name+'>') ;
+	}
+    }
+    
+    std::vector<Stream::Sample> buffer(nrecords * schedule.scan().size()) ;
+    stream.start() ;
+    auto start = std::chrono::steady_clock::now() ;
+    auto duration = std::chrono::duration<double>(seconds) ;
+    while (std::chrono::steady_clock::now() - start < duration)
+    {
+	Posix::nanosleep(1e6) ;
+	auto n = stream.fetch(buffer.data(),buffer.size()) ;
+	n = schedule.account(buffer.data(),n) ;
+	if (!prefix.empty())
+	{
+	    for (size_t i=0 ; i<n ; ++i)
+	    {
+		auto const &sample = buffer[i] ;
+		(*os[sample.source.value()]) << sample.t << ' ' << sample.value.value() << '\n' ;
+	    }
+	}
+    }
+    stream.stop() ;
+
+    std::cout << "overruns: " << stream.overruns() << '\n'
+	      << "source target slots samples errors rate jitter(us) min(us) max(us) last\n" ;
+    for (auto const &s: schedule.stats())
+    {
+	std::cout << std::dec << s.entry.source.value() << ' '
+		  << s.entry.rate << ' '
+		  << std::dec << s.slots << ' '
+		  << s.count << ' '
+		  << s.errors << ' '
+		  << s.rate() << ' '
+		  << s.jitter() << ' '
+		  << std::dec << (s.count > 1 ? s.dmin : 0) << ' '
+		  << s.dmax << ' '
+		  << s.last.value() << '\n' ;
+    }
+    std::cout << std::flush ;
+}
+
 static void spi0Invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
 {
     if (argL->empty() || argL->peek() == "help")
@@ -240,13 +412,36 @@ static void spi0Invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
 		  << '\n'
 		  << "MODE : rate N [-s SOURCE]  # perform throughput test\n"
 		  << "     | sample SOURCE+      # read one or more samples\n" 
+		  << "     | stream CHANNEL [ALLOC] [-n NRECORDS] [-r RATE] SECONDS SOURCE+\n"
+		  << "                           # continuous sampling by DMA\n"
+		  << "     | schedule CHANNEL [ALLOC] [-l LENGTH] [-n NRECORDS] [-o PREFIX] SECONDS (SOURCE RATE)+\n"
+		  << "                           # sources at different rates by DMA\n"
 		  << '\n'
 		  << "N - the number of consecutive samples to take\n" 
-		  << "SOURCE - the MCP3008-channel to sample (0..15)\n" ;
+		  << "SOURCE - the MCP3008-channel to sample (0..15)\n"
+		  << "CHANNEL - the DMA channel (0..15)\n"
+		  << "ALLOC - allocator for DMA bus memory:\n"
+		  << Rpi::Ui::Bus::Memory::allocatorSynopsis()
+		  << "NRECORDS - the number of scans in the DMA ring (default: 1024)\n"
+		  << "           (schedule: cycles for 64ms, 4 at least)\n"
+		  << "RATE - the aggregate sample rate (default: 50e3); the source's rate (schedule)\n"
+		  << "SECONDS - the duration of the acquisition\n"
+		  << "LENGTH - the maximum number of slots in the schedule's cycle (default: 1024)\n"
+		  << "PREFIX - write the samples of each source to file PREFIX.SOURCE\n" ;
 	return ;
     }
   
     auto monitor = argL->pop_if("-m") ;
+    if (argL->pop_if("stream"))
+    {
+	spi0Stream(rpi,argL) ;
+	return ;
+    }
+    if (argL->pop_if("schedule"))
+    {
+	spi0Schedule(rpi,argL) ;
+	return ;
+    }
     Spi0 host(rpi) ;
     // [todo] some kind of diagnostic if clock isn't enabled
     
@@ -306,11 +501,10 @@ static void spi1Rate(Spi1 *host,bool monitor,Ui::ArgL *argL)
 static void spi1Sample(Spi1 *host,bool monitor,Ui::ArgL *argL)
 {
     auto sourceV = scanSources(argL) ;
-    for (auto source: sourceV)
+    if (monitor)
     {
-	if (monitor)
+	for (auto sample: host->scan26(sourceV))
 	{
-	    auto sample = host->query26(source) ;
 	    std::cout << "("
 		      << std::dec << sample.fetch().value() 
 		      << ','
@@ -319,11 +513,61 @@ static void spi1Sample(Spi1 *host,bool monitor,Ui::ArgL *argL)
 		      << std::hex << sample.verify().code().value()
 		      << ") " ;
 	}
-	else std::cout << host->query17(source).fetch().value() << ' ' ;
     }
+    else for (auto sample: host->scan17(sourceV))
+	std::cout << sample.fetch().value() << ' ' ;
     std::cout << std::endl ;
 }
 
+static void spi1Scan(Spi1 *host,bool monitor,Ui::ArgL *argL)
+{
+    auto n = Ui::strto<unsigned>(argL->pop()) ;
+    auto sourceV = scanSources(argL) ;
+
+    std::vector<Circuit::Sample> last(sourceV.size()) ;
+    decltype(n) array[0x4] = { 0 } ;
+    
+    auto t0 = std::chrono::steady_clock::now() ;
+    for (decltype(n) i=0 ; i<n ; ++i)
+    {
+	if (monitor)
+	{
+	    auto v = host->scan26(sourceV) ;
+	    for (size_t j=0 ; j<v.size() ; ++j)
+	    {
+		++array[v[j].verify().code().value()] ;
+		last[j] = v[j].fetch() ;
+	    }
+	}
+	else
+	{
+	    auto v = host->scan17(sourceV) ;
+	    for (size_t j=0 ; j<v.size() ; ++j)
+		last[j] = v[j].fetch() ;
+	}
+    }
+    auto t1 = std::chrono::steady_clock::now() ;
+
+    if (monitor)
+    {
+	for (unsigned code=1 ; code<0x4 ; ++code)
+	{
+	    if (array[code] > 0)
+		std::cout << "error 0x" << std::hex << code << ": "
+			  << std::dec << array[code] << '\n' ;
+	}
+	std::cout << "success: " << array[0] << '\n' ;
+    }
+    for (auto x: last)
+	std::cout << std::dec << x.value() << ' ' ;
+    std::cout << '\n' ;
+    
+    std::cout.setf(std::ios::scientific) ;
+    std::cout.precision(2) ;
+    auto rate = static_cast<double>(n * sourceV.size()) / std::chrono::duration<double>(t1-t0).count() ;
+    std::cout << rate << "/s" << std::endl ;
+}
+
 static void spi1Invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
 {
     if (argL->empty() || argL->peek() == "help")
@@ -334,8 +578,9 @@ static void spi1Invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
 		  << '\n'
 		  << "MODE : rate N [-s SOURCE]  # perform throughput test\n"
 		  << "     | sample SOURCE+      # read one or more samples\n" 
+		  << "     | scan N SOURCE+      # throughput test of batched scans\n" 
 		  << '\n'
-		  << "N - the number of consecutive samples to take\n" 
+		  << "N - the number of consecutive samples (scans) to take\n" 
 		  << "SOURCE - the MCP3008-channel to sample (0..15)\n" ;
 	return ;
     }
@@ -349,6 +594,7 @@ static void spi1Invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
     
     else if (arg ==   "rate")   spi1Rate(&host,monitor,argL) ;
     else if (arg == "sample") spi1Sample(&host,monitor,argL) ;
+    else if (arg ==   "scan")   spi1Scan(&host,monitor,argL) ;
     
     else throw std::runtime_error("not supported option:<"+arg+'>') ;
 }
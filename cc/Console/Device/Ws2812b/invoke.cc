@@ -3,12 +3,24 @@
 #include "../invoke.h"
 #include <Device/Ws2812b/BitStream.h>
 #include <Device/Ws2812b/Circuit.h>
+#include <Device/Ws2812b/Color.h>
+#include <Device/Ws2812b/Edges.h>
+#include <Device/Ws2812b/Encoder.h>
+#include <Device/Ws2812b/Frame.h>
+#include <Device/Ws2812b/Parallel.h>
 #include <Rpi/Pin.h>
 #include <RpiExt/Pwm.h>
 #include <RpiExt/Serialize.h>
 #include <RpiExt/Spi0.h>
+#include <RpiExt/VcMem.h>
+#include <RpiExt/Waveform.h>
+#include <Rpi/Ui/Bus/Memory.h>
 #include <Ui/strto.h>
+#include <chrono>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <random>
 
 // --------------------------------------------------------------------
 
@@ -32,53 +44,6 @@ static Device::Ws2812b::Circuit::Seconds getBang(Ui::ArgL *argL)
     return Device::Ws2812b::Circuit::strict ;
 }
   
-static std::vector<RpiExt::Serialize::Edge> make(
-    size_t nleds,uint32_t grb,uint32_t pins,
-    Device::Ws2812b::Circuit::Ticks const &ticks)
-{
-    auto const Lo = Rpi::Register::Gpio::Output::Level::Lo ;
-    auto const Hi = Rpi::Register::Gpio::Output::Level::Hi ;
-
-    using Edge = RpiExt::Serialize::Edge ;
-    std::deque<Edge> q ;
-
-    // [debugging] make start visible in analyser
-    q.push_back(Edge(pins,10,~0u,Lo)) ;
-    q.push_back(Edge(pins,10,~0u,Hi)) ;
-    
-    // reset
-    q.push_back(Edge(pins,10,~0u,Lo)) ;
-
-    auto min = ticks.res_min ;
-    auto max = ~0u ;
-
-    // for each LED
-    for (size_t i=0 ; i<nleds ; ++i)
-    {
-	// for each LED-bit
-	for (uint32_t mask=(1u<<23) ; mask!=0 ; mask>>=1)
-	{
-	    q.push_back(Edge(pins,min,max,Hi)) ;
-	    auto bit = grb & mask ;
-	    if (bit)
-	    {
-		q.push_back(Edge(pins,ticks.t1h_min,ticks.t1h_max,Lo)) ;
-		min = ticks.t1l_min ;
-		max = ticks.t1l_max ;
-	    }
-	    else
-	    {
-		q.push_back(Edge(pins,ticks.t0h_min,ticks.t0h_max,Lo)) ;
-		min = ticks.t0l_min ;
-		max = ticks.t0l_max ;
-	    }
-	}
-    }
-    q.push_back(Edge(pins,ticks.res_min,~0u,Lo)) ;
-
-    return std::vector<Edge>(q.begin(),q.end()) ;
-}
-
 static void bang(Rpi::Peripheral *rpi,Ui::ArgL *argL)
 {
     auto nleds = Ui::strto<unsigned>(argL->pop()) ;
@@ -88,6 +53,7 @@ static void bang(Rpi::Peripheral *rpi,Ui::ArgL *argL)
     auto freq = Rpi::ArmTimer(rpi).frequency() ;
     auto pin = Ui::strto(argL->pop(),Rpi::Pin()) ;
     auto max_retries = Ui::strto<uint64_t>(argL->option("-r","1")) ;
+    auto bound = Ui::strto<float>(argL->option("-j","0")) ;
     auto debug = argL->pop_if("-d") ;
     argL->finalize() ;
   
@@ -104,20 +70,167 @@ static void bang(Rpi::Peripheral *rpi,Ui::ArgL *argL)
     }
   
     RpiExt::Serialize host(rpi) ;
-    std::vector<RpiExt::Serialize::Edge> v =
-	make(nleds,grb,(1u<<pin.value()),ticks) ;
+    uint32_t color = grb ;
+
+    RpiExt::Jitter jitter(static_cast<uint32_t>(bound * freq + .5)) ;
+    host.monitor(&jitter) ;
+  
+    decltype(max_retries) i = 0 ;
+    decltype(max_retries) preempted = 0 ;
+    bool success ;
+    do {
+	++i ;
+	jitter.reset() ;
+	// ...the statistics (see -d) are the ones of the last attempt
+	Device::Ws2812b::Edges edges((1u<<pin.value()),ticks,&color,nleds,0) ;
+	success = host.pull(edges) ;
+	// ...the edges are generated during the transfer
+	if (host.preempted())
+	    ++preempted ;
+    }
+    while (!success && ((max_retries==0) || (i<max_retries))) ;
+    if (!success)
+	std::cout << "failed\n" ;
+    if (debug)
+    {
+	std::cout << "iterations: " <<  i << " (preempted: " << preempted << ")\n"
+		  << "max. gap (ticks): " << jitter.max() << '\n'
+		  << "gaps (ticks): " ;
+	for (unsigned j=0 ; j<RpiExt::Jitter::Buckets ; ++j)
+	    if (jitter.histogram(j) > 0)
+		std::cout << '<' << (1ull << j) << ':' << jitter.histogram(j) << ' ' ;
+	std::cout << '\n' ;
+    }
+}
+
+// --------------------------------------------------------------------
+
+// the PWM paces the DMA (see RpiExt::Waveform)
+static RpiExt::Waveform::Pacing pwmPacing(double period,double freq)
+{
+    return RpiExt::Waveform::Pacing::pwm(
+	static_cast<uint32_t>(period * freq + .5),
+	static_cast<uint32_t>(250e-9 * freq + .5)) ;
+    // ...about a quarter microsecond per control block (cf. the
+    //    MCP3008 stream: a microsecond for four blocks per sample)
+}
+
+static void dma(Rpi::Peripheral *rpi,Ui::ArgL *argL)
+{
+    auto nleds = Ui::strto<unsigned>(argL->pop()) ;
+    auto   grb = Ui::strto<unsigned>(argL->pop()) ;
+  
+    auto timing = getBang(argL) ;
+    auto freq = Rpi::ArmTimer(rpi).frequency() ;
+    auto pin = Ui::strto(argL->pop(),Rpi::Pin()) ;
+    auto period = Ui::strto<double>(argL->pop()) ;
+    auto index = Ui::strto(argL->option("-c","5"),Rpi::Dma::Ctrl::Index()) ;
+    auto dry = argL->pop_if("-n") ;
+    Rpi::Bus::Memory::Allocator::shared_ptr allocator ;
+    if (!dry) allocator = Rpi::Ui::Bus::Memory::
+	getAllocator(rpi,argL,RpiExt::VcMem::defaultAllocator()) ;
+    auto force = argL->pop_if("-f") ;
+    auto debug = argL->pop_if("-d") ;
+    argL->finalize() ;
+
+    auto ticks = Device::Ws2812b::Circuit::asTicks(timing,freq) ;
+    auto pacing = pwmPacing(period,freq) ;
+    
+    uint32_t color = grb ;
+    Device::Ws2812b::Edges edges((1u<<pin.value()),ticks,&color,nleds,0) ;
+    RpiExt::Waveform waveform(pacing) ;
+    waveform.addAll(edges) ;
+
+    auto i = waveform.verify() ;
+    if (debug)
+    {
+	auto v = waveform.timeline() ;
+	std::cout << "period (ticks): " << pacing.period << '\n'
+		  << "control blocks: " << waveform.size() << '\n'
+		  << "duration (ticks): " << (v.empty() ? 0 : v.back().t) << '\n' ;
+    }
+    if (i != static_cast<size_t>(-1))
+    {
+	if (!dry && !force)
+	    throw std::runtime_error("timing violated at edge #" + std::to_string(i)) ;
+	std::cout << "timing violated at edge #" << i << '\n' ;
+    }
+    if (dry)
+	return ;
+    
+    waveform.load(allocator.get()) ;
+    auto channel = Rpi::Dma::Ctrl(rpi).channel(index) ;
+    waveform.submit(&channel) ;
+    RpiExt::Waveform::wait(&channel) ;
+}
+
+// --------------------------------------------------------------------
+
+static void multi(Rpi::Peripheral *rpi,Ui::ArgL *argL)
+{
+    auto timing = getBang(argL) ;
+    auto freq = Rpi::ArmTimer(rpi).frequency() ;
+    auto max_retries = Ui::strto<uint64_t>(argL->option("-r","1")) ;
+    auto bound = Ui::strto<float>(argL->option("-j","0")) ;
+    auto period = argL->option("-p") ;
+    auto index = Ui::strto(argL->option("-c","5"),Rpi::Dma::Ctrl::Index()) ;
+    auto force = argL->pop_if("-f") ;
+    auto debug = argL->pop_if("-d") ;
+    std::vector<Device::Ws2812b::Parallel::Strip> strips ;
+    std::vector<uint32_t> colors ; colors.reserve(32) ;
+    // ...must not reallocate (the strips point to the elements)
+    do
+    {
+	auto pin = Ui::strto(argL->pop(),Rpi::Pin()) ;
+	auto nleds = Ui::strto<size_t>(argL->pop()) ;
+	if (colors.size() == 32)
+	    throw std::runtime_error("too many strips") ;
+	colors.push_back(Ui::strto<uint32_t>(argL->pop())) ;
+	strips.push_back(Device::Ws2812b::Parallel::Strip(pin,&colors.back(),nleds,0)) ;
+    }
+    while (!argL->empty()) ;
   
+    auto ticks = Device::Ws2812b::Circuit::asTicks(timing,freq) ;
+    Device::Ws2812b::Parallel edges(strips,ticks) ;
+    if (debug)
+	std::cout << "pins: 0x" << std::hex << edges.pins() << std::dec << ' '
+		  << "edges: " << edges.size() << '\n' ;
+
+    if (period)
+    {
+	auto pacing = pwmPacing(Ui::strto<double>(*period),freq) ;
+	RpiExt::Waveform waveform(pacing) ;
+	waveform.addAll(edges) ;
+	auto i = waveform.verify() ;
+	if (i != static_cast<size_t>(-1))
+	{
+	    if (!force)
+		throw std::runtime_error("timing violated at edge #" + std::to_string(i)) ;
+	    std::cout << "timing violated at edge #" << i << '\n' ;
+	}
+	auto allocator = RpiExt::VcMem::defaultAllocator() ;
+	waveform.load(allocator.get()) ;
+	auto channel = Rpi::Dma::Ctrl(rpi).channel(index) ;
+	waveform.submit(&channel) ;
+	RpiExt::Waveform::wait(&channel) ;
+	return ;
+    }
+
+    RpiExt::Serialize host(rpi) ;
+    RpiExt::Jitter jitter(static_cast<uint32_t>(bound * freq + .5)) ;
+    host.monitor(&jitter) ;
     decltype(max_retries) i = 0 ;
     bool success ;
     do {
 	++i ;
-	success = host.send(v) ;
+	Device::Ws2812b::Parallel edges(strips,ticks) ;
+	success = host.pull(edges) ;
     }
     while (!success && ((max_retries==0) || (i<max_retries))) ;
     if (!success)
 	std::cout << "failed\n" ;
     if (debug)
-	std::cout << "iterations: " <<  i << "\n" ;
+	std::cout << "iterations: " <<  i << '\n' ;
 }
 
 // --------------------------------------------------------------------
@@ -165,6 +278,120 @@ static Device::Ws2812b::BitStream::Seconds computeSeconds(
 	round(t.reset)) ;
 }
 
+static void bench(Rpi::Peripheral*,Ui::ArgL *argL)
+{
+    auto nleds = Ui::strto<size_t>(argL->option("-n","10000")) ;
+    auto nframes = Ui::strto<size_t>(argL->option("-r","100")) ;
+    auto seconds = getPwm(argL) ;
+    auto f = Ui::strto<double>(argL->pop()) ;
+    argL->finalize() ;
+
+    auto ticks = computeTicks(seconds,f) ;
+    Device::Ws2812b::Encoder encoder(ticks) ;
+
+    // distinct (random) values for each LED
+    std::vector<uint32_t> grb(nleds) ;
+    std::minstd_rand random ;
+    for (auto &v: grb)
+	v = static_cast<uint32_t>(random()) & 0xffffff ;
+
+    std::cout.setf(std::ios::scientific) ;
+    std::cout.precision(2) ;
+    std::cout << "timing (ticks)=" << ticks.toStr() << '\n' ;
+    
+    auto run = [&](char const *name,size_t nwords,std::function<size_t()> const &encode)
+    {
+	auto t0 = std::chrono::steady_clock::now() ;
+	size_t n = 0 ;
+	for (size_t i=0 ; i<nframes ; ++i)
+	    n = encode() ;
+	auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() ;
+	std::cout << name << ": "
+		  << static_cast<double>(nleds) * static_cast<double>(nframes) / dt << " LEDs/s "
+		  << "(" << n << "/" << nwords << " words)\n" ;
+    } ;
+    
+    std::vector<uint32_t> v32(encoder.size<uint32_t>(nleds)) ;
+    run(encoder.aligned<uint32_t>() ? "pwm (aligned)" : "pwm",v32.size(),[&] {
+	    return encoder.encode(&grb[0],nleds,1,&v32[0]) ; }) ;
+    
+    std::vector<uint8_t> v8(encoder.size<uint8_t>(nleds)) ;
+    run(encoder.aligned<uint8_t>() ? "spi (aligned)" : "spi",v8.size(),[&] {
+	    return encoder.encode(&grb[0],nleds,1,&v8[0]) ; }) ;
+
+    // RGB to GRB (gamma, brightness and dithering)
+    Device::Ws2812b::Color color(2.8,0.5) ;
+    std::vector<uint8_t> rgb(3*nleds) ;
+    for (auto &v: rgb)
+	v = static_cast<uint8_t>(random()) ;
+    run("color",grb.size(),[&] {
+	    color.rgb(&rgb[0],nleds,&grb[0]) ; return nleds ; }) ;
+}
+
+// animation: CHANGES random LEDs per frame; the frame is sent (by
+// another thread) while the next one is encoded
+template<typename T> static void animate(
+    Device::Ws2812b::BitStream::Ticks const &ticks,
+    size_t nleds,size_t nframes,size_t nchanges,
+    std::function<void(std::vector<T> const&)> const &send)
+{
+    Device::Ws2812b::Frame<T> frame(ticks,nleds) ;
+    std::minstd_rand random ;
+    std::future<void> sending ;
+    size_t nencoded = 0 ;
+    auto t0 = std::chrono::steady_clock::now() ;
+    for (size_t i=0 ; i<nframes ; ++i)
+    {
+	for (size_t j=0 ; j<nchanges ; ++j)
+	    frame.set(random() % nleds,static_cast<uint32_t>(random()) & 0xffffff) ;
+	nencoded += frame.prepare() ;
+	if (sending.valid())
+	    sending.get() ;
+	auto &v = frame.swap() ;
+	sending = std::async(std::launch::async,[&send,&v] { send(v) ; }) ;
+    }
+    if (sending.valid())
+	sending.get() ;
+    auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() ;
+    std::cout << "frames/s: " << static_cast<double>(nframes) / dt << ' '
+	      << "LEDs encoded/frame: " << static_cast<double>(nencoded) / static_cast<double>(nframes)
+	      << " (" << frame.front().size() << " words)\n" ;
+}
+
+static void frame(Rpi::Peripheral *rpi,Ui::ArgL *argL)
+{
+    auto nleds = Ui::strto<size_t>(argL->pop()) ;
+    auto seconds = getPwm(argL) ;
+    auto f = Ui::strto<double>(argL->pop()) ;
+    auto nframes = Ui::strto<size_t>(argL->option("-n","100")) ;
+    auto nchanges = Ui::strto<size_t>(argL->option("-c","1")) ;
+    auto sink = argL->pop({"none","pwm","spi0"}) ;
+    argL->finalize() ;
+    if (nleds == 0)
+	throw std::runtime_error("no LEDs") ;
+
+    std::cout.setf(std::ios::scientific) ;
+    std::cout.precision(2) ;
+    auto ticks = computeTicks(seconds,f) ;
+    
+    if (sink == 1)
+    {
+	RpiExt::Pwm pwm(rpi) ;
+	animate<uint32_t>(ticks,nleds,nframes,nchanges,[&pwm](std::vector<uint32_t> const &v) {
+		auto n = pwm.convey(&v[0],v.size(),0) ;
+		if (v.size() != n)
+		    std::cout << "failure (" << n << "/" << v.size() << ")\n" ;
+	    }) ;
+    }
+    else if (sink == 2)
+    {
+	RpiExt::Spi0 spi(rpi) ;
+	animate<uint8_t>(ticks,nleds,nframes,nchanges,[&spi](std::vector<uint8_t> const &v) {
+		spi.xfer(v) ; }) ;
+    }
+    else animate<uint32_t>(ticks,nleds,nframes,nchanges,[](std::vector<uint32_t> const&) {}) ;
+}
+
 static void pwm(Rpi::Peripheral *rpi,Ui::ArgL *argL)
 {
     auto nleds = Ui::strto<unsigned>(argL->pop()) ;
@@ -218,7 +445,11 @@ void Console::Device::Ws2812b::invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
     {
 	std::cout << "arguments: MODE\n"
 		  << '\n'
-		  << "MODE : bang NLEDS GRB [-t TIMING] [-f FREQ] PINS [-r RETRY] [-d]\n"
+		  << "MODE : bang NLEDS GRB [-t TIMING] [-f FREQ] PINS [-r RETRY] [-j BOUND] [-d]\n"
+		  << "     | bench [-n NLEDS] [-r FRAMES] [-t TIMING] FREQ\n"
+		  << "     | dma  NLEDS GRB [-t TIMING] PINS PERIOD [-c CHANNEL] [-n|ALLOC] [-f] [-d]\n"
+		  << "     | frame NLEDS [-t TIMING] FREQ [-n FRAMES] [-c CHANGES] SINK\n"
+		  << "     | multi [-t TIMING] [-r RETRY] [-j BOUND] [-p PERIOD [-c CHANNEL] [-f]] [-d] (PIN NLEDS GRB)+\n"
 		  << "     | pwm  NLEDS GRB [-t TIMING] FREQ [-d]\n"
 		  << "     | spi0 NLEDS GRB [-t TIMING] FREQ\n"
 		  << '\n'
@@ -235,6 +466,28 @@ void Console::Device::Ws2812b::invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
 		  << "Default values are the ones on the datasheet.\n"
 		  << '\n'
 		  << "-d : display debug information\n"
+		  << "-j : abort a bit-banged try early if a timing gap exceeds BOUND\n"
+		  << '\n'
+		  << "dma: the bit-banged edges are written to GPIO by DMA; the\n"
+		  << "delays are paced by the PWM FIFO (which must be set up with\n"
+		  << "DMA enabled and a cycle of PERIOD seconds). The channel\n"
+		  << "defaults to 5. Use -n to verify the waveform only. If the\n"
+		  << "timing is violated, the waveform isn't submitted unless -f\n"
+		  << "is given.\n"
+		  << '\n'
+		  << "bench: encode FRAMES of NLEDS (distinct values) for pwm and\n"
+		  << "spi0, and convert them from RGB; display the rates. NLEDS\n"
+		  << "defaults to 10000, FRAMES to 100.\n"
+		  << '\n'
+		  << "multi: up to 32 chains (each on its own pin) are bit-banged at\n"
+		  << "once; or written by DMA if a PERIOD is given (see dma).\n"
+		  << '\n'
+		  << "frame: send FRAMES (default 100) with CHANGES (default 1)\n"
+		  << "random LEDs each; only the changes are encoded. SINK is\n"
+		  << "one of: none, pwm, spi0.\n"
+		  << '\n'
+		  << "ALLOC = allocator for DMA bus memory:\n"
+		  << Rpi::Ui::Bus::Memory::allocatorSynopsis()
 		  << std::flush ;
 	// [todo] create files, read from file, read chains, read various chains
 	return ;
@@ -244,6 +497,10 @@ void Console::Device::Ws2812b::invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
     if (false) ;
   
     else if (arg == "bang") bang(rpi,argL) ;
+    else if (arg == "bench") bench(rpi,argL) ;
+    else if (arg ==  "dma")  dma(rpi,argL) ;
+    else if (arg == "frame") frame(rpi,argL) ;
+    else if (arg == "multi") multi(rpi,argL) ;
     else if (arg ==  "pwm")  pwm(rpi,argL) ;
     else if (arg == "spi0") spi0(rpi,argL) ;
   
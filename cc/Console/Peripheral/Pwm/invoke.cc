@@ -7,6 +7,7 @@
 #include <iomanip>
 #include <iostream>
 #include <thread> // this_thread::sleep_for
+#include <vector>
 #include <Neat/cast.h>
 #include <Neat/stream.h>
 #include <Rpi/ArmTimer.h>
@@ -14,6 +15,7 @@
 #include <RpiExt/Dma/Control.h>
 #include <RpiExt/VcMem.h>
 #include <RpiExt/Pwm.h>
+#include <RpiExt/PwmStream.h>
 #include <Rpi/Ui/Bus/Memory.h>
 #include <Rpi/Ui/Dma.h>
 #include <Ui/strto.h>
@@ -512,6 +514,87 @@ static void status(Rpi::Peripheral *rpi,Ui::ArgL *argL)
     while (i.next()) ;
 }
 
+static void stream(Rpi::Peripheral *rpi,Ui::ArgL *argL)
+{
+    if (argL->empty() || argL->peek() == "help")
+    {
+	std::cout
+	    << "arguments: CHANNEL [CS] [ALLOC] [-b NBUFFERS] [-w NWORDS] SECONDS FILE\n"
+	    << '\n'
+	    << "CHANNEL = DMA channel (0..15)\n"
+	    << '\n'
+	    << "CS = DMA Control and Status:\n"
+	    << Rpi::Ui::Dma::csSynopsis()
+	    << '\n'
+	    << "ALLOC = allocator for DMA bus memory:\n"
+	    << Rpi::Ui::Bus::Memory::allocatorSynopsis()
+	    << '\n'
+	    << "NBUFFERS = number of buffers in the DMA ring (default: 4)\n"
+	    << "NWORDS   = number of 32-bit words per buffer (default: 1024)\n"
+	    << "SECONDS  = duration of the transfer\n"
+	    << "FILE     = file with binary data to send (repeatedly)\n"
+	    << '\n'
+	    << "The PWM must be set-up for DMA transfers (see dmac).\n"
+	    ;
+	return ;
+    }
+
+    auto index = Ui::strto(argL->pop(),Rpi::Dma::Ctrl::Index()) ;
+    auto cs = Rpi::Ui::Dma::getCs(argL,Rpi::Dma::Cs()) ;
+    auto allocator = Rpi::Ui::Bus::Memory::
+	getAllocator(rpi,argL,RpiExt::VcMem::defaultAllocator()) ;
+    auto nbuffers = Ui::strto<size_t>(argL->option("-b","4")) ;
+    auto nwords = Ui::strto<size_t>(argL->option("-w","1024")) ;
+    auto seconds = Ui::strto<double>(argL->pop()) ;
+    auto data = readFile(argL->pop()) ;
+    argL->finalize() ;
+    if (data.empty())
+	throw std::runtime_error("empty file") ;
+
+    RpiExt::Pwm::Stream stream(rpi,index,allocator.get(),nbuffers,nwords) ;
+
+    // the file is sent round and round
+    std::vector<uint32_t> buffer(nwords) ;
+    size_t ofs = 0 ;
+    auto fill = [&]
+    {
+	while (stream.space() > 0)
+	{
+	    for (auto &word: buffer)
+	    {
+		word = data[ofs] ;
+		ofs = (ofs + 1) % data.size() ;
+	    }
+	    stream.put(&buffer[0]) ;
+	}
+    } ;
+
+    fill() ;
+    stream.start(cs) ;
+    auto t0 = std::chrono::steady_clock::now() ;
+    auto duration = std::chrono::duration<double>(seconds) ;
+    auto period = std::chrono::duration<double>(100e-6) ;
+    // ...the time to play a buffer; estimated from the buffers played
+    while (true)
+    {
+	auto status = stream.poll() ;
+	fill() ;
+	auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0) ;
+	if (elapsed >= duration)
+	    break ;
+	if (status.played > 0)
+	    period = elapsed / static_cast<double>(status.played) ;
+	std::this_thread::sleep_for(period / 2) ;
+	// ...poll twice per buffer
+    }
+    auto status = stream.poll() ;
+    stream.stop() ;
+
+    std::cout << "played=" << status.played << ' '
+	      << "underrun=" << status.underrun << ' '
+	      << "low=" << status.low << '\n' ;
+}
+
 void Console::Peripheral::Pwm::
 invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
 {
@@ -527,7 +610,8 @@ invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
 		  << "     | fifo-dma   # write FIFO by DMA\n"
 		  << "     | frequency  # estimate active transfer rate\n"
 		  << "     | range      # set Range register\n"
-		  << "     | status     # display register values\n" ;
+		  << "     | status     # display register values\n"
+		  << "     | stream     # continuous transfer by DMA ring\n" ;
 	return ;
     }
 
@@ -542,6 +626,7 @@ invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
 	{ "frequency",frequency },
 	{ "range"    ,    range },
 	{ "status"   ,   status },
+	{ "stream"   ,   stream },
     } ;
     argL->pop(map)(rpi,argL) ;
 }
@@ -0,0 +1,358 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "../rpio.h"
+
+#include <iostream>
+#include <math.h>
+#include <random>
+
+#include <Device/Ads1115/Bang/Generator.h>
+#include <Device/Ads1115/Model.h>
+#include <Device/Ds18b20/Model.h>
+#include <Device/Max7219/Bang.h>
+#include <Device/Max7219/Chain.h>
+#include <Device/Max7219/Model.h>
+#include <Device/Mcp3008/Bang.h>
+#include <Device/Mcp3008/Model.h>
+#include <Protocol/OneWire/Bang/Signaling.h>
+#include <RpiExt/Sim/Bang.h>
+#include <RpiExt/Sim/Io.h>
+#include <Ui/strto.h>
+
+using Bus = RpiExt::Sim::Bus ;
+
+// --------------------------------------------------------------------
+
+static void report(uint64_t t,RpiExt::Sim::Model const &model)
+{
+    auto min = model.minimum() ;
+    std::cout << "ticks: " << t << " (minimum: " << min ;
+    if (min > 0)
+	std::cout << ", ratio: " << static_cast<double>(t) / static_cast<double>(min) ;
+    std::cout << ")\n" ;
+    auto &v = model.violations() ;
+    std::cout << "violations: " << v.size() << '\n' ;
+    for (size_t i=0 ; i<v.size() && i<10 ; ++i)
+	std::cout << "    t=" << v[i].t << ' ' << v[i].what << '\n' ;
+    if (v.size() > 10)
+	std::cout << "    ...\n" ;
+}
+
+// --------------------------------------------------------------------
+
+static void ads1115Invoke(Bus *bus,double f,Ui::ArgL *argL)
+{
+    namespace Ads1115 = Device::Ads1115 ;
+    auto word = Ui::strto<uint16_t>(argL->option("-w","0x8583")) ;
+    auto value = Ui::strto<int16_t>(argL->option("-v","0x1234")) ;
+    argL->finalize() ;
+
+    auto ticks = [f](float seconds) {
+	return seconds <= 0.0 ? 0u :
+	static_cast<uint32_t>(ceil(f * seconds + 1.5)) ; } ;
+    Ads1115::Circuit::Timing<uint32_t> timing(
+	ticks(Ads1115::Circuit::fast_timing().  buf),
+	ticks(Ads1115::Circuit::fast_timing().hdsta),
+	ticks(Ads1115::Circuit::fast_timing().susto),
+	ticks(Ads1115::Circuit::fast_timing().sudat),
+	ticks(Ads1115::Circuit::fast_timing().hddat),
+	ticks(Ads1115::Circuit::fast_timing().  low),
+	ticks(Ads1115::Circuit::fast_timing(). high)) ;
+
+    auto scl = Rpi::Pin::make<0>() ;
+    auto sda = Rpi::Pin::make<1>() ;
+    auto addr = Ads1115::Circuit::Addr::make<0x48>() ;
+    Ads1115::Model model(scl,sda,addr,timing,f) ;
+    for (unsigned i=0 ; i<8 ; ++i)
+	model.input(Ads1115::Circuit::Source::coset(i),static_cast<int16_t>(value+static_cast<int>(i))) ;
+    bus->attach(&model) ;
+    bus->reset((1u<<scl.value()) | (1u<<sda.value())) ;
+    // ...the lines are driven by switching between Input and Output
+
+    Ads1115::Bang::Generator gen(Ads1115::Bang::Config(scl,sda,addr,timing)) ;
+    Ads1115::Bang::Record::Write wrecord ;
+    Ads1115::Bang::Record::Read crecord,srecord ;
+    auto wscript = gen.writeConfig(&wrecord,word) ;
+    auto cscript = gen.readConfig(&crecord) ;
+    auto sscript = gen.readSample(&srecord) ;
+
+    auto t0 = bus->now() ;
+    RpiExt::Bang::Virtual host(bus) ;
+    host.execute(wscript) ;
+    host.execute(cscript) ;
+    auto t1 = bus->now() ;
+    bus->elapse(static_cast<uint64_t>(f)) ; // ...a second for the conversion
+    host.execute(sscript) ;
+    auto t2 = bus->now() ;
+
+    std::cout << "write: " << (wrecord.verify(sda).success() ? "ack" : "nack") << '\n'
+	      << "config: " << std::hex << crecord.fetch(sda)
+	      << (crecord.verify(sda).success() ? "" : " (nack)") << '\n'
+	      << "sample: " << srecord.fetch(sda) << std::dec
+	      << (srecord.verify(sda).success() ? "" : " (nack)") << '\n'
+	      << "conversions: " << model.conversions() << '\n' ;
+    report((t1-t0) + (t2-t1-static_cast<uint64_t>(f)),model) ;
+    // ...without the time elapsed for the conversion
+}
+
+// --------------------------------------------------------------------
+
+static void ds18b20Invoke(Bus *bus,double f,Ui::ArgL *argL)
+{
+    auto rom = Ui::strto<uint64_t>(argL->option("-a","0x5a0000071f2a2b28")) ;
+    auto temp = Ui::strto<int16_t>(argL->option("-t","0x0191")) ;
+    argL->finalize() ;
+
+    auto pin = Rpi::Pin::make<4>() ;
+    Device::Ds18b20::Model model(pin,Device::Ds18b20::Model::Address(rom),f) ;
+    model.input(temp) ;
+    bus->attach(&model) ;
+
+    bus->reset(1u<<pin.value()) ;
+    bus->mode(Rpi::Gpio::Function::Update(pin,Rpi::Gpio::Function::Type::In)) ;
+    // ...open-drain: the line is driven by switching to Output (Low)
+
+    namespace OneWire = Protocol::OneWire::Bang ;
+    using Io = RpiExt::Sim::Io ;
+    OneWire::BasicMaster<Io> master(Io(bus),pin,OneWire::Timing::xlat(f)) ;
+    OneWire::BasicSignaling<Io> signaling(&master) ;
+
+    auto t0 = bus->now() ;
+    auto present = signaling.init() ;
+    signaling.write(OneWire::Rom::ReadRom) ;
+    auto address = signaling.read<64>().to_ullong() ;
+    signaling.init() ;
+    signaling.write(OneWire::Rom::SkipRom) ;
+    signaling.write(std::bitset<8>(0x44)) ; // Convert T
+    unsigned polls = 0 ;
+    while (signaling.isBusy())
+	++polls ;
+    signaling.init() ;
+    signaling.write(OneWire::Rom::SkipRom) ;
+    signaling.write(std::bitset<8>(0xbe)) ; // Read Scratch-Pad
+    auto lo = signaling.read<64>().to_ullong() ;
+    auto hi = signaling.read<8>().to_ulong() ;
+
+    std::cout << std::hex
+	      << "present: " << present << '\n'
+	      << "address: " << address << '\n'
+	      << "scratch-pad: " << lo << ' ' << hi << '\n'
+	      << std::dec
+	      << "temperature: " << static_cast<int16_t>(lo & 0xffff) / 16.0 << '\n'
+	      << "busy-polls: " << polls << '\n' ;
+    report(bus->now()-t0,model) ;
+}
+
+// --------------------------------------------------------------------
+
+// random row changes on a chain of devices: only the changed rows are
+// sent (see Device/Max7219/Chain.h)
+static void max7219ChainInvoke(Rpi::Peripheral *rpi,Bus *bus,double f,Ui::ArgL *argL)
+{
+    namespace Max7219 = Device::Max7219 ;
+    auto ndevices = Ui::strto<size_t>(argL->pop()) ;
+    auto nframes  = Ui::strto<size_t>(argL->pop()) ;
+    auto nchanges = Ui::strto<size_t>(argL->pop()) ;
+    argL->finalize() ;
+    if (ndevices == 0)
+	throw std::runtime_error("no devices given") ;
+
+    auto  din = Rpi::Pin::make<0>() ;
+    auto load = Rpi::Pin::make<1>() ;
+    auto  clk = Rpi::Pin::make<2>() ;
+    auto ticks = Max7219::Bang::asTicks(Max7219::Bang::strict(),f) ;
+    Max7219::Model model(din,load,clk,ticks,ndevices) ;
+    bus->attach(&model) ;
+    bus->mode(Rpi::Gpio::Function::Update(din ,Rpi::Gpio::Function::Type::Out)) ;
+    bus->mode(Rpi::Gpio::Function::Update(load,Rpi::Gpio::Function::Type::Out)) ;
+    bus->mode(Rpi::Gpio::Function::Update(clk ,Rpi::Gpio::Function::Type::Out)) ;
+
+    Max7219::Bang host(rpi,din,load,clk,ticks) ;
+    Max7219::Chain chain(ndevices) ;
+    std::mt19937 random ; // ...the default seed: reproducible
+    std::vector<uint16_t> words ;
+    size_t nlatches = 0 ;
+
+    auto t0 = bus->now() ;
+    for (size_t i=0 ; i<nframes ; ++i)
+    {
+	for (size_t j=0 ; j<nchanges ; ++j)
+	{
+	    auto device = random() % ndevices ;
+	    auto row = static_cast<unsigned>(random() % 8) ;
+	    chain.set(device,row,static_cast<uint8_t>(random())) ;
+	}
+	words.clear() ;
+	nlatches += chain.update(&words) ;
+	RpiExt::Bang::Enqueue q ;
+	for (size_t k=0 ; k<words.size() ; ++k)
+	{
+	    host.send(&q,words[k]) ;
+	    if ((k+1) % ndevices == 0)
+		host.load(&q) ;
+	}
+	RpiExt::Bang::Virtual(bus).execute(q.vector()) ;
+    }
+
+    size_t mismatch = 0 ;
+    for (size_t i=0 ; i<ndevices ; ++i)
+	for (unsigned row=0 ; row<8 ; ++row)
+	    if (model.reg(i,row+1) != chain.get(i,row))
+		++mismatch ;
+    std::cout << "latches: " << nlatches
+	      << " (full refresh: " << 8 * nframes << ")\n"
+	      << "mismatches: " << mismatch << '\n'
+	      << "writes: " << model.writes() << '\n' ;
+    report(bus->now()-t0,model) ;
+}
+
+static void max7219Invoke(Rpi::Peripheral *rpi,Bus *bus,double f,Ui::ArgL *argL)
+{
+    namespace Max7219 = Device::Max7219 ;
+    if (argL->pop_if("-u"))
+    {
+	max7219ChainInvoke(rpi,bus,f,argL) ;
+	return ;
+    }
+    std::vector<uint16_t> v ;
+    while (!argL->empty())
+	v.push_back(Ui::strto<uint16_t>(argL->pop())) ;
+    if (v.empty())
+	throw std::runtime_error("no words given") ;
+
+    auto  din = Rpi::Pin::make<0>() ;
+    auto load = Rpi::Pin::make<1>() ;
+    auto  clk = Rpi::Pin::make<2>() ;
+    auto ticks = Max7219::Bang::asTicks(Max7219::Bang::strict(),f) ;
+    Max7219::Model model(din,load,clk,ticks,v.size()) ;
+    bus->attach(&model) ;
+    bus->mode(Rpi::Gpio::Function::Update(din ,Rpi::Gpio::Function::Type::Out)) ;
+    bus->mode(Rpi::Gpio::Function::Update(load,Rpi::Gpio::Function::Type::Out)) ;
+    bus->mode(Rpi::Gpio::Function::Update(clk ,Rpi::Gpio::Function::Type::Out)) ;
+
+    Max7219::Bang host(rpi,din,load,clk,ticks) ;
+    RpiExt::Bang::Enqueue q ;
+    for (auto word: v)
+	host.send(&q,word) ;
+    host.load(&q) ;
+
+    auto t0 = bus->now() ;
+    RpiExt::Bang::Virtual(bus).execute(q.vector()) ;
+
+    for (size_t i=0 ; i<model.size() ; ++i)
+    {
+	std::cout << "device #" << i << ':' ;
+	for (unsigned addr=0 ; addr<16 ; ++addr)
+	    std::cout << ' ' << std::hex << static_cast<unsigned>(model.reg(i,addr)) ;
+	std::cout << std::dec << '\n' ;
+    }
+    std::cout << "writes: " << model.writes() << '\n' ;
+    report(bus->now()-t0,model) ;
+}
+
+// --------------------------------------------------------------------
+
+static void mcp3008Invoke(Rpi::Peripheral *rpi,Bus *bus,double f,Ui::ArgL *argL)
+{
+    namespace Mcp3008 = Device::Mcp3008 ;
+    auto source = Ui::strto(argL->pop(),Mcp3008::Circuit::Source()) ;
+    auto value = Ui::strto(argL->pop(),Mcp3008::Circuit::Sample()) ;
+    auto monitor = argL->pop_if("-m") ;
+    auto n = Ui::strto<size_t>(argL->option("-n","1")) ;
+    argL->finalize() ;
+
+    Mcp3008::Bang::Timing timing ;
+    auto ticks = [f](double d) {
+	return static_cast<uint32_t>(ceil(f * d + 1.5)) ; } ;
+    timing.csh  = ticks(Mcp3008::Circuit::timing_3v.csh ) ;
+    timing.sucs = ticks(Mcp3008::Circuit::timing_3v.sucs) ;
+    timing.hd   = ticks(Mcp3008::Circuit::timing_3v.hd  ) ;
+    timing.su   = ticks(Mcp3008::Circuit::timing_3v.su  ) ;
+    timing.en   = ticks(Mcp3008::Circuit::timing_3v.en  ) ;
+    timing.lo   = ticks(Mcp3008::Circuit::timing_3v.lo  ) ;
+    timing.hi   = ticks(Mcp3008::Circuit::timing_3v.hi  ) ;
+    timing.dov  = ticks(Mcp3008::Circuit::timing_3v.dov ) ;
+    timing.dis  = ticks(Mcp3008::Circuit::timing_3v.dis ) ;
+    timing.bled = ticks(Mcp3008::Circuit::timing_3v.bled) ;
+
+    auto   cs = Rpi::Pin::make<0>() ;
+    auto  clk = Rpi::Pin::make<1>() ;
+    auto  din = Rpi::Pin::make<2>() ;
+    auto dout = Rpi::Pin::make<3>() ;
+    Mcp3008::Model model(cs,clk,din,dout,timing) ;
+    model.input(source,value) ;
+    bus->attach(&model) ;
+    bus->set(1u<<cs.value()) ; // ...CS is high before it gets Output
+    bus->mode(Rpi::Gpio::Function::Update(cs ,Rpi::Gpio::Function::Type::Out)) ;
+    bus->mode(Rpi::Gpio::Function::Update(clk,Rpi::Gpio::Function::Type::Out)) ;
+    bus->mode(Rpi::Gpio::Function::Update(din,Rpi::Gpio::Function::Type::Out)) ;
+
+    Mcp3008::Bang host(rpi,cs,clk,din,dout,timing) ;
+    std::vector<Mcp3008::Bang::Record> v(n) ;
+    auto script = host.makeScript(source,monitor,v.data(),n) ;
+
+    auto t0 = bus->now() ;
+    RpiExt::Bang::Virtual(bus).execute(script) ;
+
+    size_t mismatch = 0 ; unsigned errors = 0 ;
+    for (auto &record : v)
+    {
+	if (host.msb(record).value() != value.value())
+	    ++mismatch ;
+	if (monitor)
+	    errors |= host.error(record).value() ;
+    }
+    std::cout << "sample: " << host.msb(v[0]).value() ;
+    if (mismatch > 0)
+	std::cout << " (" << mismatch << " mismatches)" ;
+    std::cout << '\n' ;
+    if (monitor)
+	std::cout << "error: " << std::hex << errors << std::dec << '\n' ;
+    std::cout << "conversions: " << model.conversions() << '\n' ;
+    report(bus->now()-t0,model) ;
+}
+
+// --------------------------------------------------------------------
+
+void Console::Sim::invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
+{
+    if (argL->empty() || argL->peek() == "help")
+    {
+	std::cout << "arguments: [-f FREQ] [-c COUNTER READ WRITE] DEVICE\n"
+		  << '\n'
+		  << "Executes the device's bit-banging code on a virtual bus\n"
+		  << "against a behavioral model of the device; in virtual time.\n"
+		  << "The device classes still set up their pins (0..4) in the\n"
+		  << "peripheral window; hence, use a simulated one (--anon).\n"
+		  << '\n'
+		  << "FREQ: ARM counter frequency to assume (default 250e+6)\n"
+		  << "COUNTER, READ, WRITE: ticks per access (default 12 12 4)\n"
+		  << '\n'
+		  << "DEVICE : ads1115 [-w WORD] [-v VALUE]    # write config, read sample\n"
+		  << "       | ds18b20 [-a ADDRESS] [-t TEMP]   # read ROM, convert, read pad\n"
+		  << "       | max7219 WORD...                  # shift words into a chain\n"
+		  << "       | max7219 -u N FRAMES CHANGES      # random rows by Chain\n"
+		  << "       | mcp3008 SOURCE VALUE [-m] [-n N] # query N samples\n" ;
+	return ;
+    }
+
+    auto f = Ui::strto<double>(argL->option("-f","250e+6")) ;
+    Bus::Cost cost ;
+    if (argL->pop_if("-c"))
+    {
+	cost.counter = Ui::strto<uint32_t>(argL->pop()) ;
+	cost.read    = Ui::strto<uint32_t>(argL->pop()) ;
+	cost.write   = Ui::strto<uint32_t>(argL->pop()) ;
+    }
+    Bus bus(cost) ;
+
+    auto arg = argL->pop() ;
+    if (false) ;
+
+    else if (arg == "ads1115") ads1115Invoke(&bus,f,argL) ;
+    else if (arg == "ds18b20") ds18b20Invoke(&bus,f,argL) ;
+    else if (arg == "max7219") max7219Invoke(rpi,&bus,f,argL) ;
+    else if (arg == "mcp3008") mcp3008Invoke(rpi,&bus,f,argL) ;
+
+    else throw std::runtime_error("not supported option:<"+arg+'>') ;
+}
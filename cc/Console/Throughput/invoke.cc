@@ -8,6 +8,8 @@
 #include <Neat/cast.h>
 #include <Neat/safe_int.h>
 #include <Rpi/Peripheral.h>
+#include <Rpi/Register.h>
+#include <RpiExt/Bang.h>
 #include <Ui/strto.h>
 
 #include <chrono>
@@ -488,6 +490,57 @@ static void invoke_nn(Rpi::Peripheral *rpi,rep_t rep,Ui::ArgL *argL)
   else throw std::runtime_error("not supported option:<"+arg+'>') ;
 }
 
+static void invoke_at(Rpi::Peripheral *rpi_,rep_t rep,Ui::ArgL *argL)
+{
+  auto arg = argL->pop() ;
+  argL->finalize() ;
+  Rpi::Peripheral * volatile rpi = rpi_ ;
+  // ...volatile to prevent the loop-invariant call to be hoisted
+  uint32_t volatile * volatile p ;
+  auto t0 = now() ;
+  if (arg == "page") {
+    for (decltype(rep) i=0 ; i<rep ; ++i)
+      p = & rpi->page(Rpi::Peripheral::PNo::make<0x200>())->at<0x34/4>() ;
+  }
+  else if (arg == "traits") {
+    for (decltype(rep) i=0 ; i<rep ; ++i)
+      p = rpi->at<Rpi::Register::Gpio::Input::Bank0>().value() ;
+  }
+  else throw std::runtime_error("not supported option:<"+arg+'>') ;
+  report(rep,1,t0) ;
+  (void)p ;
+}
+
+static void invoke_bang(Rpi::Peripheral *rpi,rep_t rep,Ui::ArgL *argL)
+{
+  auto n = Ui::strto<size_t>(argL->pop()) ;
+  auto arg = argL->pop() ;
+  argL->finalize() ;
+  RpiExt::Bang bang(rpi) ;
+  RpiExt::Bang::Enqueue q ;
+  uint32_t levels ;
+  for (size_t i=0 ; i<n ; ++i) {
+    q.set(0) ;
+    q.reset(0) ;
+    q.levels(&levels) ;
+  }
+  // ...no pin is touched (zero is written to GPSET0 and GPCLR0)
+  auto script = q.vector() ;
+  auto t0 = now() ;
+  if (arg == "script") {
+    for (decltype(rep) i=0 ; i<rep ; ++i)
+      bang.execute(script) ;
+  }
+  else if (arg == "program") {
+    auto program = bang.compile(script) ;
+    t0 = now() ;
+    for (decltype(rep) i=0 ; i<rep ; ++i)
+      bang.execute(program) ;
+  }
+  else throw std::runtime_error("not supported option:<"+arg+'>') ;
+  report(rep,script.size(),t0) ;
+}
+
 // --------------------------------------------------------------------
 
 void invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
@@ -503,12 +556,18 @@ void invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
 	      << "          | n:0 N SRCN      ( blck M | iter |        )\n"
 	      << "          | n:1 N SRCN DST1 ( blck M | iter |        )\n"
 	      << "          | n:n N SRCN DSTN ( blck M | iter | libc   )\n"
+	      << "          | at ( page | traits )\n"
+	      << "          | bang N ( script | program )\n"
 	      << '\n'
 	      << "      REP : number of repetitions\n"
 	      << "        N : number of 32-bit words to transfer\n"
 	      << "   blck M : use buffer of M 32-bit words\n"
 	      << "   pool M : perform M copy/read/write operations at once\n"
 	      << "     libc : Lib-C's memset (0:n) or memcpy (n:n)\n"
+	      << "       at : acquire a peripheral register pointer (GPLEV0)\n"
+	      << "            by Peripheral::page(PNo) or by at<Traits>()\n"
+	      << "     bang : execute N times (Set,Reset,Levels) as Bang script\n"
+	      << "            or as compiled Bang::Program (commands per second)\n"
 	      << '\n'
 	      << "SRC1,DST1 : LOCATION1\n"
 	      << "SRCN,DSTN : LOCATIONN\n"
@@ -536,6 +595,8 @@ void invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL)
   else if (arg == "n:0") invoke_n0(rpi,rep,argL) ;
   else if (arg == "n:1") invoke_n1(rpi,rep,argL) ;
   else if (arg == "n:n") invoke_nn(rpi,rep,argL) ;
+  else if (arg == "at" ) invoke_at(rpi,rep,argL) ;
+  else if (arg == "bang") invoke_bang(rpi,rep,argL) ;
   
   else throw std::runtime_error("not supported option:<"+arg+'>') ; 
 }
@@ -2,6 +2,7 @@
 
 #include "rpio.h"
 #include <Posix/base.h>
+#include <Rpi/Shadow.h>
 #include <Ui/strto.h>
 #include <iostream>
 
@@ -15,6 +16,25 @@ static Posix::Fd::uoff_t base_addr(Ui::ArgL *argL)
     return Rpi::Peripheral::by_cpuinfo() ;
 }
 
+static std::shared_ptr<Rpi::Peripheral> make(Ui::ArgL *argL,Rpi::Shadow::shared_ptr *shadow)
+{
+    Posix::Fd::shared_ptr file ;
+    auto path = argL->option("--shadow") ;
+    if (path)
+	file = Posix::Fd::open(path->c_str(),Posix::Fd::Open::RW) ;
+    else if (argL->pop_if("--anon"))
+	file = Posix::Fd::temporary() ;
+    else
+	return Rpi::Peripheral::make(base_addr(argL)) ;
+    auto rpi = Rpi::Peripheral::shadow(file) ;
+    if (argL->pop_if("--trap"))
+	(*shadow) = Rpi::Shadow::trap(rpi,Rpi::Shadow::Step(25),Rpi::Shadow::Step(1)) ;
+    // ...100ns per read of the ARM counter (at 250 MHz), 1us per
+    //    read of the system timer
+    else (*shadow) = Rpi::Shadow::start(rpi,Rpi::Shadow::defaults(rpi.get())) ;
+    return rpi ;
+}
+
 static void help()
 {
     std::cout
@@ -22,16 +42,28 @@ static void help()
 	<< '\n'
 	<< "BASE : --base ADDRESS  # use 0x20000000 (ARMv6) or 0x3f000000\n"
 	<< "     | --devtree       # use info in /proc/device-tree/soc/ranges\n"
+	<< "     | --shadow FILE   # simulate peripherals in a (sparse) file\n"
+	<< "     | --anon          # simulate peripherals in anonymous memory\n"
+	<< "       [--trap]        # ...without background thread (see below)\n"
 	<< '\n'
 	<< "If BASE is not given then the peripheral address is derived from\n"
 	<< "the processor's model name (i.e. ARMv6/7/8) in /proc/cpuinfo.\n"
 	<< '\n'
+	<< "A simulated peripheral window (16 MB) emulates only a few side-\n"
+	<< "effects: ARM counter, system timer, GPIO levels and FIFO flags.\n"
+	<< "It serves to run and to profile the tool on a build host.\n"
+	<< "With --trap each access to an emulated register is trapped:\n"
+	<< "the counters advance by a fixed step per read and the writes\n"
+	<< "take effect in order. So the profiles are reproducible (there\n"
+	<< "is no concurrent thread); x86-64 Linux hosts only.\n"
+	<< '\n'
 	<< "MODE : defect      # defect report\n"
 	<< "     | device      # control a remote device\n"
 	<< "     | peripheral  # peripheral's access\n"
 	<< "     | poke        # r/w any word in peripheral address space\n"
 	<< "     | sample      # sample data\n"
 	<< "     | shm         # shared memory control (POSIX IPC)\n"
+	<< "     | sim         # run device code on a virtual bus\n"
 	<< "     | throughput  # i/o and memory performance tests\n"
 	<< '\n'
 	<< "Use the keyword help for additional information.\n"
@@ -49,7 +81,8 @@ int main(int argc,char **argv)
 	    help() ; return 0 ;
 	}
     
-	auto rpi = Rpi::Peripheral::make(base_addr(&argL)) ;
+	Rpi::Shadow::shared_ptr shadow ;
+	auto rpi = make(&argL,&shadow) ;
 	Posix::reset_uid() ;
 
 	using namespace Console ;
@@ -61,6 +94,7 @@ int main(int argc,char **argv)
 	    { "peripheral",Peripheral::invoke },
 	    { "sample",Sample::invoke },
 	    { "shm",Shm::invoke },
+	    { "sim",Sim::invoke },
 	    { "throughput",Throughput::invoke },
 	} ;
 	argL.pop(map)(rpi.get(),&argL) ;
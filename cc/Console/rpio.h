@@ -14,6 +14,7 @@ namespace Console
     namespace       Poke { void invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL) ; }
     namespace        Shm { void invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL) ; }
     namespace     Sample { void invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL) ; }
+    namespace        Sim { void invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL) ; }
     namespace Throughput { void invoke(Rpi::Peripheral *rpi,Ui::ArgL *argL) ; }
 }
 
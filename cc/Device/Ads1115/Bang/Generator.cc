@@ -46,6 +46,28 @@ void Generator::sendBit(Draft *draft,Line prev,Line next,uint32_t *t0)
     draft->low(this->config.sclPin) ; 
 }
 
+void Generator::sendBit(Draft *draft,uint32_t const *bit,uint32_t *t0)
+{
+    using Command = RpiExt::Bang::Command ;
+    draft->time(t0) ;
+    draft->sleep(this->config.timing.hddat) ; 
+    auto branch = draft->label() ;
+    draft->branch(bit,Command::Op::Ne,0,0) ; // ...target see below
+    draft->low(this->config.sdaPin) ;
+    auto jump = draft->label() ;
+    draft->jump(0) ; // ...target see below
+    draft->q[branch] = Command::branch(bit,Command::Op::Ne,0,draft->label()) ;
+    draft->off(this->config.sdaPin) ;
+    draft->q[jump] = Command::jump(draft->label()) ;
+    draft->sleep(this->config.timing.sudat) ; 
+    draft->wait(t0,this->config.timing.low) ;
+    draft->off(this->config.sclPin) ; 
+    draft->sleep(this->config.timing.high) ;
+    draft->low(this->config.sclPin) ; 
+}
+// ...as above, but the level is taken from the bit at execution time
+//    (the previous one isn't known; so SDA is always set)
+
 void Generator::recvBit(Draft *draft,Line sda,uint32_t *t0,uint32_t *levels)
 {
     draft->time(t0) ;
@@ -77,6 +99,15 @@ sendByte(Draft *draft,Line sda,uint8_t byte,uint32_t *t0,uint32_t *ack)
     this->recvBit(draft,sda,t0,ack) ;
 }
 
+void Generator::
+sendByte(Draft *draft,uint32_t const *bits,uint32_t *t0,uint32_t *ack)
+{
+    for (size_t i=0 ; i<8 ; ++i)
+	this->sendBit(draft,bits+i,t0) ;
+    this->recvBit(draft,Line::Low,t0,ack) ;
+    // ...Low: SDA is released for the ack in any case
+}
+
 void Generator::
 recvByte(Draft *draft,Line sda,uint32_t *t0,Record::Read::Byte *byte)
 {
@@ -108,9 +139,14 @@ void Generator::read(Draft *draft,Record::Read *record,uint8_t reg)
     this->sendByte(draft,Line::Off,reg,&record->t0,&record->ackA.at(1)) ;
     this->stop(draft,Line::Off,&record->t0) ;
     
+    this->readAgain(draft,record) ;
+}
+
+void Generator::readAgain(Draft *draft,Record::Read *record)
+{
     this->start(draft) ;
     // (address + read-bit)
-    byte = static_cast<uint8_t>((this->config.addr.value()<<1) | 1) ;
+    auto byte = static_cast<uint8_t>((this->config.addr.value()<<1) | 1) ;
     this->sendByte(draft,Line::Low,byte,&record->t0,&record->ackA.at(2)) ;
     // <- 16-bit register-value
     this->recvByte(draft,Line::Off,&record->t0,&record->byteA.at(0)) ;
@@ -129,13 +165,18 @@ void Generator::readSample(Draft *draft,Record::Read *record)
 }
 
 void Generator::writeConfig(Draft *draft,Record::Write *record,uint16_t word)
+{
+    this->writeRegister(draft,record,/*config-register:*/0x1,word) ;
+}
+
+void Generator::writeRegister(Draft *draft,Record::Write *record,uint8_t reg,uint16_t word)
 {
     this->start(draft) ;
     // (address + write-bit)
     auto byte = static_cast<uint8_t>((this->config.addr.value()<<1) | 0) ;
     this->sendByte(draft,Line::Low,byte,&record->t0,&record->ackA.at(0)) ;
-    // -> register-pointer (config-register hard-wired)
-    this->sendByte(draft,Line::Off,1,&record->t0,&record->ackA.at(1)) ;
+    // -> register-pointer
+    this->sendByte(draft,Line::Off,reg,&record->t0,&record->ackA.at(1)) ;
     // -> 16-bit register-value
     byte = static_cast<uint8_t>(word>>8) ;
     this->sendByte(draft,Line::Off,byte,&record->t0,&record->ackA.at(2)) ;
@@ -144,6 +185,27 @@ void Generator::writeConfig(Draft *draft,Record::Write *record,uint16_t word)
     this->stop(draft,Line::Off,&record->t0) ;
 }
 
+void Generator::writeRegister(Draft *draft,Record::Write *record,Payload const *payload)
+{
+    this->start(draft) ;
+    // (address + write-bit)
+    auto byte = static_cast<uint8_t>((this->config.addr.value()<<1) | 0) ;
+    this->sendByte(draft,Line::Low,byte,&record->t0,&record->ackA.at(0)) ;
+    // -> register-pointer
+    this->sendByte(draft,&payload->bits[0],&record->t0,&record->ackA.at(1)) ;
+    // -> 16-bit register-value
+    this->sendByte(draft,&payload->bits[8],&record->t0,&record->ackA.at(2)) ;
+    this->sendByte(draft,&payload->bits[16],&record->t0,&record->ackA.at(3)) ;
+    this->stop(draft,Line::Off,&record->t0) ;
+}
+
+void Generator::Payload::set(uint8_t reg,uint16_t word)
+{
+    auto w = (static_cast<uint32_t>(reg) << 16) | word ;
+    for (size_t i=0 ; i<24 ; ++i)
+	this->bits[i] = (w >> (23-i)) & 1u ;
+}
+
 // --------------------------------------------------------------------
 
 Generator::Script Generator::reset(Record::Reset *record)
@@ -167,9 +229,30 @@ Generator::Script Generator::readSample(Record::Read *record)
     return draft.vector() ;
 }
 
+Generator::Script Generator::readAgain(Record::Read *record)
+{
+    Draft draft ;
+    this->readAgain(&draft,record) ;
+    return draft.vector() ;
+}
+
 Generator::Script Generator::writeConfig(Record::Write *record,uint16_t word)
 {
     Draft draft ;
     this->writeConfig(&draft,record,word) ;
     return draft.vector() ;
 }
+
+Generator::Script Generator::writeRegister(Record::Write *record,uint8_t reg,uint16_t word)
+{
+    Draft draft ;
+    this->writeRegister(&draft,record,reg,word) ;
+    return draft.vector() ;
+}
+
+Generator::Script Generator::writeRegister(Record::Write *record,Payload const *payload)
+{
+    Draft draft ;
+    this->writeRegister(&draft,record,payload) ;
+    return draft.vector() ;
+}
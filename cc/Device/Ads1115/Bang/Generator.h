@@ -20,6 +20,25 @@ struct Generator
     Script readConfig (Record::Read*) ;
     Script readSample (Record::Read*) ;
     Script writeConfig(Record::Write*,uint16_t word) ;
+
+    // read the register the pointer was set to before (i.e. without
+    // writing the pointer; the first two acks are left untouched)
+    Script readAgain(Record::Read*) ;
+
+    // any of the registers: 1:config, 2:lo-thresh, 3:hi-thresh
+    Script writeRegister(Record::Write*,uint8_t reg,uint16_t word) ;
+
+    // the register and the value of a write, one word per bit (MSB
+    // first; zero: Low); the script below reads them at execution
+    struct Payload
+    {
+	std::array<uint32_t,24> bits ;
+	Payload() { this->set(0,0) ; }
+	void set(uint8_t reg,uint16_t word) ;
+    } ;
+
+    // as above, but the same script for any register and value
+    Script writeRegister(Record::Write*,Payload const*) ;
 	
 private:
 
@@ -38,16 +57,21 @@ private:
     
     void recvBit(Draft*,Line sda,uint32_t *t0,uint32_t *levels) ;
     void sendBit(Draft*,Line from,Line to,uint32_t *t0) ;
+    void sendBit(Draft*,uint32_t const *bit,uint32_t *t0) ;
 
     void recvByte(Draft*,Line sda,uint32_t *t0,Record::Read::Byte*) ;
     void sendByte(Draft*,Line sda,uint8_t byte,uint32_t *t0,uint32_t *ack) ;
+    void sendByte(Draft*,uint32_t const *bits,uint32_t *t0,uint32_t *ack) ;
     
     void read(Draft*,Record::Read*,uint8_t reg) ;
+    void readAgain(Draft*,Record::Read*) ;
 	
     void reset      (Draft*,Record::Reset*) ;
     void readConfig (Draft*,Record::Read*) ;
     void readSample (Draft*,Record::Read*) ;
     void writeConfig(Draft*,Record::Write*,uint16_t word) ;
+    void writeRegister(Draft*,Record::Write*,uint8_t reg,uint16_t word) ;
+    void writeRegister(Draft*,Record::Write*,Payload const*) ;
 } ;
 
 } } }
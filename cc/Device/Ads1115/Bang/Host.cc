@@ -1,40 +1,86 @@
 // BSD 2-Clause License, see github.com/ma16/rpio
 
 #include "Host.h"
-#include "Generator.h"
 
 using namespace Device::Ads1115 ;
 
+Bang::Host::Host(Rpi::Peripheral *rpi,Config const &config)
+    : config(config),bang(rpi),io(rpi),rdyMask(0)
+    , againRecord(),pointer(-1)
+{
+    Generator gen(config) ;
+    this->resetScript  = gen.reset     (&this->resetRecord) ;
+    this->configScript = gen.readConfig(&this->configRecord) ;
+    this->sampleScript = gen.readSample(&this->sampleRecord) ;
+    this->againScript  = gen.readAgain (&this->againRecord) ;
+    // ...the acks of the pointer write remain zero (i.e. success)
+    this->writeScript  = gen.writeRegister(&this->writeRecord,&this->writePayload) ;
+}
+
 Bang::Record::Reset Bang::Host::reset()
 {
-    Record::Reset record ;
-    auto script = Generator(config).reset(&record) ;
-    RpiExt::Bang(this->rpi).execute(script) ;
-    return record ;
+    this->bang.execute(this->resetScript) ;
+    this->pointer = -1 ;
+    return this->resetRecord ;
 }
 
 Bang::Record::Read Bang::Host::readConfig()
 {
-    Record::Read record ;
-    auto script = Generator(config).readConfig(&record) ;
-    RpiExt::Bang(this->rpi).execute(script) ;
-    return record ;
+    this->bang.execute(this->configScript) ;
+    this->point(this->configRecord,/*config:*/1) ;
+    return this->configRecord ;
 }
 
 Bang::Record::Read Bang::Host::readSample()
 {
-    Record::Read record ;
-    auto script = Generator(config).readSample(&record) ;
-    RpiExt::Bang(this->rpi).execute(script) ;
-    return record ;
+    this->bang.execute(this->sampleScript) ;
+    this->point(this->sampleRecord,/*conversion:*/0) ;
+    return this->sampleRecord ;
+}
+
+Bang::Record::Read Bang::Host::readNext()
+{
+    if (this->pointer != 0)
+	return this->readSample() ;
+    this->bang.execute(this->againScript) ;
+    return this->againRecord ;
 }
 
 Bang::Record::Write Bang::Host::writeConfig(uint16_t word)
 {
-    Record::Write record ;
-    auto script = Generator(config).writeConfig(&record,word) ;
-    RpiExt::Bang(this->rpi).execute(script) ;
-    return record ;
+    return this->writeRegister(/*config-register:*/0x1,word) ;
+}
+
+Bang::Record::Write Bang::Host::writeRegister(uint8_t reg,uint16_t word)
+{
+    this->writePayload.set(reg,word) ;
+    this->bang.execute(this->writeScript) ;
+    this->point(this->writeRecord,reg) ;
+    return this->writeRecord ;
+}
+
+Bang::Record::Write Bang::Host::startContinuous(uint16_t word)
+{
+    return this->writeConfig(static_cast<uint16_t>(word & ~0x100u)) ;
 }
 
+std::array<Bang::Record::Write,2> Bang::Host::ready(Rpi::Pin rdyPin)
+{
+    std::array<Record::Write,2> records ;
+    records[0] = this->writeRegister(/*lo-thresh:*/0x2,0x0000) ;
+    records[1] = this->writeRegister(/*hi-thresh:*/0x3,0x8000) ;
+    this->io.mode(rdyPin,Rpi::Gpio::Function::Type::In) ;
+    this->io.detect(rdyPin,Rpi::Register::Gpio::Event::Type::Fall) ;
+    this->rdyMask = 1u << rdyPin.value() ;
+    this->io.events(this->rdyMask) ;
+    // ...discard a stale event
+    return records ;
+}
 
+bool Bang::Host::waitReady(uint32_t timeout)
+{
+    if (this->rdyMask == 0)
+	throw std::runtime_error("Ads1115:no ALERT/RDY pin") ;
+    auto t0 = this->io.time() ;
+    return 0 != this->io.waitForEvent(t0,timeout,this->rdyMask) ;
+}
@@ -1,11 +1,31 @@
 // BSD 2-Clause License, see github.com/ma16/rpio
 
+// --------------------------------------------------------------------
+// The scripts of the transactions are generated once (when the Host is
+// constructed) and then re-executed; each one writes to its own record
+// which is returned as a copy. Hence, the Host can't be copied. The
+// script to write a register takes the register and the value from a
+// payload (see Generator::Payload), so it serves any write.
+//
+// Continuous-conversion mode: the config is written once with MODE=0
+// (see startContinuous), then only the conversion register is read
+// (see readNext). The ALERT/RDY pin may signal the end of each
+// conversion (an 8us low pulse): set the MSB of the hi-thresh register
+// and clear the one of the lo-thresh register (see ready) and set
+// COMP_QUE to anything but 11 (which disables the pin). The Host
+// detects the falling edge on the Pi's pin connected to ALERT/RDY (see
+// waitReady).
+// --------------------------------------------------------------------
+
 #ifndef INCLUDE_Device_Ads1115_Bang_Host_h
 #define INCLUDE_Device_Ads1115_Bang_Host_h
 
 #include "Config.h"
+#include "Generator.h"
 #include "Record.h"
 #include <Rpi/Peripheral.h>
+#include <RpiExt/BangIo.h>
+#include <array>
 
 namespace Device { namespace Ads1115 { namespace Bang {
 
@@ -15,13 +35,53 @@ struct Host
     Record::Read readConfig() ;
     Record::Read readSample() ;
     Record::Write writeConfig(uint16_t word) ;
-    
-    Host(Rpi::Peripheral *rpi,Config const &config) : rpi(rpi),config(config) {}
+    Record::Write writeRegister(uint8_t reg,uint16_t word) ;
+
+    // write config with the MODE bit (8) cleared
+    Record::Write startContinuous(uint16_t word) ;
+
+    // read the conversion register; the pointer register is only
+    // written if it doesn't point there already (about half the
+    // I2C traffic of readSample)
+    Record::Read readNext() ;
+
+    // set up ALERT/RDY as conversion-ready pin (both thresholds are
+    // written; the records of both must be verified); the Pi's pin is
+    // switched to input
+    std::array<Record::Write,2> ready(Rpi::Pin rdyPin) ;
+
+    // wait for the falling edge of ALERT/RDY (busy loop); false if
+    // none within timeout (ARM counter ticks)
+    bool waitReady(uint32_t timeout) ;
+
+    Host(Rpi::Peripheral *rpi,Config const &config) ;
+
+    Host(Host const&) = delete ;
+    Host& operator=(Host const&) = delete ;
 
 private:
 
-    Rpi::Peripheral *rpi ; Config config ;
-    
+    Config config ; RpiExt::Bang bang ; RpiExt::BangIo io ;
+
+    uint32_t rdyMask ; // the ALERT/RDY pin (if any)
+
+    Record::Reset resetRecord ; Generator::Script resetScript ;
+    Record::Read configRecord ; Generator::Script configScript ;
+    Record::Read sampleRecord ; Generator::Script sampleScript ;
+    Record::Read againRecord  ; Generator::Script againScript ;
+
+    Record::Write writeRecord ; Generator::Script writeScript ;
+    Generator::Payload writePayload ; // ...read by writeScript
+
+    int pointer ; // the device's register pointer (-1: unknown)
+
+    // the pointer is set to reg if the pointer write was acknowledged
+    // (and is unknown otherwise)
+    template<typename R> void point(R const &record,int reg)
+    {
+	auto error = record.verify(this->config.sdaPin) ;
+	this->pointer = (error.noAck_0 | error.noAck_1) ? -1 : reg ;
+    }
 } ;
 
 } } }
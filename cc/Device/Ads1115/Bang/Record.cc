@@ -1,4 +1,5 @@
 #include "Record.h"
+#include <cstddef>
 
 using namespace Device::Ads1115::Bang::Record ;
 
@@ -4,6 +4,7 @@
 #define INCLUDE_Device_Ads1115_Bang_Record_h
 
 #include <array>
+#include <cstdint>
 #include <Rpi/Pin.h>
 
 namespace Device { namespace Ads1115 { namespace Bang {
@@ -0,0 +1,130 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Host.h"
+#include <chrono>
+
+using Host = Device::Ads1115::Bsc::Host ;
+
+void Host::Batch::write(uint8_t reg,uint16_t word)
+{
+    this->accesses.push_back(Access {
+	    { reg,static_cast<uint8_t>(word >> 8),static_cast<uint8_t>(word) },{ 0,0 } }) ;
+    auto &a = this->accesses.back() ;
+    this->transfers.push_back(Rpi::Bsc::Transfer(this->addr,a.tx,3,nullptr,0)) ;
+    this->pointer = reg ;
+}
+
+void Host::Batch::read(uint8_t reg)
+{
+    this->accesses.push_back(Access { { reg,0,0 },{ 0,0 } }) ;
+    auto &a = this->accesses.back() ;
+    this->transfers.push_back(Rpi::Bsc::Transfer(this->addr,a.tx,1,a.rx,2)) ;
+    this->pointer = reg ;
+}
+
+void Host::Batch::readAgain()
+{
+    this->accesses.push_back(Access { { 0,0,0 },{ 0,0 } }) ;
+    auto &a = this->accesses.back() ;
+    this->transfers.push_back(Rpi::Bsc::Transfer(this->addr,nullptr,0,a.rx,2)) ;
+}
+
+uint16_t Host::Batch::word(size_t i) const
+{
+    auto &a = this->accesses.at(i) ;
+    return static_cast<uint16_t>((a.rx[0] << 8) | a.rx[1]) ;
+}
+
+Host::Host(Rpi::Peripheral *rpi,Rpi::Bsc::Index index,Circuit::Addr addr)
+    : controller(rpi,index),addr(addr),pointer(-1)
+    , configBatch(addr),sampleBatch(addr),againBatch(addr)
+{
+    this->configBatch.read(/*config:*/0x1) ;
+    this->sampleBatch.read(/*conversion:*/0x0) ;
+    this->againBatch.readAgain() ;
+}
+
+void Host::execute(Batch *batch)
+{
+    auto status = this->controller.execute(batch->transfers.data(),batch->transfers.size()) ;
+    if (batch->pointer != -1)
+	this->pointer = batch->pointer ;
+    if (status != 0)
+    {
+	this->pointer = -1 ;
+	if (status & Rpi::Bsc::Clkt)
+	    throw Error("clock stretch timeout") ;
+	if (status & Rpi::Bsc::Err)
+	    throw Error("no acknowledge") ;
+	throw Error("incomplete read") ;
+    }
+}
+
+void Host::reset()
+{
+    uint8_t const cmd = 0x06 ;
+    Rpi::Bsc::Transfer t(Rpi::Bsc::Addr::make<0>(),&cmd,1,nullptr,0) ;
+    // ...the general call address
+    if (0 != this->controller.execute(&t,1))
+	throw Error("reset not acknowledged") ;
+    this->pointer = -1 ;
+}
+
+uint16_t Host::readConfig()
+{
+    this->execute(&this->configBatch) ;
+    return this->configBatch.word(0) ;
+}
+
+uint16_t Host::readSample()
+{
+    this->execute(&this->sampleBatch) ;
+    return this->sampleBatch.word(0) ;
+}
+
+void Host::writeConfig(uint16_t word)
+{
+    this->writeRegister(/*config:*/0x1,word) ;
+}
+
+void Host::writeRegister(uint8_t reg,uint16_t word)
+{
+    Batch batch(this->addr) ;
+    batch.write(reg,word) ;
+    this->execute(&batch) ;
+}
+
+void Host::startContinuous(uint16_t word)
+{
+    this->writeConfig(static_cast<uint16_t>(word & ~0x100u)) ;
+}
+
+uint16_t Host::readNext()
+{
+    if (this->pointer != 0)
+	return this->readSample() ;
+    this->execute(&this->againBatch) ;
+    return this->againBatch.word(0) ;
+}
+
+uint16_t Host::convert(uint16_t word)
+{
+    Batch batch(this->addr) ;
+    batch.write(/*config:*/0x1,static_cast<uint16_t>(word | 0x8000u | 0x100u)) ;
+    batch.readAgain() ;
+    // ...one FIFO fill each; OS reads zero while converting
+    this->execute(&batch) ;
+    if (0 == (batch.word(1) & 0x8000u))
+    {
+	auto t0 = std::chrono::steady_clock::now() ;
+	do
+	{
+	    if (std::chrono::steady_clock::now() - t0 > std::chrono::milliseconds(250))
+		throw Error("conversion timeout") ;
+	    // ...the slowest data-rate is 8/s
+	    this->execute(&this->againBatch) ;
+	}
+	while (0 == (this->againBatch.word(0) & 0x8000u)) ;
+    }
+    return this->readSample() ;
+}
@@ -0,0 +1,105 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// ADS1115 access by the I2C controller (Rpi::Bsc) instead of bit-
+// banging. The controller clocks the bits; the CPU only sets up the
+// transfers and polls the status (a few register accesses per
+// transfer). So the process doesn't need a core of its own and a
+// suspension by the OS doesn't break the I2C timing.
+//
+// A register is read by a combined write-read transfer (the pointer
+// write is followed by a repeated START). Several register accesses
+// can be queued (see Batch) and then run back to back.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_Device_Ads1115_Bsc_Host_h
+#define INCLUDE_Device_Ads1115_Bsc_Host_h
+
+#include "../Circuit.h"
+#include <Neat/Error.h>
+#include <Rpi/Bsc.h>
+#include <deque>
+#include <vector>
+
+namespace Device { namespace Ads1115 { namespace Bsc {
+
+struct Host
+{
+    struct Error : Neat::Error
+    {
+	Error(std::string const &s) : Neat::Error("Device:Ads1115:Bsc:" + s) {}
+    } ;
+
+    // register accesses to run in a row
+    struct Batch
+    {
+	// 0:conversion, 1:config, 2:lo-thresh, 3:hi-thresh
+	void write(uint8_t reg,uint16_t word) ;
+	void read(uint8_t reg) ;
+
+	// read the register the pointer was set to before
+	void readAgain() ;
+
+	size_t size() const { return this->accesses.size() ; }
+
+	// the value of a read access (after execution)
+	uint16_t word(size_t i) const ;
+
+	Batch(Circuit::Addr addr) : addr(addr),pointer(-1) {}
+
+	Batch(Batch const&) = delete ;
+	Batch& operator=(Batch const&) = delete ;
+	// ...the transfers refer to the accesses
+
+    private:
+
+	friend Host ;
+
+	Rpi::Bsc::Addr addr ;
+
+	struct Access { uint8_t tx[3] ; uint8_t rx[2] ; } ;
+
+	std::deque<Access> accesses ; // ...references remain valid
+
+	std::vector<Rpi::Bsc::Transfer> transfers ;
+
+	int pointer ; // the last register the pointer is set to (-1: none)
+    } ;
+
+    Host(Rpi::Peripheral *rpi,Rpi::Bsc::Index index,Circuit::Addr addr) ;
+
+    // throws if any of the accesses fails
+    void execute(Batch *batch) ;
+
+    void reset() ; // general call (all devices on the bus)
+
+    uint16_t readConfig() ;
+    uint16_t readSample() ;
+    void writeConfig(uint16_t word) ;
+    void writeRegister(uint8_t reg,uint16_t word) ;
+
+    // write config with the MODE bit (8) cleared
+    void startContinuous(uint16_t word) ;
+
+    // read the conversion register; the pointer register is only
+    // written if it doesn't point there already
+    uint16_t readNext() ;
+
+    // single-shot conversion: write config (with OS set), poll the OS
+    // bit (for 250ms at most), read the conversion register
+    uint16_t convert(uint16_t word) ;
+
+    Rpi::Bsc& bsc() { return this->controller ; }
+
+private:
+
+    Rpi::Bsc controller ; Circuit::Addr addr ;
+
+    int pointer ; // the device's register pointer (-1: unknown)
+
+    Batch configBatch,sampleBatch,againBatch ; // cached
+} ;
+
+} } }
+
+#endif // INCLUDE_Device_Ads1115_Bsc_Host_h
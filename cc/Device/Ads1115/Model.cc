@@ -0,0 +1,245 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Model.h"
+
+using Model = Device::Ads1115::Model ;
+
+Model::Model(Rpi::Pin sclPin,Rpi::Pin sdaPin,Circuit::Addr addr,Circuit::Timing<uint32_t> const &timing,double frequency)
+    : scl(1u<<sclPin.value()),sda(1u<<sdaPin.value())
+    , addr(addr),timing(timing),frequency(frequency)
+    , pointer(0),phase(Phase::Idle),next(Phase::Idle)
+    , nbit(0),byte(0),nbyte(0),data(0),ack(false)
+    , drive(false),ready(0),converting(false)
+    , fresh(true),prev(0)
+    , t_start(0),t_stop(0),t_rise(0),t_fall(0),t_sda(0),started(false)
+    , nclk(0),nstart(0),nstop(0),nconv(0)
+{
+    for (auto &value : this->inputA)
+	value = 0 ;
+    this->reset() ;
+}
+
+uint32_t Model::update(uint64_t t,uint32_t levels)
+{
+    this->complete(t) ;
+
+    auto cur = levels & (this->scl | this->sda) ;
+    if (this->fresh)
+    {
+	// the initial levels
+	this->fresh = false ;
+	this->prev = cur ;
+    }
+    auto changed = cur ^ this->prev ;
+
+    if (changed & this->sda)
+    {
+	if (cur & this->scl)
+	{
+	    if (0 == (cur & this->sda))
+	    {
+		// START (or repeated START)
+		auto t0 = (this->phase == Phase::Idle) ? this->t_stop : this->t_rise ;
+		if (t - t0 < this->timing.buf)
+		    this->violate(t,"ADS1115:buf") ;
+		++this->nstart ;
+		this->phase = Phase::Address ;
+		this->nbit = 0 ;
+		this->byte = 0 ;
+		this->drive = false ;
+		this->t_start = t ;
+		this->started = true ;
+	    }
+	    else
+	    {
+		// STOP
+		if (t - this->t_rise < this->timing.susto)
+		    this->violate(t,"ADS1115:susto") ;
+		++this->nstop ;
+		this->phase = Phase::Idle ;
+		this->drive = false ;
+		this->t_stop = t ;
+	    }
+	}
+	else if (t - this->t_fall < this->timing.hddat)
+	    this->violate(t,"ADS1115:hddat") ;
+	this->t_sda = t ;
+    }
+
+    if (changed & this->scl)
+    {
+	if (cur & this->scl) this->rise(t,0 != (cur & this->sda)) ;
+	else                 this->fall(t) ;
+    }
+
+    this->prev = cur ;
+
+    if (this->drive)
+	levels &= ~this->sda ;
+    return levels ;
+}
+
+uint64_t Model::minimum() const
+{
+    auto cycle = uint64_t(this->timing.low) + this->timing.high ;
+    auto start = uint64_t(this->timing.buf) + this->timing.hdsta ;
+    return this->nclk * cycle + this->nstart * start + this->nstop * this->timing.susto ;
+}
+
+void Model::reset()
+{
+    this->regA[0] = 0x0000 ;
+    this->regA[1] = 0x0583 ; // ...the OS bit is kept separately
+    this->regA[2] = 0x8000 ;
+    this->regA[3] = 0x7fff ;
+    this->converting = false ;
+}
+
+void Model::convert(uint64_t t)
+{
+    static double const rate[] = { 8,16,32,64,128,250,475,860 } ;
+    auto dr = (this->regA[1] >> 5) & 0x7u ;
+    this->ready = t + static_cast<uint64_t>(this->frequency / rate[dr] + .5) ;
+    this->converting = true ;
+}
+
+void Model::complete(uint64_t t)
+{
+    if (!this->converting || (t < this->ready))
+	return ;
+    auto mux = (this->regA[1] >> 12) & 0x7u ;
+    this->regA[0] = static_cast<uint16_t>(this->inputA[mux]) ;
+    ++this->nconv ;
+    auto single = 0 != (this->regA[1] & 0x100u) ;
+    if (single) this->converting = false ;
+    else        this->convert(this->ready) ;
+}
+
+void Model::rise(uint64_t t,bool bit)
+{
+    ++this->nclk ;
+    if (!this->started && (t - this->t_fall < this->timing.low))
+	this->violate(t,"ADS1115:low") ;
+    if (!this->drive && (this->t_sda > this->t_fall) && (t - this->t_sda < this->timing.sudat))
+	this->violate(t,"ADS1115:sudat") ;
+    this->t_rise = t ;
+
+    if (this->phase == Phase::Idle)
+	return ;
+    ++this->nbit ;
+    if (this->nbit <= 8)
+    {
+	if (this->phase != Phase::Read)
+	    this->byte = (this->byte << 1) | (bit ? 1u : 0u) ;
+    }
+    else if (this->phase == Phase::Read)
+	this->ack = !bit ; // ...by the host
+}
+
+void Model::fall(uint64_t t)
+{
+    if (t - this->t_rise < this->timing.high)
+	this->violate(t,"ADS1115:high") ;
+    if (this->started)
+    {
+	if (t - this->t_start < this->timing.hdsta)
+	    this->violate(t,"ADS1115:hdsta") ;
+	this->started = false ;
+    }
+    this->t_fall = t ;
+
+    if (this->phase == Phase::Idle)
+	return ;
+    if (this->nbit == 8)
+    {
+	if (this->phase == Phase::Read)
+	    this->drive = false ; // ...for the host's acknowledge
+	else
+	{
+	    this->receive(t) ;
+	    this->drive = this->ack ;
+	}
+    }
+    else if (this->nbit == 9)
+    {
+	this->drive = false ;
+	this->nbit = 0 ;
+	this->byte = 0 ;
+	if (!this->ack)
+	    this->phase = Phase::Idle ; // ...until the next START
+	else if (this->phase == Phase::Address)
+	{
+	    this->phase = this->next ;
+	    this->nbyte = 0 ;
+	    if (this->phase == Phase::Read)
+		this->transmit() ;
+	}
+	else if (this->phase == Phase::Read)
+	{
+	    ++this->nbyte ;
+	    this->transmit() ;
+	}
+    }
+    else if ((this->phase == Phase::Read) && (this->nbit > 0))
+	this->transmit() ;
+}
+
+void Model::receive(uint64_t t)
+{
+    auto byte = this->byte & 0xffu ;
+    this->ack = true ;
+    switch (this->phase)
+    {
+    case Phase::Address:
+	if ((byte >> 1) == this->addr.value())
+	{
+	    if (byte & 1)
+	    {
+		this->next = Phase::Read ;
+		this->data = this->regA[this->pointer] ;
+		if (this->pointer == 1 && !(this->converting && (this->regA[1] & 0x100u)))
+		    this->data |= 0x8000 ; // OS: no conversion in progress
+	    }
+	    else this->next = Phase::Write ;
+	}
+	else if (byte == 0)
+	    this->next = Phase::General ;
+	else
+	    this->ack = false ;
+	break ;
+    case Phase::Write:
+	if (this->nbyte == 0)
+	    this->pointer = byte & 0x3u ;
+	else
+	    this->data = ((this->data << 8) | byte) & 0xffffu ;
+	++this->nbyte ;
+	if (this->nbyte == 3)
+	{
+	    if (this->pointer == 1)
+	    {
+		this->regA[1] = static_cast<uint16_t>(this->data & 0x7fffu) ;
+		auto single = 0 != (this->data & 0x100u) ;
+		if (!single || (this->data & 0x8000u))
+		    this->convert(t) ;
+	    }
+	    else if (this->pointer != 0)
+		this->regA[this->pointer] = static_cast<uint16_t>(this->data) ;
+	}
+	break ;
+    case Phase::General:
+	if (byte == 0x06)
+	    this->reset() ;
+	break ;
+    case Phase::Idle:
+    case Phase::Read:
+	break ;
+    }
+}
+
+void Model::transmit()
+{
+    unsigned byte = 0xff ; // ...released after two bytes
+    if (this->nbyte == 0) byte = (this->data >> 8) & 0xffu ;
+    if (this->nbyte == 1) byte = (this->data     ) & 0xffu ;
+    this->drive = 0 == (byte & (1u << (7 - this->nbit))) ;
+}
@@ -0,0 +1,94 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// A behavioral (pin-level) model of the ADS1115 for the virtual bus
+// (see RpiExt::Sim::Bus): an I2C slave with the four registers
+// (conversion, config, lo-thresh and hi-thresh) and the general-call
+// reset. The timing constraints (Circuit::Timing) of the host are
+// verified.
+//
+// A single-shot conversion (or the first one in continuous mode)
+// completes after a period as given by the config's data-rate. The
+// value is taken from the input of the configured source; the gain
+// isn't applied. The ALERT/RDY pin isn't modeled.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_Device_Ads1115_Model_h
+#define INCLUDE_Device_Ads1115_Model_h
+
+#include "Circuit.h"
+#include <Rpi/Pin.h>
+#include <RpiExt/Sim/Bus.h>
+
+namespace Device { namespace Ads1115 {
+
+struct Model : RpiExt::Sim::Model
+{
+    Model(Rpi::Pin sclPin,Rpi::Pin sdaPin,Circuit::Addr addr,Circuit::Timing<uint32_t> const &timing,double frequency) ;
+
+    // the value to convert for the given source (default: zero)
+    void input(Circuit::Source source,int16_t value)
+    {
+	this->inputA[source.value()] = value ;
+    }
+
+    uint32_t update(uint64_t t,uint32_t levels) override ;
+
+    uint64_t minimum() const override ;
+
+    uint16_t reg(unsigned i) const { return this->regA[i&3] ; }
+
+    size_t conversions() const { return this->nconv ; }
+
+private:
+
+    uint32_t scl,sda ; // pin masks
+
+    Circuit::Addr addr ;
+
+    Circuit::Timing<uint32_t> timing ;
+
+    double frequency ;
+
+    int16_t inputA[8] ;
+
+    uint16_t regA[4] ; // conversion, config, lo-thresh, hi-thresh
+
+    unsigned pointer ; // register pointer
+
+    enum class Phase { Idle,Address,Write,General,Read } ;
+
+    Phase phase ;
+    Phase next ; // after the address byte
+
+    unsigned nbit ;  // number of rising SCL edges in the current byte
+    unsigned byte ;  // received bits
+    unsigned nbyte ; // number of data bytes (after address)
+    unsigned data ;  // data bytes received or to transmit
+    bool ack ;       // the current byte is acknowledged
+
+    bool drive ;     // pull SDA low
+
+    uint64_t ready ; // the time the pending conversion completes
+    bool converting ;
+
+    bool fresh ; uint32_t prev ; // levels of the last update
+
+    uint64_t t_start,t_stop,t_rise,t_fall,t_sda ;
+    bool started ; // no SCL fall since START
+
+    size_t nclk,nstart,nstop,nconv ;
+
+    void reset() ;
+    void convert(uint64_t t) ;
+    void complete(uint64_t t) ;
+    
+    void rise(uint64_t t,bool bit) ;
+    void fall(uint64_t t) ;
+    void receive(uint64_t t) ;
+    void transmit() ;
+} ;
+
+} }
+
+#endif // INCLUDE_Device_Ads1115_Model_h
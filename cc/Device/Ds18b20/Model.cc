@@ -0,0 +1,377 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Model.h"
+#include <Protocol/OneWire/Bang/crc.h>
+
+using Model = Device::Ds18b20::Model ;
+
+Model::Model(Rpi::Pin pin,Address const &address,double frequency)
+    : mask(1u << pin.value())
+    , address(address)
+    , timing(Protocol::OneWire::Bang::Timing::xlat(frequency))
+    , presenceIdle (static_cast<uint32_t>( 30e-6 * frequency + .5))
+    , presencePulse(static_cast<uint32_t>(120e-6 * frequency + .5))
+    , hold         (static_cast<uint32_t>( 30e-6 * frequency + .5))
+    , copy         (static_cast<uint32_t>( 10e-3 * frequency + .5))
+    , conversion   (static_cast<uint64_t>(750e-3 * frequency + .5))
+    , temperature(0x0550) // 85 degree Celsius (power-up)
+    , phase(Phase::Idle),after(Phase::Idle)
+    , txi(0),rx(0),rxn(0),rxwant(0),search(0)
+    , busy(0),busyFrom(0),converting(false)
+    , fresh(true),prev(true)
+    , t_fall(0),t_rise(0),framed(true),sending(false),bit(true)
+    , pulling(false),pullAt(Never),releaseAt(Never)
+    , nreset(0),nslot(0),nbusy(0),waited(0)
+{
+    this->rom[0] = 0x4b ; // TH
+    this->rom[1] = 0x46 ; // TL
+    this->rom[2] = 0x7f ; // config (12-bit resolution)
+
+    this->pad[0] = 0x50 ;
+    this->pad[1] = 0x05 ;
+    this->pad[2] = this->rom[0] ;
+    this->pad[3] = this->rom[1] ;
+    this->pad[4] = this->rom[2] ;
+    this->pad[5] = 0xff ;
+    this->pad[6] = 0x0c ;
+    this->pad[7] = 0x10 ;
+    this->crc() ;
+}
+
+uint32_t Model::update(uint64_t t,uint32_t levels)
+{
+    if (this->pullAt <= t)
+    {
+	this->pulling = true ;
+	this->pullAt = Never ;
+    }
+    if (this->releaseAt <= t)
+    {
+	this->pulling = false ;
+	this->releaseAt = Never ;
+    }
+    this->complete(t) ;
+
+    auto host = 0 != (levels & this->mask) ;
+    if (this->fresh)
+    {
+	this->fresh = false ;
+	this->prev = host ;
+    }
+    if (host != this->prev)
+    {
+	if (!host)
+	{
+	    // a new slot (or a reset pulse)
+	    if (!this->framed)
+	    {
+		if (t - this->t_rise < this->timing.presenceFrame_max)
+		    this->violate(t,"DS18B20:presenceFrame") ;
+		this->framed = true ;
+	    }
+	    else if (this->nreset + this->nslot > 0)
+	    {
+		// ...nothing to verify before the first reset
+		if (t - this->t_rise < this->timing.rec_min)
+		    this->violate(t,"DS18B20:rec") ;
+		if (t - this->t_fall < this->timing.slot_min)
+		    this->violate(t,"DS18B20:slot") ;
+	    }
+	    this->t_fall = t ;
+	    this->slot(t,false) ;
+	}
+	else
+	{
+	    auto d = t - this->t_fall ;
+	    if (d >= this->timing.resetPulse_min)
+		this->reset(t) ;
+	    else if (d > this->timing.slot_max)
+	    {
+		this->violate(t,"DS18B20:resetPulse") ;
+		this->phase = Phase::Idle ;
+	    }
+	    else this->slot(t,true) ;
+	    this->t_rise = t ;
+	}
+	this->prev = host ;
+    }
+
+    if (this->pulling)
+	levels &= ~this->mask ;
+    return levels ;
+}
+
+uint64_t Model::next() const
+{
+    return (this->pullAt < this->releaseAt) ? this->pullAt : this->releaseAt ;
+}
+
+uint64_t Model::minimum() const
+{
+    auto reset = uint64_t(this->timing.resetPulse_min) + this->timing.presenceFrame_max ;
+    auto slots = (this->nslot - this->nbusy) * uint64_t(this->timing.slot_min) ;
+    // ...the slot includes the recovery time; the slots that start
+    //    during a conversion or copy are covered by the waited time
+    return this->nreset * reset + slots + this->waited ;
+}
+
+void Model::reset(uint64_t t)
+{
+    ++this->nreset ;
+    this->phase = Phase::Rom ;
+    this->rx = 0 ; this->rxn = 0 ; this->rxwant = 8 ;
+    this->pullAt = t + this->presenceIdle ;
+    this->releaseAt = this->pullAt + this->presencePulse ;
+    this->framed = false ;
+}
+
+void Model::slot(uint64_t t,bool rise)
+{
+    if (!rise)
+    {
+	// the device responds on the falling edge (if it transmits)
+	this->sending = true ;
+	switch (this->phase)
+	{
+	case Phase::Send:
+	    this->bit = (this->txi < this->tx.size()) ? this->tx[this->txi] : true ;
+	    break ;
+	case Phase::Busy:
+	    this->bit = !this->converting && (t >= this->busy) ;
+	    break ;
+	case Phase::Search:
+	    if (this->search % 3 == 2)
+		this->sending = false ;
+	    else
+	    {
+		auto b = this->address[this->search / 3] ;
+		this->bit = (this->search % 3 == 0) ? b : !b ;
+	    }
+	    break ;
+	default:
+	    this->sending = false ;
+	}
+	if (this->sending && !this->bit)
+	{
+	    this->pulling = true ;
+	    this->releaseAt = t + this->hold ;
+	}
+	return ;
+    }
+
+    ++this->nslot ;
+    if (this->busyFrom <= this->t_fall && this->t_fall < this->busy)
+	++this->nbusy ;
+    auto d = t - this->t_fall ;
+    if (this->sending)
+    {
+	// read slot: the host must release the line early enough
+	if (d > this->timing.rdv_min)
+	    this->violate(t,"DS18B20:rdv") ;
+	if (this->phase == Phase::Send)
+	{
+	    ++this->txi ;
+	    if (this->txi >= this->tx.size())
+		this->phase = this->after ;
+	}
+	else if (this->phase == Phase::Search)
+	    ++this->search ;
+	return ;
+    }
+
+    // write slot
+    bool bit ;
+    if (d <= this->timing.write_1_max)
+	bit = true ;
+    else if (d >= this->timing.write_0_min)
+	bit = false ;
+    else
+    {
+	this->violate(t,"DS18B20:write") ;
+	bit = d < this->hold ; // ...the device samples after ~30us
+    }
+    this->receive(t,bit) ;
+}
+
+void Model::receive(uint64_t t,bool bit)
+{
+    switch (this->phase)
+    {
+    case Phase::Search:
+	if (bit != this->address[this->search / 3])
+	    this->phase = Phase::Idle ;
+	else if (++this->search == 3*64)
+	{
+	    this->phase = Phase::Function ;
+	    this->rx = 0 ; this->rxn = 0 ; this->rxwant = 8 ;
+	}
+	return ;
+    case Phase::Rom:
+    case Phase::Match:
+    case Phase::Function:
+    case Phase::Write:
+	if (bit)
+	    this->rx |= uint64_t(1) << this->rxn ;
+	if (++this->rxn == this->rxwant)
+	    this->command(t) ;
+	return ;
+    case Phase::Idle:
+    case Phase::Send:
+    case Phase::Busy:
+	return ;
+    }
+}
+
+void Model::command(uint64_t t)
+{
+    auto rx = this->rx ;
+    this->rx = 0 ; this->rxn = 0 ; this->rxwant = 8 ;
+    switch (this->phase)
+    {
+    case Phase::Rom:
+	switch (rx)
+	{
+	case 0x33: // Read ROM
+	    this->send(this->address.to_ullong(),64) ;
+	    this->after = Phase::Function ;
+	    break ;
+	case 0x55: // Match ROM
+	    this->phase = Phase::Match ;
+	    this->rxwant = 64 ;
+	    break ;
+	case 0xcc: // Skip ROM
+	    this->phase = Phase::Function ;
+	    break ;
+	case 0xec: // Alarm Search
+	{
+	    auto temp = static_cast<int16_t>(this->pad[0] | (this->pad[1] << 8)) >> 4 ;
+	    auto th = static_cast<int8_t>(this->pad[2]) ;
+	    auto tl = static_cast<int8_t>(this->pad[3]) ;
+	    if (temp < th && temp > tl)
+	    {
+		this->phase = Phase::Idle ;
+		break ;
+	    }
+	}
+	// fall through
+	case 0xf0: // Search ROM
+	    this->phase = Phase::Search ;
+	    this->search = 0 ;
+	    break ;
+	default:
+	    this->phase = Phase::Idle ;
+	}
+	break ;
+
+    case Phase::Match:
+	this->phase = (rx == this->address.to_ullong())
+	    ? Phase::Function
+	    : Phase::Idle ;
+	break ;
+
+    case Phase::Function:
+	switch (rx)
+	{
+	case 0x44: // Convert T
+	{
+	    this->wait(t,this->conversionTime()) ;
+	    this->converting = true ;
+	    this->phase = Phase::Busy ;
+	    break ;
+	}
+	case 0x48: // Copy Scratch-Pad
+	    for (unsigned i=0 ; i<3 ; ++i)
+		this->rom[i] = this->pad[2+i] ;
+	    this->wait(t,this->copy) ;
+	    this->phase = Phase::Busy ;
+	    break ;
+	case 0x4e: // Write Scratch-Pad
+	    this->phase = Phase::Write ;
+	    this->rxwant = 24 ;
+	    break ;
+	case 0xb4: // Read Power Supply
+	    this->send(1,1) ; // ...external supply
+	    this->after = Phase::Idle ;
+	    break ;
+	case 0xb8: // Recall E2
+	    for (unsigned i=0 ; i<3 ; ++i)
+		this->pad[2+i] = this->rom[i] ;
+	    this->crc() ;
+	    this->busy = t ;
+	    this->phase = Phase::Busy ;
+	    break ;
+	case 0xbe: // Read Scratch-Pad
+	    this->tx.clear() ;
+	    for (unsigned i=0 ; i<9 ; ++i)
+		for (unsigned j=0 ; j<8 ; ++j)
+		    this->tx.push_back(0 != (this->pad[i] & (1u<<j))) ;
+	    this->txi = 0 ;
+	    this->phase = Phase::Send ;
+	    this->after = Phase::Idle ;
+	    break ;
+	default:
+	    this->phase = Phase::Idle ;
+	}
+	break ;
+
+    case Phase::Write:
+	this->pad[2] = static_cast<uint8_t>(rx) ;
+	this->pad[3] = static_cast<uint8_t>(rx >> 8) ;
+	this->pad[4] = static_cast<uint8_t>(((rx >> 16) & 0x60u) | 0x1fu) ;
+	this->crc() ;
+	this->phase = Phase::Idle ;
+	break ;
+
+    default:
+	break ;
+    }
+}
+
+void Model::send(uint64_t value,unsigned n)
+{
+    this->tx.clear() ;
+    for (unsigned i=0 ; i<n ; ++i)
+	this->tx.push_back(0 != (value & (uint64_t(1) << i))) ;
+    this->txi = 0 ;
+    this->phase = Phase::Send ;
+}
+
+uint64_t Model::conversionTime() const
+{
+    auto r = (this->pad[4] >> 5) & 0x3u ; // 9..12-bit resolution
+    return this->conversion >> (3-r) ;
+}
+
+void Model::wait(uint64_t t,uint64_t span)
+{
+    this->busy = t + span ;
+    this->busyFrom = t ;
+    auto slot = uint64_t(this->timing.slot_min) ;
+    auto elapsed = t - this->t_fall ;
+    this->waited += span - (elapsed < slot ? slot - elapsed : 0) ;
+    // ...the rest of the slot that started the wait is counted as
+    //    slot already
+}
+
+void Model::complete(uint64_t t)
+{
+    if (!this->converting || (t < this->busy))
+	return ;
+    this->converting = false ;
+    auto r = (this->pad[4] >> 5) & 0x3u ;
+    auto value = static_cast<uint16_t>(this->temperature) ;
+    value = static_cast<uint16_t>(value & ~((1u << (3-r)) - 1)) ;
+    // ...undefined bits are cleared
+    this->pad[0] = static_cast<uint8_t>(value) ;
+    this->pad[1] = static_cast<uint8_t>(value >> 8) ;
+    this->crc() ;
+}
+
+void Model::crc()
+{
+    std::bitset<64> set ;
+    for (unsigned i=0 ; i<8 ; ++i)
+	for (unsigned j=0 ; j<8 ; ++j)
+	    set[8*i+j] = 0 != (this->pad[i] & (1u<<j)) ;
+    this->pad[8] = Protocol::OneWire::Bang::crc(set) ;
+}
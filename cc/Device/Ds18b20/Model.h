@@ -0,0 +1,113 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// A behavioral (pin-level) model of the DS18B20 for the virtual bus
+// (see RpiExt::Sim::Bus). It answers the reset with a presence pulse
+// and executes the ROM commands (read, match, skip, search and alarm
+// search) and the function commands (convert, read/write scratch-pad,
+// copy, recall and read power-supply).
+//
+// The host's timing is verified with Protocol::OneWire::Bang::Timing
+// (i.e. with the specified values). The device itself responds with
+// typical values: a presence pulse after 30us for 120us, a 0-bit is
+// held for 30us.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_Device_Ds18b20_Model_h
+#define INCLUDE_Device_Ds18b20_Model_h
+
+#include <Protocol/OneWire/Bang/Address.h>
+#include <Protocol/OneWire/Bang/Timing.h>
+#include <Rpi/Pin.h>
+#include <RpiExt/Sim/Bus.h>
+#include <vector>
+
+namespace Device { namespace Ds18b20 {
+
+struct Model : RpiExt::Sim::Model
+{
+    using Address = Protocol::OneWire::Bang::Address ;
+
+    Model(Rpi::Pin pin,Address const &address,double frequency) ;
+
+    // the temperature to convert (in 1/16 degree Celsius)
+    void input(int16_t temperature) { this->temperature = temperature ; }
+
+    uint32_t update(uint64_t t,uint32_t levels) override ;
+
+    uint64_t next() const override ;
+
+    uint64_t minimum() const override ;
+
+    size_t resets() const { return this->nreset ; }
+
+private:
+
+    uint32_t mask ;
+
+    Address address ;
+
+    Protocol::OneWire::Bang::Timing::Template<uint32_t> timing ;
+
+    uint32_t presenceIdle,presencePulse,hold,copy ; // (ticks)
+    uint64_t conversion ; // (ticks) at 12-bit resolution
+
+    int16_t temperature ;
+
+    uint8_t pad[9] ; // scratch-pad
+    uint8_t rom[3] ; // EEPROM (TH,TL,config)
+
+    enum class Phase
+    {
+	Idle,     // wait for reset
+	Rom,      // receive ROM command
+	Match,    // receive address
+	Search,   // (alarm) search
+	Function, // receive function command
+	Write,    // receive scratch-pad data
+	Send,     // transmit data
+	Busy,     // conversion or copy in progress
+    } ;
+
+    Phase phase ;
+    Phase after ; // when the transmission is done
+
+    std::vector<bool> tx ; size_t txi ; // bits to transmit
+    uint64_t rx ; unsigned rxn,rxwant ; // bits received
+    unsigned search ; // bit index (0..63) + step (0..2)
+
+    uint64_t busy ; // end of conversion or copy
+    uint64_t busyFrom ; // ...and its start
+
+    bool converting ;
+
+    bool fresh ; bool prev ; // the host's level of the last update
+
+    uint64_t t_fall,t_rise ;
+    bool framed ; // a presence-frame since the last reset
+    bool sending ; bool bit ; // the current slot transmits the bit
+
+    bool pulling ;        // the device pulls the line low
+    uint64_t pullAt ;     // presence pulse starts
+    uint64_t releaseAt ;  // pulling ends
+
+    size_t nreset,nslot ;
+    size_t nbusy ; // slots that start during a conversion or copy
+    uint64_t waited ; // (ticks) the conversions and copies took
+
+    // as configured by the scratch-pad (resolution)
+    uint64_t conversionTime() const ;
+    void wait(uint64_t t,uint64_t span) ;
+
+    void reset(uint64_t t) ;
+    void slot(uint64_t t,bool rise) ;
+    void receive(uint64_t t,bool bit) ;
+    void command(uint64_t t) ;
+    void send(uint64_t value,unsigned n) ;
+    void complete(uint64_t t) ;
+    void crc() ;
+} ;
+
+} }
+
+#endif // INCLUDE_Device_Ds18b20_Model_h
@@ -2,6 +2,7 @@
 
 #include "Bang.h"
 #include <cmath>
+#include <RpiExt/BangStatic.h>
 
 Device::Max7219::Bang::Ticks
 Device::Max7219::Bang::asTicks(Seconds const &s,double freq)
@@ -36,3 +37,57 @@ void Device::Max7219::Bang::load(RpiExt::Bang::Enqueue *q)
     q->reset(this->pins.load) ; 
     q->sleep(this->ticks.ldck) ; // [todo] before CLK
 }
+
+namespace
+{
+    using namespace RpiExt::BangStatic ;
+
+    enum : unsigned { Din,Load,Clk } ; // pins
+
+    enum : unsigned { Ch,Cl,Csw,Ds,Ldck } ; // ticks
+
+    // the same sequence as send() (MSB first)
+    template<unsigned I> using Bit = Seq<
+	Put<Din,15-I>,Sleep<Ds>,Sleep<Cl>,Set<Clk>,Sleep<Ch>,Reset<Clk>> ;
+    
+    using Send = For<Bit,0,16> ;
+
+    // the same sequence as load()
+    using Load_ = Seq<Set<Load>,Sleep<Csw>,Reset<Load>,Sleep<Ldck>> ;
+}
+
+void Device::Max7219::Bang::write(uint16_t const *data,size_t n)
+{
+    uint32_t const pins[] = {
+	this->pins.din,this->pins.load,this->pins.clk
+    } ;
+    uint32_t const ticks[] = {
+	this->ticks.ch,this->ticks.cl,this->ticks.csw,this->ticks.ds,this->ticks.ldck
+    } ;
+    Context c(this->rpi,pins,ticks,nullptr) ;
+    for (size_t i=0 ; i<n ; ++i)
+    {
+	c.data = data[i] ;
+	Send::run(c) ;
+    }
+    Load_::run(c) ;
+}
+
+void Device::Max7219::Bang::write(uint16_t const *data,size_t n,size_t m)
+{
+    uint32_t const pins[] = {
+	this->pins.din,this->pins.load,this->pins.clk
+    } ;
+    uint32_t const ticks[] = {
+	this->ticks.ch,this->ticks.cl,this->ticks.csw,this->ticks.ds,this->ticks.ldck
+    } ;
+    assert(m > 0) ;
+    Context c(this->rpi,pins,ticks,nullptr) ;
+    for (size_t i=0 ; i<n ; ++i)
+    {
+	c.data = data[i] ;
+	Send::run(c) ;
+	if ((i+1) % m == 0)
+	    Load_::run(c) ;
+    }
+}
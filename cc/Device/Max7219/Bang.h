@@ -44,6 +44,13 @@ struct Bang
     void send(RpiExt::Bang::Enqueue *q,uint16_t data) ;
     
     void load(RpiExt::Bang::Enqueue *q) ;
+
+    void write(uint16_t const *data,size_t n) ;
+    // ...as send() for each word and load(); but executed at once by a
+    //    compile-time script (RpiExt::BangStatic)
+
+    void write(uint16_t const *data,size_t n,size_t m) ;
+    // ...as write() for each m words (i.e. n/m latches) in one go
     
     Bang(
 	Rpi::Peripheral *rpi,
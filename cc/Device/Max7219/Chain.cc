@@ -0,0 +1,104 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Chain.h"
+#include <stdexcept>
+
+using Chain = Device::Max7219::Chain ;
+
+Chain::Chain(size_t ndevices)
+    : ndevices(ndevices)
+    , rows(8*ndevices,0),shown(8*ndevices,0),valid(8*ndevices,false)
+    , pos(ndevices)
+{
+}
+
+void Chain::set(size_t device,unsigned row,uint8_t value)
+{
+    if (device >= this->ndevices || row >= 8)
+	throw std::out_of_range("Max7219:Chain:set") ;
+    this->rows[8*device+row] = value ;
+}
+
+uint8_t Chain::get(size_t device,unsigned row) const
+{
+    if (device >= this->ndevices || row >= 8)
+	throw std::out_of_range("Max7219:Chain:get") ;
+    return this->rows[8*device+row] ;
+}
+
+bool Chain::apply(size_t device,uint16_t word)
+{
+    auto addr = static_cast<unsigned>((word >> 8) & 0xf) ;
+    if (addr == 0)
+	return true ; // No-Op
+    if (addr > 8)
+	return false ;
+    this->set(device,addr-1,static_cast<uint8_t>(word)) ;
+    return true ;
+}
+
+void Chain::latched(size_t device,uint16_t word)
+{
+    auto addr = static_cast<unsigned>((word >> 8) & 0xf) ;
+    if (addr == 0 || addr > 8)
+	return ; // ...No-Op or a control register
+    this->set(device,addr-1,static_cast<uint8_t>(word)) ;
+    auto i = 8 * device + addr - 1 ;
+    this->shown[i] = this->rows[i] ;
+    this->valid[i] = true ;
+}
+
+size_t Chain::update(std::vector<uint16_t> *words)
+{
+    // the next changed row (or 8 if none) per device
+    auto next = [this](size_t device,unsigned row) {
+	auto i = 8 * device ;
+	while (row < 8 && this->valid[i+row] && this->rows[i+row] == this->shown[i+row])
+	    ++row ;
+	return row ;
+    } ;
+    auto &pos = this->pos ;
+    bool pending = false ;
+    for (size_t d=0 ; d<this->ndevices ; ++d)
+    {
+	pos[d] = next(d,0) ;
+	pending |= (pos[d] < 8) ;
+    }
+    size_t nlatches = 0 ;
+    while (pending)
+    {
+	pending = false ;
+	for (size_t j=0 ; j<this->ndevices ; ++j)
+	{
+	    // the device farthest from the host first
+	    auto d = this->ndevices - 1 - j ;
+	    auto row = pos[d] ;
+	    if (row == 8)
+	    {
+		words->push_back(0x0000) ; // No-Op
+		continue ;
+	    }
+	    auto i = 8 * d + row ;
+	    words->push_back(static_cast<uint16_t>(((row+1) << 8) | this->rows[i])) ;
+	    this->shown[i] = this->rows[i] ;
+	    this->valid[i] = true ;
+	    pos[d] = next(d,row+1) ;
+	    pending |= (pos[d] < 8) ;
+	}
+	++nlatches ;
+    }
+    return nlatches ;
+}
+
+void Chain::invalidate()
+{
+    this->valid.assign(this->valid.size(),false) ;
+}
+
+void Chain::invalidate(size_t device)
+{
+    if (device >= this->ndevices)
+	throw std::out_of_range("Max7219:Chain:invalidate") ;
+    for (unsigned row=0 ; row<8 ; ++row)
+	this->valid[8*device+row] = false ;
+}
@@ -0,0 +1,73 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// The display state of a chain of (cascaded) MAX7219. The rows (i.e.
+// the digit registers 1..8) of each device are set, and update()
+// returns the words for the changed rows only.
+//
+// A latch writes one word into each device of the chain; a device
+// that has nothing to change gets a No-Op. So the number of latches
+// is the largest number of changed rows of any device (rather than
+// 8 for a full refresh).
+//
+// Device #0 is the one next to the host (as in Model); i.e. its word
+// is shifted last.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_Device_Max7219_Chain_h
+#define INCLUDE_Device_Max7219_Chain_h
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Device { namespace Max7219 {
+
+struct Chain
+{
+    Chain(size_t ndevices) ;
+    // ...the displayed rows are unknown: the first update() sends
+    // all rows
+
+    size_t size() const { return this->ndevices ; }
+
+    // the row (0..7) of a device to be displayed
+    void set(size_t device,unsigned row,uint8_t value) ;
+
+    uint8_t get(size_t device,unsigned row) const ;
+
+    // apply a word as if shifted into the device (the digit
+    // registers only); returns false for any other register
+    bool apply(size_t device,uint16_t word) ;
+
+    // a word that got latched into the device by other means (i.e.
+    // not by update()): a digit register is displayed now
+    void latched(size_t device,uint16_t word) ;
+
+    // append the words (size() per latch) to bring the display up to
+    // date and return the number of latches; thereafter, the words
+    // are assumed to be sent
+    size_t update(std::vector<uint16_t> *words) ;
+
+    // the next update() sends all rows
+    void invalidate() ;
+
+    // ...of the given device
+    void invalidate(size_t device) ;
+
+private:
+
+    size_t ndevices ;
+
+    std::vector<uint8_t> rows ; // [device*8+row]: to be displayed
+
+    std::vector<uint8_t> shown ; // [device*8+row]: displayed
+
+    std::vector<bool> valid ; // [device*8+row]: shown is known
+
+    std::vector<unsigned> pos ; // per device: the next row to send
+} ;
+
+} }
+
+#endif // INCLUDE_Device_Max7219_Chain_h
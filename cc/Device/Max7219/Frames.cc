@@ -0,0 +1,142 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Frames.h"
+#include "Parser.h"
+#include <cmath>
+#include <cstring> // memcmp
+#include <sstream>
+#include <vector>
+
+using Frames = Device::Max7219::Frames ;
+
+static char const Magic[8] = { 'M','A','X','7','2','1','9','\1' } ;
+
+static void put(std::ostream *os,void const *p,size_t n)
+{
+    os->write(static_cast<char const*>(p),static_cast<std::streamsize>(n)) ;
+    static char const zeros[4] = { 0 } ;
+    os->write(zeros,static_cast<std::streamsize>((4 - n % 4) % 4)) ;
+    if (!os->good())
+	throw Frames::Error("write error") ;
+}
+
+static void put(std::ostream *os,Frames::Record::Kind kind,size_t n)
+{
+    if (n > 0xffff)
+	throw Frames::Error("record too large") ;
+    uint16_t head[2] = { static_cast<uint16_t>(kind),static_cast<uint16_t>(n) } ;
+    put(os,head,sizeof(head)) ;
+}
+
+size_t Frames::compile(std::istream *is,std::ostream *os)
+{
+    // the header holds the number of records; hence, the records
+    // are collected first
+    std::ostringstream out ;
+    size_t nrecords = 0 ;
+    std::vector<uint16_t> words ;
+    Parser parser(is) ;
+    while (true)
+    {
+	auto c = parser.parse() ;
+	if (dynamic_cast<Parser::Eof*>(c.get()) != nullptr)
+	    break ;
+	if (auto shift = dynamic_cast<Parser::Shift*>(c.get()))
+	{
+	    words.push_back(shift->data) ;
+	    continue ;
+	}
+	if (dynamic_cast<Parser::Latch*>(c.get()) != nullptr)
+	{
+	    put(&out,Record::Kind::Frame,words.size()) ;
+	    if (!words.empty())
+		put(&out,&words[0],2 * words.size()) ;
+	    words.clear() ;
+	}
+	else if (auto delay = dynamic_cast<Parser::Delay*>(c.get()))
+	{
+	    auto us = std::floor(delay->seconds * 1e6 + .5) ;
+	    if (us > 0xffffffffu)
+		throw Error("delay too long") ;
+	    uint32_t u32 = static_cast<uint32_t>(us) ;
+	    put(&out,Record::Kind::Delay,0) ;
+	    put(&out,&u32,sizeof(u32)) ;
+	}
+	else if (auto echo = dynamic_cast<Parser::Echo*>(c.get()))
+	{
+	    put(&out,Record::Kind::Echo,echo->text.size()) ;
+	    put(&out,echo->text.data(),echo->text.size()) ;
+	}
+	++nrecords ;
+    }
+    // ...unlatched shifts are dropped
+    if (nrecords > 0xffffffffu)
+	throw Error("too many records") ;
+    uint32_t n = static_cast<uint32_t>(nrecords) ;
+    os->write(Magic,sizeof(Magic)) ;
+    os->write(reinterpret_cast<char const*>(&n),sizeof(n)) ;
+    auto s = out.str() ;
+    os->write(s.data(),static_cast<std::streamsize>(s.size())) ;
+    if (!os->good())
+	throw Error("write error") ;
+    return nrecords ;
+}
+
+Frames::Frames(void const *p,size_t nbytes)
+{
+    auto q = static_cast<uint8_t const*>(p) ;
+    if (0 != (reinterpret_cast<uintptr_t>(q) & 0x3))
+	throw Error("not aligned") ;
+    if (nbytes < 12 || 0 != memcmp(q,Magic,sizeof(Magic)))
+	throw Error("not a frame file") ;
+    uint32_t n ; memcpy(&n,q+8,sizeof(n)) ;
+    this->first = q + 12 ;
+    this->end = q + nbytes ;
+    this->nrecords = n ;
+    // verify the records (so next() doesn't need to)
+    auto c = this->begin() ;
+    Record r ; size_t i = 0 ;
+    while (c.p < c.end)
+    {
+	if (c.end - c.p < 4)
+	    throw Error("truncated record") ;
+	uint16_t head[2] ; memcpy(head,c.p,sizeof(head)) ;
+	size_t size ;
+	switch (head[0])
+	{
+	case 1: size = 2 * head[1] ; break ;
+	case 2: size = 4 ; break ;
+	case 3: size = head[1] ; break ;
+	default: throw Error("unknown record") ;
+	}
+	size = (size + 3) & ~size_t(3) ;
+	if (static_cast<size_t>(c.end - c.p - 4) < size)
+	    throw Error("truncated record") ;
+	c.next(&r) ;
+	++i ;
+    }
+    if (i != this->nrecords)
+	throw Error("number of records doesn't match") ;
+}
+
+bool Frames::Cursor::next(Record *record)
+{
+    if (this->p >= this->end)
+	return false ;
+    auto head = reinterpret_cast<uint16_t const*>(this->p) ;
+    record->kind = static_cast<Record::Kind>(head[0]) ;
+    record->n = head[1] ;
+    record->data = head + 2 ;
+    size_t size = 0 ;
+    switch (record->kind)
+    {
+    case Record::Kind::Frame: size = 2 * record->n ; break ;
+    case Record::Kind::Delay:
+	size = 4 ;
+	record->us = *reinterpret_cast<uint32_t const*>(head + 2) ;
+	break ;
+    case Record::Kind::Echo: size = record->n ; break ;
+    }
+    this->p += 4 + ((size + 3) & ~size_t(3)) ;
+    return true ;
+}
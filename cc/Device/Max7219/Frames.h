@@ -0,0 +1,77 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// A compact binary format for the command files (see Parser) and a
+// read-only view of it (e.g. of a memory-mapped file).
+//
+// The shifted words are collected up to the next latch; that makes a
+// frame. Delays and echos are kept as they are. Shifts that aren't
+// latched at the end of the file are dropped (as they would never
+// get sent anyway).
+//
+// The layout (all numbers in host byte order; records 4-byte aligned):
+//
+//   header : "MAX7219\1" uint32(number of records)
+//   record : uint16(kind) uint16(n) payload
+//   frame  : kind=1 n=number of words; payload n x uint16
+//   delay  : kind=2 n=0;                payload uint32(microseconds)
+//   echo   : kind=3 n=length of text;   payload n x char
+//
+// Each payload is padded to a multiple of 4 bytes.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_Device_Max7219_Frames_h
+#define INCLUDE_Device_Max7219_Frames_h
+
+#include <Neat/Error.h>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+namespace Device { namespace Max7219 {
+
+struct Frames
+{
+    struct Error : Neat::Error
+    {
+	Error(std::string const &s) : Neat::Error("Device::Max7219::Frames:"+s) {}
+    } ;
+
+    // translate the text format to the binary format; returns the
+    // number of records
+    static size_t compile(std::istream *is,std::ostream *os) ;
+
+    // the memory must stay valid (and unchanged) during the use; the
+    // format is verified
+    Frames(void const *p,size_t nbytes) ;
+
+    struct Record
+    {
+	enum class Kind : uint16_t { Frame=1,Delay=2,Echo=3 } ;
+	Kind kind ;
+	uint16_t const *data ; size_t n ; // frame: words (n), echo: chars
+	uint32_t us ; // delay
+    } ;
+
+    size_t size() const { return this->nrecords ; }
+
+    // iterate over all records (no allocations)
+    struct Cursor
+    {
+	bool next(Record *record) ;
+    private:
+	friend Frames ;
+	uint8_t const *p,*end ;
+	Cursor(uint8_t const *p,uint8_t const *end) : p(p),end(end) {}
+    } ;
+    
+    Cursor begin() const { return Cursor(this->first,this->end) ; }
+
+private:
+
+    uint8_t const *first,*end ; size_t nrecords ;
+} ;
+
+} }
+
+#endif // INCLUDE_Device_Max7219_Frames_h
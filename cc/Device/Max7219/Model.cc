@@ -0,0 +1,87 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Model.h"
+
+using Model = Device::Max7219::Model ;
+
+Model::Model(Rpi::Pin dinPin,Rpi::Pin loadPin,Rpi::Pin clkPin,Bang::Ticks const &ticks,size_t n)
+    : din(1u<<dinPin.value()),load(1u<<loadPin.value()),clk(1u<<clkPin.value())
+    , ticks(ticks)
+    , shift(n,0),regA(n,std::vector<uint8_t>(16,0))
+    , fresh(true),prev(0),t_clk(0),t_din(0),t_load(0),loaded(false)
+    , nclk(0),nload(0),nwrite(0)
+{ }
+
+uint32_t Model::update(uint64_t t,uint32_t levels)
+{
+    auto cur = levels & (this->din | this->load | this->clk) ;
+    if (this->fresh)
+    {
+	// the initial levels
+	this->fresh = false ;
+	this->prev = cur ;
+    }
+    auto changed = cur ^ this->prev ;
+
+    if (changed & this->din)
+	this->t_din = t ;
+
+    if (changed & this->load)
+    {
+	if (cur & this->load)
+	{
+	    // latch
+	    ++this->nload ;
+	    for (size_t i=0 ; i<this->shift.size() ; ++i)
+	    {
+		auto addr = (this->shift[i] >> 8) & 0xfu ;
+		if (addr != 0) // ...No-Op
+		{
+		    this->regA[i][addr] = static_cast<uint8_t>(this->shift[i]) ;
+		    ++this->nwrite ;
+		}
+	    }
+	    this->loaded = true ;
+	}
+	else if ((this->nload > 0) && (t - this->t_load < this->ticks.csw))
+	    this->violate(t,"MAX7219:csw") ;
+	// ...a pulse that began before the first update isn't verified
+	this->t_load = t ;
+    }
+
+    if (changed & this->clk)
+    {
+	if (cur & this->clk)
+	{
+	    ++this->nclk ;
+	    if (t - this->t_clk < this->ticks.cl)
+		this->violate(t,"MAX7219:cl") ;
+	    if (t - this->t_din < this->ticks.ds)
+		this->violate(t,"MAX7219:ds") ;
+	    if (this->loaded && (t - this->t_load < this->ticks.ldck))
+		this->violate(t,"MAX7219:ldck") ;
+	    // shift: the MSB of each device goes to the next one
+	    auto bit = 0 != (cur & this->din) ? 1u : 0u ;
+	    for (auto &word : this->shift)
+	    {
+		auto msb = static_cast<unsigned>(word >> 15) ;
+		word = static_cast<uint16_t>((word << 1) | bit) ;
+		bit = msb ;
+	    }
+	}
+	else if ((this->nclk > 0) && (t - this->t_clk < this->ticks.ch))
+	    this->violate(t,"MAX7219:ch") ;
+	this->t_clk = t ;
+	this->loaded = false ;
+    }
+
+    this->prev = cur ;
+    return levels ;
+}
+
+uint64_t Model::minimum() const
+{
+    auto cycle = uint64_t(this->ticks.ch) + this->ticks.cl ;
+    auto frame = uint64_t(this->ticks.csw) + this->ticks.ldck ;
+    return this->nclk * cycle + this->nload * frame ;
+}
@@ -0,0 +1,59 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// A behavioral (pin-level) model of a chain of MAX7219 for the virtual
+// bus (see RpiExt::Sim::Bus). The data is shifted through the chain
+// (i.e. through one 16-bit register per device) with each rising CLK
+// edge. With the rising LOAD edge, each device latches its word into
+// the addressed register (unless No-Op). The timing constraints (i.e.
+// Bang::Timing) are verified.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_Device_Max7219_Model_h
+#define INCLUDE_Device_Max7219_Model_h
+
+#include "Bang.h"
+#include <RpiExt/Sim/Bus.h>
+#include <vector>
+
+namespace Device { namespace Max7219 {
+
+struct Model : RpiExt::Sim::Model
+{
+    Model(Rpi::Pin dinPin,Rpi::Pin loadPin,Rpi::Pin clkPin,Bang::Ticks const &ticks,size_t n=1) ;
+
+    uint32_t update(uint64_t t,uint32_t levels) override ;
+
+    uint64_t minimum() const override ;
+
+    // the register (0..15) of the i-th device (0: next to the host)
+    uint8_t reg(size_t i,unsigned addr) const { return this->regA.at(i).at(addr) ; }
+
+    // the number of register writes (No-Ops excluded)
+    size_t writes() const { return this->nwrite ; }
+
+    size_t size() const { return this->shift.size() ; }
+    
+private:
+
+    uint32_t din,load,clk ; // pin masks
+
+    Bang::Ticks ticks ;
+
+    std::vector<uint16_t> shift ; // shift register per device
+    
+    std::vector<std::vector<uint8_t>> regA ; // 16 registers per device
+
+    bool fresh ; // no update yet
+    
+    uint32_t prev ; // levels of the last update
+
+    uint64_t t_clk,t_din,t_load ; // last edges
+    bool loaded ; // LOAD rose since the last CLK edge
+
+    size_t nclk,nload,nwrite ;
+} ;
+
+} }
+
+#endif // INCLUDE_Device_Max7219_Model_h
@@ -2,8 +2,12 @@
 
 #include "Bang.h"
 #include <chrono>
+#include <cstddef> // offsetof
 #include <iostream>
+#include <type_traits>
+#include <Neat/Bit/Transpose.h>
 #include <Neat/cast.h>
+#include <RpiExt/BangStatic.h>
 
 Device::Mcp3008::Bang::Bang(
     Rpi::Peripheral *rpi,
@@ -12,20 +16,36 @@ Device::Mcp3008::Bang::Bang(
     Rpi::Pin      dinPin,
     Rpi::Pin     doutPin,
     Timing const &timing)
-    : rpi(rpi),pins(Pins(csPin,clkPin,dinPin,doutPin)),timing(timing)
+    : Bang(rpi,csPin,clkPin,dinPin,std::vector<Rpi::Pin>(1,doutPin),timing)
+{ }
+
+Device::Mcp3008::Bang::Bang(
+    Rpi::Peripheral *rpi,
+    Rpi::Pin       csPin,
+    Rpi::Pin      clkPin,
+    Rpi::Pin      dinPin,
+    std::vector<Rpi::Pin> const &doutPins,
+    Timing const &timing)
+    : rpi(rpi),pins(Pins(csPin,clkPin,dinPin,doutPins.at(0))),douts(doutPins),timing(timing)
 {
     auto gpio = rpi->page<Rpi::Register::Gpio::PageNo>() ;
     namespace Function = Rpi::Gpio::Function ;
-    Function::set(gpio,  csPin,Function::Type::Out) ;
-    Function::set(gpio, clkPin,Function::Type::Out) ;
-    Function::set(gpio, dinPin,Function::Type::Out) ;
-    Function::set(gpio,doutPin,Function::Type:: In) ;
+    Function::Switch s ;
+    s.add(  csPin,Function::Type::Out) ;
+    s.add( clkPin,Function::Type::Out) ;
+    s.add( dinPin,Function::Type::Out) ;
+    for (auto pin : doutPins)
+    {
+	s.add(pin,Function::Type::In) ;
+	this->pins.dout |= 1u << pin.value() ;
+    }
+    s.apply(gpio) ;
 }
 
 Device::Mcp3008::Circuit::Sample
-Device::Mcp3008::Bang::msb(Record const &record) const
+Device::Mcp3008::Bang::msb(Record const &record,size_t i) const
 {
-    auto mask = this->pins.dout ;
+    auto mask = 1u << this->douts.at(i).value() ;
     Device::Mcp3008::Circuit::Sample::Unsigned d ;
     d = (0 != (record.sample[0] & mask)) ? 1 : 0 ;
     for (int i=1 ; i<10 ; ++i)
@@ -38,9 +58,9 @@ Device::Mcp3008::Bang::msb(Record const &record) const
 }
 
 Device::Mcp3008::Circuit::Sample
-Device::Mcp3008::Bang::lsb(Record const &record) const
+Device::Mcp3008::Bang::lsb(Record const &record,size_t i) const
 {
-    auto mask = this->pins.dout ;
+    auto mask = 1u << this->douts.at(i).value() ;
     Device::Mcp3008::Circuit::Sample::Unsigned d ;
     d = (0 != (record.sample[18] & mask)) ? 1 : 0 ;
     for (int i=17 ; i>=9 ; --i)
@@ -52,21 +72,34 @@ Device::Mcp3008::Bang::lsb(Record const &record) const
     return Device::Mcp3008::Circuit::Sample::coset(d) ;
 }
 
+void Device::Mcp3008::Bang::msb(Record const &record,Circuit::Sample *samples) const
+{
+    uint32_t a[32] = { 0 } ;
+    for (unsigned i=0 ; i<10 ; ++i)
+	a[9-i] = record.sample[i] ;
+    Neat::Bit::transpose(a) ;
+    // ...a[pin] holds the 10-bit sample of the device at DOUT=pin
+    for (size_t i=0 ; i<this->douts.size() ; ++i)
+	samples[i] = Circuit::Sample::coset(a[this->douts[i].value()]) ;
+}
+
 Device::Mcp3008::Bang::Error
-Device::Mcp3008::Bang::error(Record const &record) const
+Device::Mcp3008::Bang::error(Record const &record,size_t i) const
 {
     Error error ;
+
+    auto dout = 1u << this->douts.at(i).value() ;
     
     error.reset_cs   = (0 == (record.resetLevel & this->pins.  cs)) ;
     error.reset_clk  = (0 != (record.resetLevel & this->pins. clk)) ;
     error.reset_din  = (0 != (record.resetLevel & this->pins. din)) ;
-    error.reset_dout = (0 == (record.resetLevel & this->pins.dout)) ;
-    error.recv_dout  = (0 != (record.startLevel & this->pins.dout)) ;
-    error.end_dout   = (0 == (record. endLevel & this->pins.dout)) ;
+    error.reset_dout = (0 == (record.resetLevel & dout)) ;
+    error.recv_dout  = (0 != (record.startLevel & dout)) ;
+    error.end_dout   = (0 == (record. endLevel & dout)) ;
 
     error.bled_off = (record.t_end - record.t_start > this->timing.bled) ;
-    error.recv_mismatch = (this->lsb(record).value() !=
-			   this->msb(record).value()) ;
+    error.recv_mismatch = (this->lsb(record,i).value() !=
+			   this->msb(record,i).value()) ;
     return error ;
 }
 
@@ -88,34 +121,58 @@ Device::Mcp3008::Bang::Script Device::Mcp3008::Bang::
 makeScript(Circuit::Source source,bool monitor,Record *record)
 {
     RpiExt::Bang::Enqueue q ;
+    this->enqueue(&q,source,monitor,record) ;
+    return q.vector() ;
+}
+
+Device::Mcp3008::Bang::Script Device::Mcp3008::Bang::
+makeScript(Circuit::Source source,bool monitor,Record *record,size_t n)
+{
+    RpiExt::Bang::Enqueue q ;
+    if (n == 0)
+	return q.vector() ;
+    q.loop(Neat::demote<uint32_t>(n)) ;
+    auto top = q.label() ;
+    this->enqueue(&q,source,monitor,record) ;
+    q.advance(sizeof(Record)) ;
+    q.repeat(top) ;
+    return q.vector() ;
+}
+
+void Device::Mcp3008::Bang::
+enqueue(RpiExt::Bang::Enqueue *q_,Circuit::Source source,bool monitor,Record *record)
+{
+    auto &q = (*q_) ;
+    auto slot = [](uint32_t *p) { return RpiExt::Bang::slot(p) ; } ;
+    // ...the record is relative to the data offset (see makeScript)
     
     // +++ reset +++
     
     q.set(this->pins.cs) ; 
     
-    q.time(&record->t0) ;
+    q.time(slot(&record->t0)) ;
     
     q.reset(this->pins.din | this->pins.clk) ;
     
-    q.wait(&record->t0,this->timing.csh) ;
+    q.wait(slot(&record->t0),this->timing.csh) ;
     
     if (monitor)
-	q.levels(&record->resetLevel) ;
+	q.levels(slot(&record->resetLevel)) ;
     
     // +++ start-bit +++
 
     if (this->timing.sucs > this->timing.su)
     {
-	q.reset(this->pins. cs) ; q.time(&record->t0) ;
-	q.  set(this->pins.din) ; q.time(&record->t1) ;
+	q.reset(this->pins. cs) ; q.time(slot(&record->t0)) ;
+	q.  set(this->pins.din) ; q.time(slot(&record->t1)) ;
     }
     else
     {
-	q.  set(this->pins.din) ; q.time(&record->t1) ;
-	q.reset(this->pins. cs) ; q.time(&record->t0) ;
+	q.  set(this->pins.din) ; q.time(slot(&record->t1)) ;
+	q.reset(this->pins. cs) ; q.time(slot(&record->t0)) ;
     }
-    q.wait(&record->t0,this->timing.sucs) ;
-    q.wait(&record->t1,this->timing.  su) ;
+    q.wait(slot(&record->t0),this->timing.sucs) ;
+    q.wait(slot(&record->t1),this->timing.  su) ;
     
     q.set(this->pins.clk) ;
 
@@ -139,9 +196,9 @@ makeScript(Circuit::Source source,bool monitor,Record *record)
     //  been received. The sample period will end on the falling
     //  edge of the fifth clock following the start bit."
 
-    q.time(&record->t_start) ;
+    q.time(slot(&record->t_start)) ;
 
-    q.wait(&record->t_start,this->timing.hd) ;
+    q.wait(slot(&record->t_start),this->timing.hd) ;
 
     q.reset(this->pins.clk) ;
 
@@ -157,15 +214,15 @@ makeScript(Circuit::Source source,bool monitor,Record *record)
     
     // "On the falling edge the device will output a null bit."
 
-    q.time(&record->t0) ;
+    q.time(slot(&record->t0)) ;
     
     if (monitor)
     {
-	q.wait(&record->t0,this->timing.en) ;
-	q.levels(&record->startLevel) ;
+	q.wait(slot(&record->t0),this->timing.en) ;
+	q.levels(slot(&record->startLevel)) ;
     }
 
-    q.wait(&record->t0,this->timing.lo) ;
+    q.wait(slot(&record->t0),this->timing.lo) ;
 
     // +++ 10-bit sample (MSB first) +++
     
@@ -181,18 +238,18 @@ makeScript(Circuit::Source source,bool monitor,Record *record)
     
 	q.reset(this->pins.clk) ;
 
-	q.time(&record->t0) ;
+	q.time(slot(&record->t0)) ;
 
-	q.wait(&record->t0,this->timing.dov) ;
+	q.wait(slot(&record->t0),this->timing.dov) ;
 
-	q.levels(&record->sample[i]) ;
+	q.levels(slot(&record->sample[i])) ;
 
-	q.wait(&record->t0,this->timing.lo) ;
+	q.wait(slot(&record->t0),this->timing.lo) ;
     }
     
     if (monitor)
     {
-	q.recent(&record->t_end) ;
+	q.recent(slot(&record->t_end)) ;
 	
 	// +++ 10-bit sample (LSB first) +++
 
@@ -210,13 +267,13 @@ makeScript(Circuit::Source source,bool monitor,Record *record)
     
 	    q.reset(this->pins.clk) ;
 
-	    q.time(&record->t0) ;
+	    q.time(slot(&record->t0)) ;
 
-	    q.wait(&record->t0,this->timing.dov) ;
+	    q.wait(slot(&record->t0),this->timing.dov) ;
 
-	    q.levels(&record->sample[i]) ;
+	    q.levels(slot(&record->sample[i])) ;
 
-	    q.wait(&record->t0,this->timing.lo) ;
+	    q.wait(slot(&record->t0),this->timing.lo) ;
 	}
     }
     
@@ -225,7 +282,98 @@ makeScript(Circuit::Source source,bool monitor,Record *record)
     q.set(this->pins.cs) ; q.sleep(this->timing.dis) ;
     
     if (monitor)
-	q.levels(&record->endLevel) ;
+	q.levels(slot(&record->endLevel)) ;
+}
 
-    return q.vector() ;
+namespace
+{
+    using namespace RpiExt::BangStatic ;
+
+    using Record = Device::Mcp3008::Bang::Record ;
+    
+    enum : unsigned { Cs,Clk,Din,Dout,ClkDin } ; // pins
+
+    enum : unsigned { Csh,Sucs,Hd,Su,En,Lo,Hi,Dov,Dis } ; // ticks
+
+    enum : unsigned // vars (words of Record)
+    {
+	ResetLevel = offsetof(Record,resetLevel) / sizeof(uint32_t),
+	StartLevel = offsetof(Record,startLevel) / sizeof(uint32_t),
+	Sample     = offsetof(Record,    sample) / sizeof(uint32_t),
+	EndLevel   = offsetof(Record,  endLevel) / sizeof(uint32_t),
+	TStart     = offsetof(Record,   t_start) / sizeof(uint32_t),
+	TEnd       = offsetof(Record,     t_end) / sizeof(uint32_t),
+	T0         = offsetof(Record,        t0) / sizeof(uint32_t),
+	T1         = offsetof(Record,        t1) / sizeof(uint32_t),
+    } ;
+
+    static_assert(sizeof(Record) == (T1+1) * sizeof(uint32_t),"") ;
+
+    // D3,D2,D1,D0 (source)
+    template<unsigned I> using Source = Seq<
+	Sleep<Hd>,Reset<Clk>,Put<Din,3-I>,Sleep<Su>,Set<Clk>> ;
+
+    // sample bit (MSB first: 0..9; LSB first: 10..18)
+    template<unsigned I> using Bit = Seq<
+	Set<Clk>,Sleep<Hi>,Reset<Clk>,
+	Time<T0>,Wait<T0,Dov>,Levels<Sample+I>,Wait<T0,Lo>> ;
+
+    // the same sequence as makeScript() (CsFirst: sucs > su)
+    template<bool Monitor,bool CsFirst> using Dialogue = Seq<
+	// reset
+	Set<Cs>,Time<T0>,Reset<ClkDin>,Wait<T0,Csh>,
+	If<Monitor,Levels<ResetLevel>>,
+	// start-bit
+	typename std::conditional<
+	    CsFirst,
+	    Seq<Reset<Cs>,Time<T0>,Set<Din>,Time<T1>>,
+	    Seq<Set<Din>,Time<T1>,Reset<Cs>,Time<T0>>>::type,
+	Wait<T0,Sucs>,Wait<T1,Su>,Set<Clk>,
+	For<Source,0,4>,
+	// sample
+	Time<TStart>,Wait<TStart,Hd>,Reset<Clk>,Sleep<Su>,Set<Clk>,Sleep<Hd>,Reset<Clk>,
+	// start-bit (output)
+	Time<T0>,If<Monitor,Seq<Wait<T0,En>,Levels<StartLevel>>>,Wait<T0,Lo>,
+	// 10-bit sample
+	For<Bit,0,10>,
+	If<Monitor,Seq<Recent<TEnd>,For<Bit,10,19>>>,
+	// end dialogue
+	Set<Cs>,Sleep<Dis>,
+	If<Monitor,Levels<EndLevel>>> ;
+
+    template<typename D> void run(Context *c,Record *record,size_t n)
+    {
+	for (size_t i=0 ; i<n ; ++i)
+	{
+	    c->vars = reinterpret_cast<uint32_t*>(record+i) ;
+	    D::run(*c) ;
+	}
+    }
+}
+
+void Device::Mcp3008::Bang::acquire(Circuit::Source source,bool monitor,Record *record,size_t n)
+{
+    uint32_t const pins[] = {
+	this->pins.cs,this->pins.clk,this->pins.din,this->pins.dout,
+	this->pins.clk | this->pins.din,
+    } ;
+    uint32_t const ticks[] = {
+	this->timing.csh,this->timing.sucs,this->timing.hd,
+	this->timing.su,this->timing.en,this->timing.lo,
+	this->timing.hi,this->timing.dov,this->timing.dis,
+    } ;
+    Context c(this->rpi,pins,ticks,nullptr) ;
+    c.data = source.value() ;
+    
+    auto csFirst = (this->timing.sucs > this->timing.su) ;
+    if (monitor)
+    {
+	if (csFirst) run<Dialogue<true, true>>(&c,record,n) ;
+	else         run<Dialogue<true,false>>(&c,record,n) ;
+    }
+    else
+    {
+	if (csFirst) run<Dialogue<false, true>>(&c,record,n) ;
+	else         run<Dialogue<false,false>>(&c,record,n) ;
+    }
 }
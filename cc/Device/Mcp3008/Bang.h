@@ -20,12 +20,26 @@ struct Bang
 	Rpi::Pin     doutPin,
 	Timing const &timing) ;
 
+    Bang(
+	Rpi::Peripheral *rpi,
+	Rpi::Pin       csPin,
+	Rpi::Pin      clkPin,
+	Rpi::Pin      dinPin,
+	std::vector<Rpi::Pin> const &doutPins,
+	Timing const &timing) ;
+    // ...several devices that share CS, CLK and DIN; each with its
+    //    own DOUT pin. All of them are read by the same level samples
+    //    (i.e. at the cost of a single transfer).
+
+    size_t size() const { return this->douts.size() ; }
+    // ...the number of devices
+
     struct Pins
     {
 	uint32_t   cs ;
 	uint32_t  clk ;
 	uint32_t  din ;
-	uint32_t dout ;
+	uint32_t dout ; // (of all devices)
 	Pins(
 	    Rpi::Pin   csPin,
 	    Rpi::Pin  clkPin,
@@ -56,14 +70,26 @@ struct Bang
     using Script = std::vector<RpiExt::Bang::Command> ;
     
     Script makeScript(Circuit::Source source,bool monitor,Record *record) ;
+
+    Script makeScript(Circuit::Source source,bool monitor,Record *record,size_t n) ;
+    // ...a loop that acquires n samples into the array record[0..n-1]
     
     Record query(Circuit::Source,bool monitor) ;
 
-    // record.sample[0..9]
-    Circuit::Sample msb(Record const &record) const ;
+    void acquire(Circuit::Source source,bool monitor,Record *record,size_t n) ;
+    // ...as makeScript(...,record,n) but with a compile-time script
+    //    (RpiExt::BangStatic) instead of an interpreted one
+
+    // record.sample[0..9] (of the i-th device)
+    Circuit::Sample msb(Record const &record,size_t i=0) const ;
     
     // record.sample[9..18] (monitor)
-    Circuit::Sample lsb(Record const &record) const ;
+    Circuit::Sample lsb(Record const &record,size_t i=0) const ;
+
+    // record.sample[0..9] of all devices at once
+    void msb(Record const &record,Circuit::Sample *samples) const ;
+    // ...by a bit-transpose of the level samples; the array size
+    //    must match the number of devices
 
     struct Error 
     {
@@ -100,7 +126,7 @@ struct Bang
     } ;
     
     // verify (monitor)
-    Error error(Record const &record) const ;
+    Error error(Record const &record,size_t i=0) const ;
 
 private:
   
@@ -108,7 +134,11 @@ private:
 
     Pins pins ;
 
+    std::vector<Rpi::Pin> douts ;
+
     Timing timing ;
+
+    void enqueue(RpiExt::Bang::Enqueue *q,Circuit::Source source,bool monitor,Record *record) ;
     
 } ; } } 
 
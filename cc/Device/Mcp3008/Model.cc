@@ -0,0 +1,174 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Model.h"
+
+using Model = Device::Mcp3008::Model ;
+
+Model::Model(Rpi::Pin csPin,Rpi::Pin clkPin,Rpi::Pin dinPin,Rpi::Pin doutPin,Timing const &timing)
+    : cs(1u<<csPin.value()),clk(1u<<clkPin.value()),din(1u<<dinPin.value()),dout(1u<<doutPin.value())
+    , timing(timing)
+    , state(State::Idle)
+    , prev(cs),t_cs(0),t_clk(0),t_rise(0),t_din(0),t_sample(0)
+    , source(0),nbit(0),value(0)
+    , level(true),enabled(false)
+    , pending(Never),pendingLevel(true),pendingEnabled(false)
+    , nconv(0),nclk(0)
+{
+    for (auto &sample : this->inputA)
+	sample = Circuit::Sample::coset(0) ;
+}
+
+uint32_t Model::update(uint64_t t,uint32_t levels)
+{
+    if (this->pending <= t)
+    {
+	this->enabled = this->pendingEnabled ;
+	this->level = this->pendingLevel ;
+	this->pending = Never ;
+    }
+
+    auto cur = levels & (this->cs | this->clk | this->din) ;
+    auto changed = cur ^ this->prev ;
+
+    if (changed & this->cs)
+    {
+	if (cur & this->cs)
+	{
+	    // end of dialogue
+	    this->state = State::Idle ;
+	    this->schedule(t + this->timing.dis,false,true) ;
+	}
+	else
+	{
+	    if (t - this->t_cs < this->timing.csh)
+		this->violate(t,"MCP3008:csh") ;
+	    this->state = State::Start ;
+	    this->t_clk = t ; // ...see sucs
+	}
+	this->t_cs = t ;
+    }
+
+    auto active = (this->state != State::Idle) ;
+
+    if (changed & this->din)
+    {
+	if (active && (this->state != State::Output))
+	    if (t - this->t_rise < this->timing.hd)
+		this->violate(t,"MCP3008:hd") ;
+	this->t_din = t ;
+    }
+
+    if (active && (changed & this->clk))
+    {
+	if (cur & this->clk) this->rise(t,cur) ;
+	else                 this->fall(t) ;
+	this->t_clk = t ;
+    }
+
+    this->prev = cur ;
+
+    if (this->pending <= t)
+    {
+	this->enabled = this->pendingEnabled ;
+	this->level = this->pendingLevel ;
+	this->pending = Never ;
+    }
+
+    if (this->enabled)
+    {
+	if (this->level) levels |=  this->dout ;
+	else             levels &= ~this->dout ;
+    }
+    return levels ;
+}
+
+uint64_t Model::minimum() const
+{
+    auto cycle = uint64_t(this->timing.hi) + this->timing.lo ;
+    auto frame = uint64_t(this->timing.csh) + this->timing.sucs + this->timing.dis ;
+    return this->nconv * frame + this->nclk * cycle ;
+}
+
+void Model::schedule(uint64_t t,bool enabled,bool level)
+{
+    this->pending = t ;
+    this->pendingEnabled = enabled ;
+    this->pendingLevel = level ;
+}
+
+void Model::rise(uint64_t t,uint32_t levels)
+{
+    ++this->nclk ;
+    this->t_rise = t ;
+    if (this->t_clk == this->t_cs)
+    {
+	// first clock after CS fall
+	if (t - this->t_cs < this->timing.sucs)
+	    this->violate(t,"MCP3008:sucs") ;
+    }
+    else if (t - this->t_clk < this->timing.lo)
+	this->violate(t,"MCP3008:lo") ;
+
+    auto bit = 0 != (levels & this->din) ? 1u : 0u ;
+    switch (this->state)
+    {
+    case State::Start:
+	if (bit == 1)
+	{
+	    if (t - this->t_din < this->timing.su)
+		this->violate(t,"MCP3008:su") ;
+	    this->state = State::Request ;
+	    this->source = 0 ;
+	    this->nbit = 0 ;
+	}
+	// ...leading zeros are ignored
+	break ;
+    case State::Request:
+	if (this->nbit < 4)
+	{
+	    if (t - this->t_din < this->timing.su)
+		this->violate(t,"MCP3008:su") ;
+	    this->source = (this->source << 1) | bit ;
+	}
+	++this->nbit ;
+	// ...the 4th rising edge starts the sample period and the
+	//    falling edge of the 5th clock ends it
+	break ;
+    case State::Idle:
+    case State::Output:
+	break ;
+    }
+}
+
+void Model::fall(uint64_t t)
+{
+    if (t - this->t_clk < this->timing.hi)
+	this->violate(t,"MCP3008:hi") ;
+
+    if (this->state == State::Request)
+    {
+	if (this->nbit == 5)
+	{
+	    // the null bit
+	    this->state = State::Output ;
+	    this->t_sample = t ;
+	    this->value = this->inputA[this->source].value() ;
+	    this->nbit = 0 ;
+	    ++this->nconv ;
+	    this->schedule(t + this->timing.en,true,false) ;
+	}
+    }
+    else if (this->state == State::Output)
+    {
+	++this->nbit ;
+	auto bit = false ;
+	if (this->nbit <= 10)
+	    bit = 0 != (this->value & (1u << (10 - this->nbit))) ;
+	else if (this->nbit <= 19)
+	    bit = 0 != (this->value & (1u << (this->nbit - 10))) ;
+	this->schedule(t + this->timing.dov,true,bit) ;
+	if (this->nbit == 10)
+	    if (t - this->t_sample > this->timing.bled)
+		this->violate(t,"MCP3008:bled") ;
+    }
+}
@@ -0,0 +1,84 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// A behavioral (pin-level) model of the MCP3008 for the virtual bus
+// (see RpiExt::Sim::Bus). It decodes the request, outputs the sample
+// (null-bit, MSB first, LSB first, zeros) and verifies the timing
+// constraints (i.e. the minimum values of Circuit::Timing).
+//
+// DOUT changes with the time given by dov after the falling CLK edge;
+// it gets disabled (pulled-up) with the time given by dis after the
+// rising CS edge.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_Device_Mcp3008_Model_h
+#define INCLUDE_Device_Mcp3008_Model_h
+
+#include "Circuit.h"
+#include <Rpi/Pin.h>
+#include <RpiExt/Sim/Bus.h>
+
+namespace Device { namespace Mcp3008 {
+
+struct Model : RpiExt::Sim::Model
+{
+    using Timing = Circuit::Timing<uint32_t> ;
+
+    Model(Rpi::Pin csPin,Rpi::Pin clkPin,Rpi::Pin dinPin,Rpi::Pin doutPin,Timing const &timing) ;
+
+    // the value to return for the given source (default: zero)
+    void input(Circuit::Source source,Circuit::Sample sample)
+    {
+	this->inputA[source.value()] = sample ;
+    }
+
+    uint32_t update(uint64_t t,uint32_t levels) override ;
+
+    uint64_t next() const override { return this->pending ; }
+
+    uint64_t minimum() const override ;
+
+    size_t conversions() const { return this->nconv ; }
+
+private:
+
+    uint32_t cs,clk,din,dout ; // pin masks
+
+    Timing timing ;
+
+    Circuit::Sample inputA[16] ;
+
+    enum class State { Idle,Start,Request,Output } ;
+
+    State state ;
+
+    uint32_t prev ; // cs/clk/din levels of the last update
+
+    uint64_t t_cs ;  // last CS edge
+    uint64_t t_clk ; // last CLK edge
+    uint64_t t_rise ; // last rising CLK edge
+    uint64_t t_din ; // last DIN edge
+    uint64_t t_sample ; // end of sample period
+
+    unsigned source ; // request bits (so far)
+    unsigned nbit ;   // number of request/output bits (so far)
+    unsigned value ;  // the converted sample
+
+    bool level ;      // DOUT (if enabled)
+    bool enabled ;    // DOUT driven
+
+    uint64_t pending ; // next DOUT change (if any)
+    bool pendingLevel,pendingEnabled ;
+
+    size_t nconv ;   // number of conversions
+    size_t nclk ;    // number of clock cycles (while CS low)
+
+    void schedule(uint64_t t,bool enabled,bool level) ;
+    
+    void rise(uint64_t t,uint32_t levels) ;
+    void fall(uint64_t t) ;
+} ;
+
+} }
+
+#endif // INCLUDE_Device_Mcp3008_Model_h
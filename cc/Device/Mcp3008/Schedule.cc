@@ -0,0 +1,107 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Schedule.h"
+#include <algorithm>
+#include <cmath>
+
+using Schedule = Device::Mcp3008::Schedule ;
+
+Schedule::Schedule(std::vector<Entry> const &entries,size_t maxLength,double minRate)
+{
+    if (entries.empty())
+	throw Error("no sources") ;
+    std::fill(this->lookup,this->lookup+16,-1) ;
+
+    double sum = 0 ; double min = entries.front().rate ;
+    for (auto const &entry: entries)
+    {
+	if (!(entry.rate > 0))
+	    throw Error("rate must be positive") ;
+	if (this->lookup[entry.source.value()] != -1)
+	    throw Error("source given twice") ;
+	this->lookup[entry.source.value()] = static_cast<int>(this->table.size()) ;
+	this->table.push_back(Stats(entry,0)) ;
+	sum += entry.rate ;
+	min = std::min(min,entry.rate) ;
+    }
+
+    // the cycle rate: the slowest source gets a single slot, unless
+    // the cycle gets too long
+    auto g = std::max(min,sum / static_cast<double>(maxLength)) ;
+
+    struct Slot { double pos ; size_t i ; } ;
+    std::vector<Slot> slots ;
+    for (size_t i=0 ; i<this->table.size() ; ++i)
+    {
+	auto n = static_cast<size_t>(std::ceil(this->table[i].entry.rate / g - 1e-9)) ;
+	if (n == 0) n = 1 ;
+	this->table[i].slots = n ;
+	for (size_t k=0 ; k<n ; ++k)
+	    slots.push_back(Slot { (static_cast<double>(k) + .5) / static_cast<double>(n),i }) ;
+	// ...the ideal positions in the cycle (0..1)
+    }
+    std::stable_sort(slots.begin(),slots.end(),[](Slot const &a,Slot const &b) {
+	    return a.pos < b.pos ; }) ;
+
+    for (auto const &slot: slots)
+	this->cycle.push_back(this->table[slot.i].entry.source) ;
+    this->total = g * static_cast<double>(this->cycle.size()) ;
+
+    // the cycle is run k times faster if it's too slow for the stream
+    this->k = 1 ;
+    if (this->total < minRate)
+	this->k = static_cast<size_t>(std::ceil(minRate / this->total)) ;
+}
+
+size_t Schedule::account(Stream::Sample *sample,size_t n)
+{
+    size_t nkept = 0 ;
+    for (auto p=sample ; p!=sample+n ; ++p)
+    {
+	auto i = this->lookup[p->source.value()] ;
+	if (i < 0)
+	    continue ; // ...not scheduled
+	auto &s = this->table[static_cast<size_t>(i)] ;
+	if (s.skip > 0)
+	{
+	    --s.skip ;
+	    continue ; // ...decimated
+	}
+	s.skip = this->k - 1 ;
+	sample[nkept++] = *p ;
+	if (!p->error.ok())
+	    ++s.errors ;
+	s.last = p->value ;
+	if (s.count == 0)
+	{
+	    s.t0 = s.t1 = p->t ;
+	}
+	else
+	{
+	    auto d = p->t - s.t1 ; // ...wraps around (after 71 minutes)
+	    s.t1 = p->t ;
+	    s.dmin = std::min(s.dmin,d) ;
+	    s.dmax = std::max(s.dmax,d) ;
+	    auto k = static_cast<double>(s.count) ; // number of intervals
+	    auto delta = d - s.mean ;
+	    s.mean += delta / k ;
+	    s.m2 += delta * (d - s.mean) ;
+	}
+	++s.count ;
+    }
+    return nkept ;
+}
+
+double Schedule::Stats::rate() const
+{
+    if (this->count < 2)
+	return 0 ;
+    return 1e6 / this->mean ;
+}
+
+double Schedule::Stats::jitter() const
+{
+    if (this->count < 3)
+	return 0 ;
+    return std::sqrt(this->m2 / static_cast<double>(this->count - 2)) ;
+}
@@ -0,0 +1,89 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// An acquisition plan for sources with different sample rates.
+//
+// The plan is a cycle of sources (a scan list for Mcp3008::Stream)
+// where each source takes a number of slots in proportion to its rate
+// (at least one). The slots of a source are spread evenly across the
+// cycle (by their ideal positions). The cycle length is limited; if
+// the rates differ by more than that, the slow sources are sampled
+// faster than requested (but not the other way round).
+//
+// The Stream is then run at the plan's aggregate rate. If the cycle's
+// rate is below the Stream's least rate, the Stream runs the cycle a
+// number of times faster (the decimation) and only every such sample
+// of a source is kept. The samples kept are accounted per source: the
+// number of samples and the intervals between them (by the time-
+// stamps), i.e. the achieved rate and the jitter.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_Device_Mcp3008_Schedule_h
+#define INCLUDE_Device_Mcp3008_Schedule_h
+
+#include "Stream.h"
+
+namespace Device { namespace Mcp3008 {
+
+struct Schedule
+{
+    struct Error : Neat::Error
+    {
+	Error(std::string const &s) : Neat::Error("Device:Mcp3008:Schedule:" + s) {}
+    } ;
+
+    struct Entry
+    {
+	Circuit::Source source ; double rate ; // samples per second
+	Entry(Circuit::Source source,double rate) : source(source),rate(rate) {}
+    } ;
+
+    Schedule(std::vector<Entry> const &entries,size_t maxLength=1024,double minRate=Stream::rate(65534)) ;
+
+    // the interleaved sources (a cycle)
+    Stream::Scan const& scan() const { return this->cycle ; }
+
+    // the aggregate sample rate to meet all the (target) rates
+    double rate() const { return this->total * static_cast<double>(this->k) ; }
+
+    // only every k-th sample of a source is kept
+    size_t decimation() const { return this->k ; }
+
+    struct Stats
+    {
+	Entry entry ;
+	size_t slots ;           // in the cycle
+	size_t skip ;            // samples to drop before the next one
+	size_t count ;           // samples accounted
+	size_t errors ;          // ...that failed verification
+	Circuit::Sample last ;   // the most recent value
+	uint32_t t0,t1 ;         // first and last time-stamp (us)
+	double mean,m2 ;         // of the intervals (Welford)
+	uint32_t dmin,dmax ;     // the shortest and longest interval
+
+	Stats(Entry const &entry,size_t slots)
+	    : entry(entry),slots(slots),skip(0),count(0),errors(0),last()
+	    , t0(0),t1(0),mean(0),m2(0),dmin(~0u),dmax(0) {}
+
+	double rate() const ; // achieved (by the time-stamps)
+	double jitter() const ; // standard deviation of the intervals (us)
+    } ;
+
+    // account the samples (as fetched from the Stream); the samples
+    // kept are moved to the front; their number is returned
+    size_t account(Stream::Sample *sample,size_t n) ;
+
+    std::vector<Stats> const& stats() const { return this->table ; }
+
+private:
+
+    Stream::Scan cycle ; double total ; size_t k ;
+
+    std::vector<Stats> table ;
+
+    int lookup[16] ; // source -> table index (or -1)
+} ;
+
+} }
+
+#endif // INCLUDE_Device_Mcp3008_Schedule_h
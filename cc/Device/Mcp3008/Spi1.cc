@@ -1,7 +1,7 @@
 // BSD 2-Clause License, see github.com/ma16/rpio
 
 #include "Spi1.h"
-#include <vector>
+#include <deque>
 
 static uint32_t reverse(uint32_t i)
 {
@@ -85,3 +85,35 @@ Device::Mcp3008::Spi1::Sample26::verify() const
     error.mismatch = 0 != (0x3ff & (msb ^ lsb)) ;
     return error ;
 }
+
+std::vector<uint32_t>
+Device::Mcp3008::Spi1::scan(uint32_t len,std::vector<Circuit::Source> const &sources)
+{
+    auto c0 = this->spi.getControl0() ;
+    c0 &= ~Rpi::Spi1::Len ;
+    c0 |= len ; 
+    this->spi.setControl0(c0) ;
+    std::deque<uint32_t> tx ;
+    for (auto source: sources)
+    {
+	// start bit:4 + channel number bit:0-3; 5 bits, MSB first
+	tx.push_back((0x10u | source.value()) << (32-5)) ;
+    }
+    std::vector<uint32_t> rx ; rx.reserve(tx.size()) ;
+    this->spi.xfer(tx,&rx,false) ;
+    return rx ;
+}
+
+std::vector<Device::Mcp3008::Spi1::Sample17>
+Device::Mcp3008::Spi1::scan17(std::vector<Circuit::Source> const &sources)
+{
+    auto rx = this->scan(17,sources) ;
+    return std::vector<Sample17>(rx.begin(),rx.end()) ;
+}
+
+std::vector<Device::Mcp3008::Spi1::Sample26>
+Device::Mcp3008::Spi1::scan26(std::vector<Circuit::Source> const &sources)
+{
+    auto rx = this->scan(26,sources) ;
+    return std::vector<Sample26>(rx.begin(),rx.end()) ;
+}
@@ -6,6 +6,7 @@
 #include "Circuit.h"
 #include <Neat/uint.h>
 #include <Rpi/Spi1.h>
+#include <vector>
 
 namespace Device { namespace Mcp3008 {
 
@@ -46,12 +47,21 @@ struct Spi1
 	Circuit::Sample fetch() const ;
     } ;
     Sample26 query26(Circuit::Source) ;
+
+    // query several sources in one go: the requests are queued back
+    // to back into the FIFO, which is topped up while the responses
+    // are drained; i.e. the serializer isn't reset between samples
+    // (the chip-select is still released after each word)
+    std::vector<Sample17> scan17(std::vector<Circuit::Source> const &sources) ;
+    std::vector<Sample26> scan26(std::vector<Circuit::Source> const &sources) ;
   
     Spi1(Rpi::Peripheral *rpi) : spi(Rpi::Spi1(rpi)) {}
     
 private:
 
     Rpi::Spi1 spi ;
+
+    std::vector<uint32_t> scan(uint32_t len,std::vector<Circuit::Source> const &sources) ;
 } ;
 
 } } 
@@ -0,0 +1,217 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Stream.h"
+#include <Rpi/Dma/Ti.h>
+#include <Rpi/Timer.h>
+#include <cmath>
+
+using Stream = Device::Mcp3008::Stream ;
+
+// ----[ memory layout ]-----------------------------------------------
+
+// [blocks] 4 x 32 bytes per source and record
+// [tx]     8 bytes per source: control word + query (3 bytes)
+// [reset]  8 bytes: control word (+padding)
+// [slots]  8 bytes per source and record: time-stamp + rx (3 bytes)
+
+Stream::Stream(Rpi::Peripheral *rpi,
+	       Rpi::Dma::Ctrl::Index index,
+	       Rpi::Bus::Memory::Allocator *allocator,
+	       Scan const &scan,
+	       size_t nrecords,
+	       uint16_t divider)
+    : spi(rpi),div(divider)
+    , memory(allocator->allocate(( 4 * 32 * scan.size() * nrecords
+				   + 8 * scan.size()
+				   + 8
+				   + 8 * scan.size() * nrecords)))
+    , channel(Rpi::Dma::Ctrl(rpi).channel(index))
+    , sources(scan),n(nrecords)
+    , i0(0),t0(0),nover(0)
+{
+    if (scan.empty())
+	throw Error("empty scan list") ;
+    if (nrecords < 2)
+	throw Error("at least two records are required") ;
+    if (divider < 2 || (divider & 1) != 0)
+	throw Error("divider must be even (2..65534)") ;
+
+    auto nsrc = scan.size() ;
+    auto cbBytes = 4 * 32 * nsrc * nrecords ;
+    auto txOfs = cbBytes ;
+    auto resetOfs = txOfs + 8 * nsrc ;
+    auto slotOfs = resetOfs + 8 ;
+
+    auto section = this->memory->phys(0) ;
+    if ((section.first.value() & 0x1f) != 0)
+	throw Error("control block not 32-byte aligned") ;
+    if (section.second < cbBytes)
+	throw Error("control blocks not contiguous in bus memory") ;
+    // ...required to derive the record from CONBLK_AD
+    this->cbStart = section.first.value() ;
+
+    auto p = this->memory->as<uint32_t volatile*>() ;
+    for (size_t i=0 ; i<this->memory->nbytes()/4 ; ++i)
+	p[i] = 0 ;
+    // ...the time-stamps in particular
+
+    for (size_t j=0 ; j<nsrc ; ++j)
+    {
+	auto tx = p + txOfs/4 + 2*j ;
+	tx[1] = 0x80u | (scan[j].value() << 3) ; // see Spi0::query24()
+	// ...the control word tx[0] is set by start()
+    }
+    this->slot = p + slotOfs/4 ;
+
+    auto addr = [this](size_t ofs) { return this->memory->phys(ofs).first ; } ;
+
+    auto const fifo = Rpi::Spi0::fifo_addr() ;
+    auto const ctrl = Rpi::Spi0::ctrl_addr() ;
+    auto const rxReq = Rpi::Dma::Ti::Permap::make<7>() ;
+
+    for (size_t i=0 ; i<nrecords ; ++i)
+    {
+	for (size_t j=0 ; j<nsrc ; ++j)
+	{
+	    auto k = i * nsrc + j ;
+	    auto cb = p + 8 * 4 * k ;
+
+	    auto set = [&](size_t b,Rpi::Dma::Ti::Word ti,Rpi::Bus::Address src,Rpi::Bus::Address dst,uint32_t nbytes)
+	    {
+		auto q = cb + 8 * b ;
+		q[0] = ti.value() ;
+		q[1] = src.value() ;
+		q[2] = dst.value() ;
+		q[3] = nbytes ;
+		q[4] = 0 ;
+		q[5] = (b < 3)
+		    ? this->cbStart + static_cast<uint32_t>(32 * (4*k + b + 1))
+		    : this->cbStart + static_cast<uint32_t>(32 * ((4*k + 4) % (4 * nsrc * nrecords))) ;
+		// ...a ring
+		q[6] = 0 ;
+		q[7] = 0 ;
+	    } ;
+
+	    auto slotOfs_k = slotOfs + 8 * k ;
+
+	    set(0,Rpi::Dma::Ti::fixed(),addr(resetOfs),ctrl,4) ;
+
+	    if (this->memory->phys(txOfs + 8*j).second < 7)
+		throw Error("tx data not contiguous in bus memory") ;
+	    set(1,Rpi::Dma::Ti::fromMemory(),addr(txOfs + 8*j),fifo,7) ;
+
+	    set(2,Rpi::Dma::Ti::fixed(),Rpi::Timer::Address,addr(slotOfs_k),4) ;
+
+	    set(3,Rpi::Dma::Ti::fromPeripheral(rxReq),fifo,addr(slotOfs_k + 4),3) ;
+	}
+    }
+}
+
+uint16_t Stream::divider(double rate,double core,double overhead)
+{
+    if (!(rate > 0))
+	throw Error("rate must be positive") ;
+    auto d = std::floor((1 / rate - overhead) * core / 24 / 2) * 2 ;
+    // ...rounded down: the stream runs rather faster than slower
+    if (d < 2)
+	throw Error("rate above " + std::to_string(Stream::rate(2,core,overhead)) + "/s") ;
+    if (d > 65534)
+	throw Error("rate below " + std::to_string(Stream::rate(65534,core,overhead)) + "/s") ;
+    return static_cast<uint16_t>(d) ;
+}
+
+double Stream::rate(uint16_t divider,double core,double overhead)
+{
+    return 1 / (24 * divider / core + overhead) ;
+}
+
+void Stream::start(Rpi::Dma::Cs cs)
+{
+    this->channel.stop() ;
+
+    auto mode = this->spi.getControl() & (Rpi::Spi0::Cs | Rpi::Spi0::Cpha | Rpi::Spi0::Cpol) ;
+    // ...as set up for Spi0::query24()
+
+    auto p = this->memory->as<uint32_t volatile*>() ;
+    auto nsrc = this->sources.size() ;
+    auto txOfs = 4 * 32 * nsrc * this->n ;
+    for (size_t j=0 ; j<nsrc ; ++j)
+	p[txOfs/4 + 2*j] = (3u << 16) | Rpi::Spi0::Ta | mode ;
+    p[txOfs/4 + 2*nsrc] = Rpi::Spi0::ClearRx | Rpi::Spi0::ClearTx | Rpi::Spi0::Dmaen | mode ;
+
+    this->spi.setDivider(this->div) ;
+    this->resync(0) ;
+
+    this->channel.setup(Rpi::Bus::Address(this->cbStart),cs) ;
+    this->channel.start() ;
+}
+
+void Stream::stop()
+{
+    this->channel.stop() ;
+    auto ctrl = this->spi.getControl() ;
+    ctrl &= ~(Rpi::Spi0::Ta | Rpi::Spi0::Dmaen) ;
+    this->spi.setControl(ctrl | Rpi::Spi0::ClearRx | Rpi::Spi0::ClearTx) ;
+}
+
+size_t Stream::index() const
+{
+    auto cb = this->channel.getCb().value() ;
+    if (cb == 0)
+	return this->i0 ; // ...not running
+    auto i = (cb - this->cbStart) / (4 * 32 * this->sources.size()) ;
+    return (i < this->n) ? i : this->i0 ;
+}
+
+uint32_t Stream::stamp(size_t i) const
+{
+    return this->slot[2 * this->sources.size() * i] ;
+}
+
+void Stream::resync(size_t i)
+{
+    this->i0 = i ;
+    this->t0 = this->stamp((i + this->n - 1) % this->n) ;
+}
+
+size_t Stream::fetch(Sample *buffer,size_t n)
+{
+    auto nsrc = this->sources.size() ;
+    auto i1 = this->index() ;
+    // ...the record in progress isn't complete (yet)
+    auto m = (i1 + this->n - this->i0) % this->n ;
+    if (m > n / nsrc)
+    {
+	m = n / nsrc ;
+	i1 = (this->i0 + m) % this->n ;
+    }
+
+    auto q = buffer ;
+    for (size_t i=this->i0 ; i!=i1 ; i=(i+1)%this->n)
+    {
+	auto s = this->slot + 2 * nsrc * i ;
+	for (size_t j=0 ; j<nsrc ; ++j)
+	{
+	    auto w = s[2*j+1] ;
+	    // ...the bytes in the order received; i.e. in MSB order
+	    auto msb = ((w & 0xffu) << 24) | ((w & 0xff00u) << 8) | ((w >> 8) & 0xff00u) ;
+	    Spi0::Sample24 sample(msb) ;
+	    q->t = s[2*j] ;
+	    q->source = this->sources[j] ;
+	    q->value = sample.fetch() ;
+	    q->error = sample.verify() ;
+	    ++q ;
+	}
+    }
+
+    if (this->t0 != this->stamp((this->i0 + this->n - 1) % this->n))
+    {
+	// the DMA has overtaken us: the records may be mixed up
+	++this->nover ;
+	this->resync(this->index()) ;
+	return 0 ;
+    }
+    if (m > 0)
+	this->resync(i1) ;
+    return m * nsrc ;
+}
@@ -0,0 +1,118 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// Continuous acquisition of MCP3008 samples by SPI0 and DMA.
+//
+// The layout follows Console/Peripheral/Spi0 (Layout and Watch): each
+// sample takes four control blocks: (1) reset SPI0 (clear FIFOs and
+// enable DMA), (2) write the control word and the 24-bit query to the
+// tx-FIFO, (3) copy the system timer (Rpi::Timer) and (4) read the
+// three bytes from the rx-FIFO (paced by DREQ #7). A record holds one
+// sample of each source in the scan list. The records make a ring:
+// the last block links to the first one; the DMA runs until stopped.
+//
+// The CPU isn't involved in the acquisition. The consumer polls the
+// ring: the record in progress is derived from the channel's CONBLK_AD
+// register; all records before it are decoded (see Spi0::Sample24).
+// Like Watch, the time-stamp of the last fetched record is kept: if
+// it changed, the DMA has overtaken the consumer (an overrun); the
+// fetched samples are discarded and the stream resyncs. Hence, the
+// ring must be polled at least once per turn.
+//
+// The sample rate is given by the SPI clock: 24 clock cycles per
+// sample plus the DMA's overhead (in the range of a microsecond for
+// the four blocks). The divider is derived from the requested rate
+// and an estimate of the overhead, so the requested rate is met (or
+// exceeded); the actual rate can be taken from the time-stamps. Note the MCP3008's clock limit: 1.35 MHz at 2.7V and 3.6
+// MHz at 5V (i.e. 56k/s and 150k/s at most).
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_Device_Mcp3008_Stream_h
+#define INCLUDE_Device_Mcp3008_Stream_h
+
+#include "Spi0.h"
+#include <Rpi/Bus/Memory.h>
+#include <Rpi/Dma/Ctrl.h>
+#include <vector>
+
+namespace Device { namespace Mcp3008 {
+
+struct Stream
+{
+    struct Error : Neat::Error
+    {
+	Error(std::string const &s) : Neat::Error("Device:Mcp3008:Stream:" + s) {}
+    } ;
+
+    using Scan = std::vector<Circuit::Source> ;
+
+    Stream(Rpi::Peripheral *rpi,
+	   Rpi::Dma::Ctrl::Index index,
+	   Rpi::Bus::Memory::Allocator *allocator,
+	   Scan const &scan,
+	   size_t nrecords,
+	   uint16_t divider) ;
+    // ...the SPI0 clock divider (even, 2..65534) is set by start()
+
+    // the largest divider that meets the given (aggregate) sample
+    // rate; with the core clock (i.e. SPI0's base clock) in Hz and the
+    // DMA's overhead per sample in seconds; throws if the rate is too
+    // high for the least divider, or too low for the largest one
+    static uint16_t divider(double rate,double core=250e6,double overhead=1e-6) ;
+
+    // the (estimated) sample rate for the given divider
+    static double rate(uint16_t divider,double core=250e6,double overhead=1e-6) ;
+
+    void start(Rpi::Dma::Cs cs=Rpi::Dma::Cs()) ;
+
+    void stop() ;
+
+    struct Sample
+    {
+	uint32_t             t ; // system timer (us) before reading
+	Circuit::Source source ;
+	Circuit::Sample  value ;
+	Spi0::Error      error ;
+    } ;
+
+    // decode completed records (whole records only, i.e. up to n /
+    // scan-size) and return the number of samples; zero is returned
+    // if there was an overrun
+    size_t fetch(Sample *buffer,size_t n) ;
+
+    // the number of overruns so far
+    size_t overruns() const { return this->nover ; }
+
+    size_t nrecords() const { return this->n ; }
+
+    Scan const& scan() const { return this->sources ; }
+
+private:
+
+    Rpi::Spi0 spi ; uint16_t div ;
+
+    Rpi::Bus::Memory::shared_ptr memory ;
+
+    Rpi::Dma::Channel channel ;
+    // ...(destructed before the memory) stops the DMA
+
+    Scan sources ; size_t n ;
+
+    uint32_t cbStart ; // bus address of the first block
+
+    uint32_t volatile *slot ; // first record: (time-stamp,rx) per source
+
+    size_t i0 ; uint32_t t0 ; // next record to fetch, time-stamp before
+
+    size_t nover ;
+
+    size_t index() const ;
+
+    uint32_t stamp(size_t i) const ;
+
+    void resync(size_t i) ;
+} ;
+
+} }
+
+#endif // INCLUDE_Device_Mcp3008_Stream_h
@@ -1,7 +1,7 @@
 // BSD 2-Clause License, see github.com/ma16/rpio
 
 #include "BitStream.h"
-#include <cassert>
+#include "Encoder.h"
 #include <sstream>
 
 template<typename T> static std::string
@@ -23,92 +23,29 @@ template<> std::string BitStream::Ticks  ::toStr() const { return ::toStr(*this)
 
 } }
 
-void Device::Ws2812b::BitStream::pushBit(bool bit,size_t n)
+template<typename T> static std::vector<T>
+make(Device::Ws2812b::BitStream::Ticks const &ticks,uint32_t grb,size_t n)
 {
-    for (decltype(n) i=0 ; i<n ; ++i)
-	this->q.push_back(bit) ;
-}
-
-void Device::Ws2812b::BitStream::pushWord(uint32_t grb)
-{
-    for (uint32_t mask=(1u<<23) ; mask!=0 ; mask>>=1)
-    {
-	if (0 == (grb & mask))
-	{
-	    this->pushBit(1,this->ticks.bit_0.hi) ;
-	    this->pushBit(0,this->ticks.bit_0.lo) ;
-	}
-	else
-	{
-	    this->pushBit(1,this->ticks.bit_1.hi) ;
-	    this->pushBit(0,this->ticks.bit_1.lo) ;
-	}
-    }
-}
-  
-void Device::Ws2812b::BitStream::push(uint32_t grb,size_t n)
-{
-    for (decltype(n) i=0 ; i<n ; ++i)
-	this->pushWord(grb) ;
-}
-
-template<typename T> std::vector<T>
-Device::Ws2812b::BitStream::pack() const
-{
-    // only for T: uint8_t and uint32_t
-    auto bpw = 8 * sizeof(T) ;
-    auto n = (this->q.size()+(bpw-1)) / bpw ;
-    std::vector<T> v ;
-    v.reserve(n+2) ;
-    unsigned i = 0 ;
-    T bits = 0 ;
-    for (auto bit : this->q)
-    {
-	bits = static_cast<T>(bits << 1) ;
-	bits = static_cast<T>(bits | bit) ;
-	if (++i < bpw)
-	    continue ;
-	v.push_back(bits) ;
-	i = 0 ;
-    }
-    if (i != 0)
-    {
-	// last word padded with zeros (extends ticks.reset)
-	bits = static_cast<T>(bits << (bpw-i)) ;
-	v.push_back(bits) ;
-    }
-    // [defect] PWM needs two additional words (extends ticks.reset)
-    v.push_back(0) ;
-    v.push_back(0) ;
+    // the frame starts with a reset:
+    // ...the datasheet doesn't really say how to start a dialogue.
+    // By observation: the data-line has to be low for a little while
+    // before the transmission can start (about 2 pixel-times).
+    // Anyway, we use the reset/latch time here (which should be a
+    // safe bet).
+    Device::Ws2812b::Encoder encoder(ticks) ;
+    std::vector<T> v(encoder.size<T>(n)) ;
+    v.resize(encoder.encode(&grb,n,0,&v[0])) ;
     return v ;
 }
 
 std::vector<uint32_t> Device::Ws2812b::BitStream::
 make32(Ticks const &ticks,uint32_t grb,size_t n)
 {
-    BitStream bs(ticks) ;
-    bs.pushBit(0,ticks.reset) ;
-    // ...the datasheet doesn't really say how to start a dialogue.
-    // By observation: the data-line has to be low for a little while
-    // before the transmission can start (about 2 pixel-times).
-    // Anyway, we use the reset/latch time here (which should be a
-    // safe bet).
-    bs.push(grb,n) ;
-    bs.pushBit(0,ticks.reset) ;
-    return bs.pack<uint32_t>() ;
+    return make<uint32_t>(ticks,grb,n) ;
 }
 
 std::vector<uint8_t> Device::Ws2812b::BitStream::
 make8(Ticks const &ticks,uint32_t grb,size_t n)
 {
-    BitStream bs(ticks) ;
-    bs.pushBit(0,ticks.reset) ;
-    // ...the datasheet doesn't really say how to start a dialogue.
-    // By observation: the data-line has to be low for a little while
-    // before the transmission can start (about 2 pixel-times).
-    // Anyway, we use the reset/latch time here (which should be a
-    // safe bet).
-    bs.push(grb,n) ;
-    bs.pushBit(0,ticks.reset) ;
-    return bs.pack<uint8_t>() ;
+    return make<uint8_t>(ticks,grb,n) ;
 }
@@ -5,7 +5,6 @@
 
 #include <cstdint>
 #include <cstddef>
-#include <deque>
 #include <string>
 #include <vector>
 
@@ -52,26 +51,8 @@ struct BitStream
     // the returned vector can be used for RpiExt::Spi0::xfer()
     static std::vector<uint8_t> make8(Ticks const&,uint32_t grb,size_t n) ;
 
-private:
-    
-    // A deque of bools is memory consuming, and there are faster 
-    // implementations too. Still, we go with simple at this time.
-
-    std::deque<bool> q ; Ticks ticks ;
-
-    BitStream(Ticks const &ticks) : ticks(ticks) {}
-    
-    void pushBit(bool bit,size_t n) ;
-
-    void pushWord(uint32_t grb) ;
-  
-    void push(uint32_t grb,size_t n) ;
-
-    template<typename T> std::vector<T> pack() const ;
-
-    // [todo] all these private functions and the related includes can
-    // be hidden in the implementation file (visibility + compile time).
-    
+    // ...see Ws2812b::Encoder to encode distinct values (and to
+    // reuse a buffer)
 } ;
 
 } } 
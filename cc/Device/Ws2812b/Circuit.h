@@ -5,6 +5,7 @@
 
 #include <math.h>
 #include <ostream>
+#include <sstream>
 
 namespace Device { namespace Ws2812b {
 
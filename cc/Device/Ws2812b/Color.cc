@@ -0,0 +1,138 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Color.h"
+#include <cmath>
+#include <stdexcept>
+
+using Color = Device::Ws2812b::Color ;
+
+Color::Color(double gamma,double brightness,bool dither)
+    : g(0),b(0),d(dither)
+{
+    this->build(gamma,brightness) ;
+}
+
+void Color::gamma(double gamma)
+{
+    this->build(gamma,this->b) ;
+}
+
+void Color::brightness(double brightness)
+{
+    this->build(this->g,brightness) ;
+}
+
+void Color::dither(bool enable)
+{
+    this->d = enable ;
+    for (auto &e: this->error)
+	e = 0 ;
+}
+
+void Color::build(double gamma,double brightness)
+{
+    if (gamma <= 0 || brightness < 0 || brightness > 1)
+	throw std::runtime_error("Ws2812b:Color:gamma or brightness out of range") ;
+    this->g = gamma ; this->b = brightness ;
+    for (unsigned i=0 ; i<256 ; ++i)
+    {
+	auto v = std::pow(i / 255.0,this->g) * this->b * 255.0 ;
+	this->lut[i] = static_cast<uint16_t>(std::floor(v * 256.0 + .5)) ;
+	if (this->lut[i] > 0xff00)
+	    this->lut[i] = 0xff00 ;
+	// ...so the dithered sum never exceeds 0xffff
+    }
+}
+
+uint8_t* Color::state(size_t n)
+{
+    if (!this->d)
+	return nullptr ;
+    if (this->error.size() != 3*n)
+	this->error.assign(3*n,0) ;
+    return this->error.empty() ? nullptr : &this->error[0] ;
+}
+
+void Color::convert(uint8_t const *rgb,size_t n,size_t step,uint32_t *grb,uint8_t *e) const
+{
+    auto lut = this->lut ;
+    if (e == nullptr)
+    {
+	for (size_t i=0 ; i<n ; ++i,rgb+=step)
+	{
+	    uint32_t r = lut[rgb[0]] >> 8 ;
+	    uint32_t g = lut[rgb[1]] >> 8 ;
+	    uint32_t b = lut[rgb[2]] >> 8 ;
+	    grb[i] = (g << 16) | (r << 8) | b ;
+	}
+	return ;
+    }
+    for (size_t i=0 ; i<n ; ++i,rgb+=step,e+=3)
+    {
+	uint32_t r = lut[rgb[0]] + e[0] ;
+	uint32_t g = lut[rgb[1]] + e[1] ;
+	uint32_t b = lut[rgb[2]] + e[2] ;
+	e[0] = static_cast<uint8_t>(r) ;
+	e[1] = static_cast<uint8_t>(g) ;
+	e[2] = static_cast<uint8_t>(b) ;
+	grb[i] = ((g >> 8) << 16) | ((r >> 8) << 8) | (b >> 8) ;
+    }
+}
+
+void Color::rgb(uint8_t const *rgb,size_t n,uint32_t *grb)
+{
+    this->convert(rgb,n,3,grb,this->state(n)) ;
+}
+
+void Color::rgba(uint8_t const *rgba,size_t n,uint32_t *grb)
+{
+    // premultiply in chunks (on the stack) to keep the loops simple
+    auto e = this->state(n) ;
+    uint8_t buffer[3*256] ;
+    for (size_t ofs=0 ; ofs<n ; ofs+=256)
+    {
+	auto m = (n-ofs < 256) ? n-ofs : size_t(256) ;
+	auto p = rgba + 4*ofs ;
+	for (size_t i=0 ; i<m ; ++i)
+	{
+	    uint32_t a = p[4*i+3] ;
+	    buffer[3*i+0] = static_cast<uint8_t>((p[4*i+0] * a + 127) / 255) ;
+	    buffer[3*i+1] = static_cast<uint8_t>((p[4*i+1] * a + 127) / 255) ;
+	    buffer[3*i+2] = static_cast<uint8_t>((p[4*i+2] * a + 127) / 255) ;
+	}
+	this->convert(buffer,m,3,grb+ofs,e ? e+3*ofs : nullptr) ;
+    }
+}
+
+void Color::hsv(uint8_t const *hsv,size_t n,uint32_t *grb)
+{
+    auto e = this->state(n) ;
+    uint8_t buffer[3*256] ;
+    for (size_t ofs=0 ; ofs<n ; ofs+=256)
+    {
+	auto m = (n-ofs < 256) ? n-ofs : size_t(256) ;
+	auto p = hsv + 3*ofs ;
+	for (size_t i=0 ; i<m ; ++i)
+	{
+	    // six sectors of 43 (the last one of 40) hue steps
+	    uint32_t h = p[3*i+0], s = p[3*i+1], v = p[3*i+2] ;
+	    uint32_t sector = h / 43 ;
+	    uint32_t f = (h - sector * 43) * 6 ; // 0..252
+	    auto lo = static_cast<uint8_t>((v * (255 - s)) / 255) ;
+	    auto dn = static_cast<uint8_t>((v * (255 - (s * f) / 255)) / 255) ;
+	    auto up = static_cast<uint8_t>((v * (255 - (s * (255 - f)) / 255)) / 255) ;
+	    auto hi = static_cast<uint8_t>(v) ;
+	    auto q = buffer + 3*i ;
+	    switch (sector)
+	    {
+	    case 0:  q[0] = hi ; q[1] = up ; q[2] = lo ; break ;
+	    case 1:  q[0] = dn ; q[1] = hi ; q[2] = lo ; break ;
+	    case 2:  q[0] = lo ; q[1] = hi ; q[2] = up ; break ;
+	    case 3:  q[0] = lo ; q[1] = dn ; q[2] = hi ; break ;
+	    case 4:  q[0] = up ; q[1] = lo ; q[2] = hi ; break ;
+	    default: q[0] = hi ; q[1] = lo ; q[2] = dn ; break ;
+	    }
+	}
+	this->convert(buffer,m,3,grb+ofs,e ? e+3*ofs : nullptr) ;
+    }
+}
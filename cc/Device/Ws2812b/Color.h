@@ -0,0 +1,70 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// Converts whole frames of RGB, RGBA or HSV pixels (8-bit each) to the
+// GRB words of the WS2812B (as taken by the Encoder and the Frame).
+//
+// Each component is mapped by a table (256 entries, 8.8 fixed-point)
+// that combines gamma correction and global brightness. The table is
+// rebuilt only if gamma or brightness change.
+//
+// Temporal dithering: the fraction (the lower 8 bits) of each
+// component is carried over to the same component of the same pixel
+// in the next frame. So, over a few frames, the mean output matches
+// the fixed-point value; i.e. dark colors don't get stuck in the few
+// low steps. The error state is reset if the frame size changes.
+//
+// The loops run over contiguous arrays without branches per pixel
+// (except for HSV), so the compiler may vectorize them.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_Device_Ws2812b_Color_h
+#define INCLUDE_Device_Ws2812b_Color_h
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Device { namespace Ws2812b {
+
+struct Color
+{
+    Color(double gamma=2.8,double brightness=1.0,bool dither=true) ;
+
+    void gamma(double gamma) ;
+
+    // 0.0 (off) ... 1.0 (full)
+    void brightness(double brightness) ;
+
+    void dither(bool enable) ;
+
+    // n pixels of 3 bytes (R,G,B) each
+    void rgb(uint8_t const *rgb,size_t n,uint32_t *grb) ;
+
+    // n pixels of 4 bytes (R,G,B,A) each; the alpha value scales the
+    // color (i.e. blending with black)
+    void rgba(uint8_t const *rgba,size_t n,uint32_t *grb) ;
+
+    // n pixels of 3 bytes (H,S,V) each; hue 0..255 for 0..360 degree
+    void hsv(uint8_t const *hsv,size_t n,uint32_t *grb) ;
+
+private:
+
+    double g,b ; bool d ;
+    
+    uint16_t lut[256] ; // 8.8 fixed-point
+
+    std::vector<uint8_t> error ; // 3 per pixel: the last fractions (R,G,B)
+
+    // validate and assign gamma and brightness, then fill the lut
+    void build(double gamma,double brightness) ;
+
+    // the error state for n pixels (or null if not dithering)
+    uint8_t* state(size_t n) ;
+
+    void convert(uint8_t const *rgb,size_t n,size_t step,uint32_t *grb,uint8_t *e) const ;
+} ;
+
+} }
+
+#endif // INCLUDE_Device_Ws2812b_Color_h
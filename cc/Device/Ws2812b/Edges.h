@@ -0,0 +1,99 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// Generates the edges of a WS2812B chain one by one for a bit-banged
+// transfer (see RpiExt::Serialize::pull); that is, in constant memory
+// and without any set-up time ahead of the transfer.
+//
+// Each LED's 24-bit GRB word is sent MSB first. The sequence starts
+// with a short pulse (to make it visible in an analyser) and a reset;
+// it ends with the latch (reset) period.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_Device_Ws2812b_Edges_h
+#define INCLUDE_Device_Ws2812b_Edges_h
+
+#include "Circuit.h"
+#include <RpiExt/Serialize.h>
+
+namespace Device { namespace Ws2812b {
+
+struct Edges
+{
+    using Edge = RpiExt::Serialize::Edge ;
+
+    // grb[i*stride] for each LED i; i.e. stride=0 sets all LEDs to
+    // the same value; the array must stay valid during the transfer
+    Edges(uint32_t pins,Circuit::Ticks const &ticks,
+	  uint32_t const *grb,size_t nleds,size_t stride=1)
+	: pins(pins),ticks(ticks),grb(grb),nleds(nleds),stride(stride)
+	, phase(0),i(0),mask(0),min(ticks.res_min),max(~0u) {}
+
+    bool operator()(Edge *edge)
+    {
+	auto const Lo = Rpi::Register::Gpio::Output::Level::Lo ;
+	auto const Hi = Rpi::Register::Gpio::Output::Level::Hi ;
+	switch (this->phase)
+	{
+	case 0: // [debugging] make start visible in analyser
+	    (*edge) = Edge(this->pins,10,~0u,Lo) ; ++this->phase ; return true ;
+	case 1:
+	    (*edge) = Edge(this->pins,10,~0u,Hi) ; ++this->phase ; return true ;
+	case 2: // reset
+	    (*edge) = Edge(this->pins,10,~0u,Lo) ; ++this->phase ;
+	    this->mask = 1u << 23 ;
+	    return true ;
+	case 3: // the bit's rising edge
+	    if (this->i == this->nleds)
+	    {
+		(*edge) = Edge(this->pins,this->ticks.res_min,~0u,Lo) ;
+		this->phase = 5 ;
+		return true ;
+	    }
+	    (*edge) = Edge(this->pins,this->min,this->max,Hi) ;
+	    this->phase = 4 ;
+	    return true ;
+	case 4: // the bit's falling edge
+	    if (this->grb[this->i * this->stride] & this->mask)
+	    {
+		(*edge) = Edge(this->pins,this->ticks.t1h_min,this->ticks.t1h_max,Lo) ;
+		this->min = this->ticks.t1l_min ;
+		this->max = this->ticks.t1l_max ;
+	    }
+	    else
+	    {
+		(*edge) = Edge(this->pins,this->ticks.t0h_min,this->ticks.t0h_max,Lo) ;
+		this->min = this->ticks.t0l_min ;
+		this->max = this->ticks.t0l_max ;
+	    }
+	    this->mask >>= 1 ;
+	    if (this->mask == 0)
+	    {
+		this->mask = 1u << 23 ;
+		++this->i ;
+	    }
+	    this->phase = 3 ;
+	    return true ;
+	}
+	return false ;
+    }
+
+    // the number of edges in total
+    size_t size() const { return 4 + 48 * this->nleds ; }
+
+private:
+
+    uint32_t pins ; Circuit::Ticks ticks ;
+
+    uint32_t const *grb ; size_t nleds,stride ;
+
+    unsigned phase ; // see operator()
+
+    size_t i ; uint32_t mask ; // the current LED and bit
+
+    uint32_t min,max ; // the current bit's Low-level duration
+} ;
+
+} }
+
+#endif // INCLUDE_Device_Ws2812b_Edges_h
@@ -0,0 +1,184 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Encoder.h"
+#include <stdexcept>
+
+using Encoder = Device::Ws2812b::Encoder ;
+
+namespace
+{
+    // appends bits (MSB first) to a buffer of T words
+    template<typename T> struct Writer
+    {
+	static constexpr unsigned W = 8 * sizeof(T) ;
+
+	T *p ; uint64_t acc ; unsigned n ; // n bits pending in acc
+
+	Writer(T *p) : p(p),acc(0),n(0) {}
+
+	// k (<=32) bits right-aligned in bits
+	void put(uint32_t bits,unsigned k)
+	{
+	    this->acc = (this->acc << k) | bits ;
+	    this->n += k ;
+	    while (this->n >= W)
+	    {
+		this->n -= W ;
+		*this->p++ = static_cast<T>(this->acc >> this->n) ;
+	    }
+	}
+
+	void zeros(size_t k)
+	{
+	    while (this->n > 0 && k > 0)
+	    {
+		auto m = (k < W - this->n) ? static_cast<unsigned>(k) : W - this->n ;
+		this->put(0,m) ;
+		k -= m ;
+	    }
+	    // ...aligned now (or done)
+	    for ( ; k >= W ; k -= W)
+		*this->p++ = 0 ;
+	    if (k > 0)
+		this->put(0,static_cast<unsigned>(k)) ;
+	}
+
+	// a pattern of nbits (MSB first, left-aligned in 32-bit words)
+	void pattern(uint32_t const *words,uint32_t nbits)
+	{
+	    for ( ; nbits >= 32 ; nbits -= 32)
+		this->put(*words++,32) ;
+	    if (nbits > 0)
+		this->put(*words >> (32 - nbits),nbits) ;
+	}
+
+	// the same, but the buffer is aligned and nbits is a multiple of W
+	void copy(uint32_t const *words,uint32_t nbits)
+	{
+	    for (uint32_t i=0 ; i<nbits ; i+=W)
+		*this->p++ = static_cast<T>(words[i/32] >> (32 - W - i%32)) ;
+	}
+
+	void flush()
+	{
+	    if (this->n > 0)
+		this->put(0,W - this->n) ;
+	}
+    } ;
+}
+
+Encoder::Encoder(Ticks const &ticks)
+    : ticks(ticks),length(256)
+{
+    auto t0 = ticks.bit_0.hi + ticks.bit_0.lo ;
+    auto t1 = ticks.bit_1.hi + ticks.bit_1.lo ;
+    if (t0 == 0 || t1 == 0)
+	throw std::runtime_error("Ws2812b:Encoder:zero ticks per bit") ;
+    this->maxlen = static_cast<uint32_t>(8 * ((t0 > t1) ? t0 : t1)) ;
+    this->uniform = (t0 == t1) ;
+    this->span = (this->maxlen + 31) / 32 ;
+    this->table.resize(256 * this->span) ;
+    for (unsigned byte=0 ; byte<256 ; ++byte)
+    {
+	Writer<uint32_t> w(&this->table[byte * this->span]) ;
+	for (unsigned mask=0x80 ; mask!=0 ; mask>>=1)
+	{
+	    auto &pulse = (byte & mask) ? ticks.bit_1 : ticks.bit_0 ;
+	    for (size_t i=0 ; i<pulse.hi ; ++i) w.put(1,1) ;
+	    w.zeros(pulse.lo) ;
+	}
+	auto nwords = w.p - &this->table[byte * this->span] ;
+	this->length[byte] = static_cast<uint32_t>(32 * nwords + w.n) ;
+	w.flush() ;
+    }
+}
+
+template<typename T> size_t Encoder::size(size_t nleds) const
+{
+    auto W = 8 * sizeof(T) ;
+    auto nbits = 2 * this->ticks.reset + (W-1) + 3 * nleds * this->maxlen ;
+    return (nbits + W-1) / W + 2 ;
+}
+
+template<typename T> size_t Encoder::encode(uint32_t const *grb,
+					    size_t nleds,
+					    size_t stride,
+					    T *buffer) const
+{
+    Writer<T> w(buffer) ;
+    w.zeros(this->ticks.reset) ;
+    // ...the datasheet doesn't really say how to start a dialogue
+    // (see BitStream::make32)
+    if (this->uniform)
+	w.zeros((Writer<T>::W - w.n) % Writer<T>::W) ;
+    // ...each LED takes the same number of bits: they start on a
+    // word boundary (so the bit-stream can be patched, see Frame)
+    if (this->aligned<T>())
+    {
+	for (size_t i=0 ; i<nleds ; ++i)
+	{
+	    auto v = grb[i * stride] ;
+	    w.copy(&this->table[((v >> 16) & 0xff) * this->span],this->maxlen) ;
+	    w.copy(&this->table[((v >>  8) & 0xff) * this->span],this->maxlen) ;
+	    w.copy(&this->table[((v      ) & 0xff) * this->span],this->maxlen) ;
+	}
+    }
+    else for (size_t i=0 ; i<nleds ; ++i)
+    {
+	auto v = grb[i * stride] ;
+	for (int shift=16 ; shift>=0 ; shift-=8)
+	{
+	    auto byte = (v >> shift) & 0xff ;
+	    w.pattern(&this->table[byte * this->span],this->length[byte]) ;
+	}
+    }
+    w.zeros(this->ticks.reset) ;
+    w.flush() ;
+    // [defect] PWM needs two additional words (extends ticks.reset)
+    *w.p++ = 0 ;
+    *w.p++ = 0 ;
+    return static_cast<size_t>(w.p - buffer) ;
+}
+
+template<typename T> size_t Encoder::group() const
+{
+    size_t W = 8 * sizeof(T) ;
+    size_t n = 1 ;
+    while ((n * this->bits()) % W != 0)
+	++n ;
+    return n ;
+}
+
+template<typename T> size_t Encoder::encodeLeds(uint32_t const *grb,
+						size_t nleds,
+						size_t stride,
+						T *buffer) const
+{
+    Writer<T> w(buffer) ;
+    for (size_t i=0 ; i<nleds ; ++i)
+    {
+	auto v = grb[i * stride] ;
+	for (int shift=16 ; shift>=0 ; shift-=8)
+	{
+	    auto byte = (v >> shift) & 0xff ;
+	    if (this->aligned<T>())
+		w.copy(&this->table[byte * this->span],this->maxlen) ;
+	    else
+		w.pattern(&this->table[byte * this->span],this->length[byte]) ;
+	}
+    }
+    w.flush() ;
+    return static_cast<size_t>(w.p - buffer) ;
+}
+
+template size_t Encoder::size<uint8_t >(size_t) const ;
+template size_t Encoder::size<uint32_t>(size_t) const ;
+
+template size_t Encoder::encode<uint8_t >(uint32_t const*,size_t,size_t,uint8_t *) const ;
+template size_t Encoder::encode<uint32_t>(uint32_t const*,size_t,size_t,uint32_t*) const ;
+
+template size_t Encoder::group<uint8_t >() const ;
+template size_t Encoder::group<uint32_t>() const ;
+
+template size_t Encoder::encodeLeds<uint8_t >(uint32_t const*,size_t,size_t,uint8_t *) const ;
+template size_t Encoder::encodeLeds<uint32_t>(uint32_t const*,size_t,size_t,uint32_t*) const ;
@@ -0,0 +1,87 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// Encodes GRB values into a (packed) bit-stream for the PWM (32-bit
+// words) or the SPI (8-bit words); each tick makes one bit.
+//
+// The bit-pattern of each byte value (0..255) is computed once (when
+// the encoder is constructed). The encoding just appends the patterns
+// of the G, R and B bytes to the caller's buffer.
+//
+// If the 0-bit and the 1-bit take the same number of ticks (which is
+// the normal case) and a byte's pattern fills whole words, the
+// patterns are copied word by word. That's always the case for the
+// SPI; and for the PWM if a bit takes a multiple of 4 ticks. In case
+// of the same number of ticks, the leading reset is extended to a
+// word boundary.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_Device_Ws2812b_Encoder_h
+#define INCLUDE_Device_Ws2812b_Encoder_h
+
+#include "BitStream.h"
+#include <vector>
+
+namespace Device { namespace Ws2812b {
+
+struct Encoder
+{
+    using Ticks = BitStream::Ticks ;
+
+    Encoder(Ticks const &ticks) ;
+
+    // the buffer size (in T words) that is sufficient for a frame of
+    // nleds; T: uint8_t or uint32_t
+    template<typename T> size_t size(size_t nleds) const ;
+
+    // encode a frame to the buffer (of at least size() words) and
+    // return the number of words written. The frame starts and ends
+    // with a reset. grb[i*stride] for each LED i. T: uint8_t or
+    // uint32_t
+    template<typename T> size_t encode(uint32_t const *grb,
+				       size_t nleds,
+				       size_t stride,
+				       T *buffer) const ;
+
+    // true if the patterns are copied word by word (for T)
+    template<typename T> bool aligned() const
+    {
+	return this->uniform && (this->maxlen % (8*sizeof(T)) == 0) ;
+    }
+
+    // ---- piecewise encoding (see Ws2812b::Frame) ----
+
+    // true if each LED takes the same number of bits
+    bool fixed() const { return this->uniform ; }
+
+    // the number of bits of each LED (if fixed)
+    size_t bits() const { return 3 * this->maxlen ; }
+
+    // the least number of LEDs that fill whole T words (if fixed)
+    template<typename T> size_t group() const ;
+
+    // encode the LEDs only (no reset); the last word is padded with
+    // zeros if the LEDs don't fill it
+    template<typename T> size_t encodeLeds(uint32_t const *grb,
+					   size_t nleds,
+					   size_t stride,
+					   T *buffer) const ;
+
+    Ticks const& timing() const { return this->ticks ; }
+
+private:
+
+    Ticks ticks ;
+
+    size_t span ; // number of words per pattern
+
+    std::vector<uint32_t> table ; // [256*span] MSB first, zero padded
+
+    std::vector<uint32_t> length ; // [256] in bits
+
+    uint32_t maxlen ; bool uniform ; // all patterns of the same length
+} ;
+
+} }
+
+#endif // INCLUDE_Device_Ws2812b_Encoder_h
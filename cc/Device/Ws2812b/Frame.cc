@@ -0,0 +1,92 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Frame.h"
+
+namespace Device { namespace Ws2812b {
+
+template<typename T>
+Frame<T>::Frame(Encoder::Ticks const &ticks,size_t nleds)
+    : encoder(ticks),grb(nleds,0),index(0)
+{
+    if (!this->encoder.fixed())
+	throw Error("0-bit and 1-bit must take the same number of ticks") ;
+    size_t W = 8 * sizeof(T) ;
+    this->group = this->encoder.template group<T>() ;
+    this->words = this->group * this->encoder.bits() / W ;
+    this->start = (ticks.reset + W-1) / W ;
+    auto ngroups = (nleds + this->group-1) / this->group ;
+    // ...the last group may be incomplete; its padding (zeros) just
+    // extends the trailing reset
+    auto n = this->encoder.template size<T>(nleds) ;
+    for (auto &b: this->buffer)
+    {
+	b.resize(n) ;
+	b.resize(this->encoder.encode(this->grb.data(),nleds,1,b.data())) ;
+    }
+    this->dirty.resize(ngroups,0) ;
+}
+
+template<typename T>
+void Frame<T>::set(size_t i,uint32_t grb)
+{
+    if (this->grb.at(i) == grb)
+	return ;
+    this->grb[i] = grb ;
+    this->dirty[i / this->group] = 3 ;
+}
+
+template<typename T>
+void Frame<T>::set(size_t i,uint32_t const *grb,size_t n)
+{
+    if (i > this->grb.size() || n > this->grb.size() - i)
+	throw Error("LED index out of range") ;
+    for (size_t j=0 ; j<n ; ++j)
+    {
+	if (this->grb[i+j] == grb[j])
+	    continue ;
+	this->grb[i+j] = grb[j] ;
+	this->dirty[(i+j) / this->group] = 3 ;
+    }
+}
+
+template<typename T>
+size_t Frame<T>::prepare()
+{
+    auto mask = static_cast<uint8_t>(1u << (this->index ^ 1)) ;
+    auto &b = this->buffer[this->index ^ 1] ;
+    auto ngroups = this->dirty.size() ;
+    size_t count = 0 ;
+    size_t g = 0 ;
+    while (g < ngroups)
+    {
+	if (0 == (this->dirty[g] & mask))
+	{
+	    ++g ;
+	    continue ;
+	}
+	// a run of dirty groups is encoded in one go
+	auto first = g ;
+	while (g < ngroups && (this->dirty[g] & mask))
+	    this->dirty[g++] &= static_cast<uint8_t>(~mask) ;
+	auto led = first * this->group ;
+	auto nleds = g * this->group - led ;
+	if (nleds > this->grb.size() - led)
+	    nleds = this->grb.size() - led ;
+	this->encoder.encodeLeds(&this->grb[led],nleds,1,
+				 &b[this->start + first * this->words]) ;
+	count += nleds ;
+    }
+    return count ;
+}
+
+template<typename T>
+std::vector<T> const& Frame<T>::swap()
+{
+    this->index ^= 1 ;
+    return this->buffer[this->index] ;
+}
+
+template struct Frame<uint8_t > ;
+template struct Frame<uint32_t> ;
+
+} }
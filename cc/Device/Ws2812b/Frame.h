@@ -0,0 +1,72 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// A WS2812B chain whose encoded bit-stream is kept between frames.
+//
+// The GRB values are set individually. Only the LEDs that changed are
+// encoded again (in groups of LEDs that fill whole words, see
+// Encoder::group()). There are two buffers: while the front buffer
+// is sent, the next frame is encoded into the back buffer; swap()
+// exchanges them.
+//
+// The layout of a buffer is the same as Encoder::encode() produces:
+// a reset (extended to a word boundary), the LEDs, a reset and two
+// zero-words. Only a timing with the same number of ticks for the
+// 0-bit and the 1-bit is supported (Encoder::fixed()).
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_Device_Ws2812b_Frame_h
+#define INCLUDE_Device_Ws2812b_Frame_h
+
+#include "Encoder.h"
+#include <Neat/Error.h>
+
+namespace Device { namespace Ws2812b {
+
+template<typename T> struct Frame // T: uint32_t (PWM) or uint8_t (SPI)
+{
+    struct Error : Neat::Error
+    {
+	Error(std::string const &s) : Neat::Error("Device:Ws2812b:Frame:" + s) {}
+    } ;
+
+    Frame(Encoder::Ticks const &ticks,size_t nleds) ;
+    // ...all LEDs are set to zero (in both buffers)
+
+    size_t size() const { return this->grb.size() ; }
+
+    uint32_t get(size_t i) const { return this->grb.at(i) ; }
+
+    void set(size_t i,uint32_t grb) ;
+
+    // set n LEDs starting at i
+    void set(size_t i,uint32_t const *grb,size_t n) ;
+
+    // encode the LEDs that changed since the back buffer was prepared
+    // the last time; returns the number of LEDs encoded
+    size_t prepare() ;
+
+    // make the back buffer the front buffer (and vice versa) and
+    // return the (new) front buffer to be sent
+    std::vector<T> const& swap() ;
+
+    std::vector<T> const& front() const { return this->buffer[this->index] ; }
+
+private:
+
+    Encoder encoder ;
+
+    std::vector<uint32_t> grb ;
+
+    size_t group ; // number of LEDs per group
+    size_t words ; // number of words per group
+    size_t start ; // word offset of the first LED
+
+    std::vector<T> buffer[2] ; unsigned index ; // of the front buffer
+
+    std::vector<uint8_t> dirty ; // per group: bit i for buffer i
+} ;
+
+} }
+
+#endif // INCLUDE_Device_Ws2812b_Frame_h
@@ -0,0 +1,65 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Parallel.h"
+#include <Neat/Bit/Transpose.h>
+
+using Parallel = Device::Ws2812b::Parallel ;
+
+Parallel::Parallel(std::vector<Strip> const &strips,Circuit::Ticks const &ticks)
+    : strips(strips),ticks(ticks),all(0),nleds(0)
+    , phase(0),i(0),bit(0),active(0)
+{
+    for (auto &strip: strips)
+    {
+	auto mask = 1u << strip.pin.value() ;
+	if (this->all & mask)
+	    throw Error("pin used twice") ;
+	this->all |= mask ;
+	if (this->nleds < strip.nleds)
+	    this->nleds = strip.nleds ;
+    }
+    
+    // the 1-bit's High-level, after the 0-bit's falling edge; the
+    // 0-bit's edge may come anywhere in t0h_min..t0h_max, so the 1-bit
+    // has to meet its window for both ends
+    auto sub = [](uint32_t a,uint32_t b) { return (a > b) ? a - b : 0u ; } ;
+    if (ticks.t1h_max < ticks.t0h_max ||
+	sub(ticks.t1h_min,ticks.t0h_min) > ticks.t1h_max - ticks.t0h_max)
+	throw Error("1-bit's High-level can't be timed after the 0-bit's") ;
+    this->h1 = std::make_pair(sub(ticks.t1h_min,ticks.t0h_min),
+			      ticks.t1h_max - ticks.t0h_max) ;
+    // the next Low-level, after the 1-bit's falling edge; the 0-bit
+    // is already low for the difference of both High-levels, which
+    // is anywhere in h1: the shortest one bounds the minimum and the
+    // longest one the maximum
+    auto lo_min = ticks.t1l_min ;
+    if (lo_min < sub(ticks.t0l_min,this->h1.first))
+	lo_min = sub(ticks.t0l_min,this->h1.first) ;
+    auto lo_max = ticks.t1l_max ;
+    if (lo_max > sub(ticks.t0l_max,this->h1.second))
+	lo_max = sub(ticks.t0l_max,this->h1.second) ;
+    if (lo_min > lo_max)
+	throw Error("timing can't be met for both bit types") ;
+    this->lo_next = std::make_pair(lo_min,lo_max) ;
+    this->lo = std::make_pair(ticks.res_min,~0u) ; // after the reset
+    
+    for (auto &mask: this->slot)
+	mask = 0 ;
+}
+
+void Parallel::load()
+{
+    uint32_t a[32] = { 0 } ;
+    this->active = 0 ;
+    for (auto &strip: this->strips)
+    {
+	if (this->i >= strip.nleds)
+	    continue ;
+	a[strip.pin.value()] = strip.grb[this->i * strip.stride] & 0xffffff ;
+	this->active |= 1u << strip.pin.value() ;
+    }
+    Neat::Bit::transpose(a) ;
+    // ...a[b] holds bit b of all strips (by pin)
+    for (unsigned b=0 ; b<24 ; ++b)
+	this->slot[b] = a[b] ;
+}
@@ -0,0 +1,130 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// Generates the edges for up to 32 WS2812B chains (strips) at once;
+// each on its own pin, each with its own data. The edges are meant
+// for RpiExt::Serialize::pull or RpiExt::Waveform::addAll.
+//
+// A bit-slot takes three edges (for all strips at once):
+// * the rising edge of all strips that have an LED at this position
+// * the falling edge of the strips that send a 0-bit
+// * the falling edge of the strips that send a 1-bit
+//
+// The masks are taken from a 32x32 bit-transposition of the GRB
+// values of all strips at the same LED position (i.e. per LED, not
+// per edge). Strips with fewer LEDs just drop out.
+//
+// The edges are timed as if each one is set at its minimum time. The
+// 1-bit's falling edge is timed relative to the 0-bit's one; and the
+// next rising edge must meet the Low-level of both bit types.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_Device_Ws2812b_Parallel_h
+#define INCLUDE_Device_Ws2812b_Parallel_h
+
+#include "Circuit.h"
+#include <Neat/Error.h>
+#include <Rpi/Pin.h>
+#include <RpiExt/Serialize.h>
+#include <vector>
+
+namespace Device { namespace Ws2812b {
+
+struct Parallel
+{
+    struct Error : Neat::Error
+    {
+	Error(std::string const &s) : Neat::Error("Device:Ws2812b:Parallel:" + s) {}
+    } ;
+
+    using Edge = RpiExt::Serialize::Edge ;
+
+    struct Strip
+    {
+	Rpi::Pin pin ;
+	uint32_t const *grb ; size_t nleds,stride ; // see Edges
+	Strip(Rpi::Pin pin,uint32_t const *grb,size_t nleds,size_t stride=1)
+	    : pin(pin),grb(grb),nleds(nleds),stride(stride) {}
+    } ;
+
+    // the arrays must stay valid during the transfer
+    Parallel(std::vector<Strip> const &strips,Circuit::Ticks const &ticks) ;
+
+    bool operator()(Edge *edge)
+    {
+	auto const Lo = Rpi::Register::Gpio::Output::Level::Lo ;
+	auto const Hi = Rpi::Register::Gpio::Output::Level::Hi ;
+	switch (this->phase)
+	{
+	case 0: // [debugging] make start visible in analyser
+	    (*edge) = Edge(this->all,10,~0u,Lo) ; ++this->phase ; return true ;
+	case 1:
+	    (*edge) = Edge(this->all,10,~0u,Hi) ; ++this->phase ; return true ;
+	case 2: // reset
+	    (*edge) = Edge(this->all,10,~0u,Lo) ; ++this->phase ;
+	    this->bit = 0 ;
+	    return true ;
+	case 3: // the rising edge of all active strips
+	    if (this->bit == 0)
+	    {
+		if (this->i == this->nleds)
+		{
+		    (*edge) = Edge(this->all,this->ticks.res_min,~0u,Lo) ;
+		    this->phase = 6 ;
+		    return true ;
+		}
+		this->load() ;
+		this->bit = 24 ;
+	    }
+	    --this->bit ;
+	    (*edge) = Edge(this->active,this->lo.first,this->lo.second,Hi) ;
+	    this->lo = this->lo_next ;
+	    this->phase = 4 ;
+	    return true ;
+	case 4: // the falling edge of the 0-bits
+	    (*edge) = Edge(this->active & ~this->slot[this->bit],
+			   this->ticks.t0h_min,this->ticks.t0h_max,Lo) ;
+	    this->phase = 5 ;
+	    return true ;
+	case 5: // the falling edge of the 1-bits
+	    (*edge) = Edge(this->slot[this->bit],
+			   this->h1.first,this->h1.second,Lo) ;
+	    if (this->bit == 0)
+		++this->i ;
+	    this->phase = 3 ;
+	    return true ;
+	}
+	return false ;
+    }
+
+    // the number of edges in total
+    size_t size() const { return 4 + 72 * this->nleds ; }
+
+    // the pins of all strips
+    uint32_t pins() const { return this->all ; }
+
+private:
+
+    std::vector<Strip> strips ; Circuit::Ticks ticks ;
+
+    uint32_t all ; size_t nleds ; // the longest strip
+
+    std::pair<uint32_t,uint32_t> h1 ; // 1-bit: after the 0-bit's falling edge
+    std::pair<uint32_t,uint32_t> lo ; // the current Low-level
+    std::pair<uint32_t,uint32_t> lo_next ; // the following Low-levels
+
+    unsigned phase ; // see operator()
+
+    size_t i ; unsigned bit ; // the current LED and bit
+
+    uint32_t active ; // the strips with an i-th LED
+
+    uint32_t slot[32] ; // per bit: the strips that send a 1-bit
+
+    // compute the masks of the i-th LED
+    void load() ;
+} ;
+
+} }
+
+#endif // INCLUDE_Device_Ws2812b_Parallel_h
@@ -0,0 +1,19 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Transpose.h"
+
+void Neat::Bit::transpose(uint32_t (&a)[32])
+{
+    // swap the off-diagonal blocks: 16x16, then 8x8, ..., then 1x1
+    // [see Hacker's Delight, 7-3; here for LSB-first columns]
+    uint32_t m = 0x0000ffff ;
+    for (unsigned j=16 ; j!=0 ; j>>=1,m^=(m<<j))
+    {
+	for (unsigned k=0 ; k<32 ; k=((k|j)+1) & ~j)
+	{
+	    auto t = ((a[k] >> j) ^ a[k|j]) & m ;
+	    a[k]   ^= t << j ;
+	    a[k|j] ^= t ;
+	}
+    }
+}
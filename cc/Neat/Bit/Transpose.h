@@ -0,0 +1,17 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#ifndef INCLUDE_Neat_Bit_Transpose_h
+#define INCLUDE_Neat_Bit_Transpose_h
+
+#include <cinttypes>
+
+namespace Neat { namespace Bit {
+
+void transpose(uint32_t (&a)[32]) ;
+// ...the 32x32 bit-matrix in place: bit j of a[i] becomes bit i of
+// a[j] (bit 0 is the LSB). E.g. if a[i] holds the i-th level sample
+// of all GPIO pins, a[j] holds all the samples of pin j.
+    
+} }
+
+#endif // INCLUDE_Neat_Bit_Transpose_h
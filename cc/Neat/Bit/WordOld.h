@@ -72,7 +72,7 @@ template<typename U,U M> struct WordOld
 
 	static_assert(Mask == (Mask & WordOld::Mask),"doesn't match") ;
 	
-	static constexpr auto Digit = WordOld::Digit::template make<Offset>() ;
+	static constexpr typename WordOld::Digit Digit = WordOld::Digit::template make<Offset>() ;
 
 	constexpr Bit(WordOld w) : i(w.i & Mask) {}
 
@@ -150,6 +150,11 @@ private:
 
     Unsigned i ; constexpr WordOld(Unsigned i) : i(i) {}
 
-} ; } }
+} ;
+
+template<typename U,U M> template<unsigned O>
+constexpr typename WordOld<U,M>::Digit WordOld<U,M>::Bit<O>::Digit ;
+
+} }
 
 #endif // INCLUDE_Neat_Bit_WordOld_h
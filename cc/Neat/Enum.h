@@ -62,7 +62,7 @@ template<typename D,D M> struct Enum<D,M,false>
     }
 
     template<typename D2>
-    static Enum make(D2 i) { return Enum(Enum<D2,max>::make(i)) ; }
+    static Enum make(D2 i) { return Enum(static_cast<Domain>(Enum<D2,max>::make(i).value())) ; }
 
     // ---- access ----
     
@@ -109,7 +109,7 @@ template<typename D,D M> struct Enum<D,M,true>
     static Enum make(Domain i) { return Enum(i) ; }
 
     template<typename D2>
-    static Enum make(D2 i) { return Enum(Enum<D2,max>::make(i)) ; }
+    static Enum make(D2 i) { return Enum(static_cast<Domain>(Enum<D2,max>::make(i).value())) ; }
 
     // ---- access ----
     
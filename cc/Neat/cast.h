@@ -66,6 +66,9 @@ namespace Neat
   // [todo] make compile time checked
   template<> inline   signed long promote<  signed long,  signed int>(  signed int i) { return i ; }
   template<> inline unsigned long promote<unsigned long,unsigned int>(unsigned int i) { return i ; }
+  template<> inline   signed long promote<  signed long,  signed long>(  signed long i) { return i ; }
+  template<> inline unsigned long promote<unsigned long,unsigned long>(unsigned long i) { return i ; }
+  // ...LP64 build hosts where size_t is already unsigned long
 
   template<typename T,typename F> T demote(F f) ;
   // [todo] make compile time checked
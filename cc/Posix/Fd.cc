@@ -6,10 +6,12 @@
 #include <Neat/cast.h>
 
 #include <cassert>
+#include <cstdio> // P_tmpdir
+#include <cstdlib> // mkstemp()
 #include <sstream>
 
 #include <sys/ioctl.h> 
-#include <unistd.h> // open(),read(),close()
+#include <unistd.h> // open(),read(),close(),ftruncate(),unlink()
 
 void Posix::Fd::ioctl(unsigned long request,void *arg)
 {
@@ -45,6 +47,24 @@ Posix::Fd::shared_ptr Posix::Fd::create(char const path[])
   return shared_ptr(new Fd(i,std::string(path))) ;
 }
 
+Posix::Fd::shared_ptr Posix::Fd::temporary()
+{
+  std::string path = P_tmpdir "/rpio-XXXXXX" ;
+  auto i = ::mkstemp(&path[0]) ;
+  if (i < 0) {
+    std::ostringstream os ;
+    os << "mkstemp(" << path << "):" << strerror(errno) ;
+    throw Error(os.str()) ;
+  }
+  auto fd = shared_ptr(new Fd(i,path)) ;
+  if (0 != ::unlink(path.c_str())) {
+    std::ostringstream os ;
+    os << "unlink(" << path << "):" << strerror(errno) ;
+    throw Error(os.str()) ;
+  }
+  return fd ;
+}
+
 Posix::Fd::ussize_t Posix::Fd::read(void *buf,ussize_t count)
 {
   // we use ussize_t since read(2) returns a non-negative ssize_t
@@ -96,6 +116,16 @@ Posix::Fd::uoff_t Posix::Fd::size()
   return end ;
 }
 
+void Posix::Fd::truncate(uoff_t length)
+{
+  auto result = ::ftruncate(this->i,length.as_signed()) ;
+  if (result != 0) {
+    std::ostringstream os ;
+    os << "ftruncate(" << this->path << ',' << length.as_signed() << "):" << strerror(errno) ;
+    throw Error(os.str()) ;
+  }
+}
+
 Posix::Fd::~Fd()
 {
   auto result = close(i) ;
@@ -29,12 +29,18 @@ namespace Posix
 
     static shared_ptr create(char const path[]) ; 
 
+    static shared_ptr temporary() ;
+    // ...an unlinked read-write file (in P_tmpdir)
+
     enum class Lseek : int { Begin=SEEK_SET,Current=SEEK_CUR,End=SEEK_END } ;
 
     uoff_t lseek(off_t ofs,Lseek mode) ;
     
     uoff_t size() ;
     // ...determined by lseek(0,End) whereby original position is recovered
+
+    void truncate(uoff_t length) ;
+    // ...see ftruncate(2); a file that grows is filled with zeros
     
     ussize_t read(void *buf,ussize_t count) ;
     // ...[todo] shouldn't compile if WO
@@ -2,4 +2,10 @@
 
 #include "Master.h"
 
-// empty on purpose
+using Rom = Protocol::OneWire::Bang::Rom ;
+
+constexpr std::bitset<8> Rom::AlarmSearch ;
+constexpr std::bitset<8> Rom::MatchRom ;
+constexpr std::bitset<8> Rom::ReadRom ;
+constexpr std::bitset<8> Rom::SearchRom ;
+constexpr std::bitset<8> Rom::SkipRom ;
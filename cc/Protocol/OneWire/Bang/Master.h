@@ -5,42 +5,71 @@
 
 #include "Timing.h"
 #include <bitset>
+#include <boost/optional.hpp>
 #include <Rpi/Intr.h>
 #include <RpiExt/BangIo.h>
 
 namespace Protocol { namespace OneWire { namespace Bang { 
 
-struct Master
+struct Rom
 {
     static constexpr auto AlarmSearch = std::bitset<8>(0xec) ;
     static constexpr auto MatchRom    = std::bitset<8>(0x55) ; 
     static constexpr auto ReadRom     = std::bitset<8>(0x33) ; 
     static constexpr auto SearchRom   = std::bitset<8>(0xf0) ; 
     static constexpr auto SkipRom     = std::bitset<8>(0xcc) ; 
-    
-    Master(
-	Rpi::Peripheral *rpi,
+} ;
+
+template<typename Io> class BasicSignaling ;
+
+// Io is the bus backend: RpiExt::BangIo or RpiExt::Sim::Io
+template<typename Io> struct BasicMaster : Rom
+{
+    BasicMaster(
+	Io const &io,
 	Rpi::Pin pin,
-	Timing::Template<uint32_t> const& timing)
+	Timing::Template<uint32_t> const& timing,
+	boost::optional<Rpi::Intr> const &intr = boost::none)
 
-	: intr              (rpi)
-	, io                (rpi)
+	: intr             (intr)
+	, io                 (io)
 	, pin               (pin)
 	, mask(1u << pin.value())
+	, out(pin,Rpi::Gpio::Function::Type::Out)
+	, in (pin,Rpi::Gpio::Function::Type:: In)
 	, timing         (timing) {}
 
+    // track the gaps between the counter reads of the time-slots (see
+    // BangIo::monitor); a slot that exceeds the bound throws Retry
+    void monitor(RpiExt::Jitter *jitter)
+    {
+	this->io.monitor(jitter) ;
+    }
+
 private:
 
-    friend class Signaling ;
+    friend class BasicSignaling<Io> ;
 
-    Rpi::Intr intr ;
+    boost::optional<Rpi::Intr> intr ; // to disable (see Signaling.cc)
 
-    RpiExt::BangIo io ;
+    Io io ;
 
     Rpi::Pin pin ; uint32_t mask ;
 
+    Rpi::Gpio::Function::Update out,in ; // open-drain: Low or Off
+
     Timing::Template<uint32_t> timing ;
+} ;
+
+struct Master : BasicMaster<RpiExt::BangIo>
+{
+    Master(
+	Rpi::Peripheral *rpi,
+	Rpi::Pin pin,
+	Timing::Template<uint32_t> const& timing)
 
+	: BasicMaster(RpiExt::BangIo(rpi),pin,timing,Rpi::Intr(rpi)) {}
+    
 } ; } } }
 
 #endif // INCLUDE_Protocol_OneWire_Bang_Master_h
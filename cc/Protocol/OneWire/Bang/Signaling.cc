@@ -2,6 +2,7 @@
 
 #include "Error.h"
 #include "Signaling.h"
+#include <RpiExt/Sim/Io.h>
 
 using namespace Protocol::OneWire::Bang ;
 
@@ -11,7 +12,7 @@ using namespace Protocol::OneWire::Bang ;
 // don't disable interrupts anymore since the problem does no longer
 // occur.
 
-bool Signaling::init()
+template<typename Io> bool BasicSignaling<Io>::init()
 {
     //  t0 t1 t2 t3 t4 t5 t6 t7
     // ---+     +-----+     +----...
@@ -19,14 +20,19 @@ bool Signaling::init()
     //    +-----+     +-----+
     
     // Reset-Pulse
-    this->master->io.mode(this->master->pin,Rpi::Gpio::Function::Type::Out) ;
+    this->master->io.resume() ; // ...a retry starts here
+    this->master->io.mode(this->master->out) ;
     // ...assumes the configured output level is Low
     // ...note, errors must not be thrown as long as Out or Events enabled
     this->master->io.sleep(this->master->timing.resetPulse_min) ;
     // ...[todo] this may be a good time to voluntary suspend the thread
 #if DEFECT_D1    
-    auto v = this->master->intr.status() ;
-    this->master->intr.disable(v) ;
+    boost::optional<Rpi::Intr::Vector> v ;
+    if (this->master->intr) // ...none on a virtual bus
+    {
+	v = this->master->intr->status() ;
+	this->master->intr->disable(*v) ;
+    }
 #endif    
     this->master->io.detect(this->master->pin,Rpi::Register::Gpio::Event::Type::Fall) ;
     // [defect] The event status flag gets immediately* raised regardless
@@ -36,7 +42,7 @@ bool Signaling::init()
     // AsyncFall mostly in the immediate query (and not later).
     this->master->io.events(this->master->mask) ;
     auto t2 = this->master->io.recent() ;
-    this->master->io.mode(this->master->pin,Rpi::Gpio::Function::Type::In) ;
+    this->master->io.mode(this->master->in) ;
     auto t3 = this->master->io.time() ;
     // ...if we got suspended, t3 and following time-stamps may lay
     // even behind the end of the Presence-Pulse (if there was any)
@@ -50,7 +56,8 @@ bool Signaling::init()
 			    Rpi::Register::Gpio::Event::Type::Fall,false) ;
     this->master->io.events(this->master->mask) ; // reset late events
 #if DEFECT_D1
-    this->master->intr.enable(v) ;
+    if (v)
+	this->master->intr->enable(*v) ;
 #endif
     if (isPresent)
     {
@@ -71,11 +78,13 @@ bool Signaling::init()
     
     // end of init. sequence
     this->master->io.wait(t3,this->master->timing.presenceFrame_max) ;
+    if (this->master->io.preempted()) 
+	throw Error(Error::Type::Retry,__LINE__) ;
 
     return isPresent ;
 }
 
-bool Signaling::read(bool busy)
+template<typename Io> bool BasicSignaling<Io>::read(bool busy)
 {
     //  t0 t1 t2 t3 t4 t5
     // ---+     +-----+---
@@ -84,13 +93,13 @@ bool Signaling::read(bool busy)
 
     // initiate Read-Time-Slot
     auto t0 = this->master->io.time() ; 
-    this->master->io.mode(this->master->pin,Rpi::Gpio::Function::Type::Out) ;
+    this->master->io.mode(this->master->out) ;
     auto t1 = this->master->io.time() ; 
     this->master->io.wait(t1,this->master->timing.init_min) ;
     // the device keeps holding the wire low in order to "send" a
     // 0-bit; there is no LH-HL gap as long as the pulse to initiate
     // the Read-Time-Slot is long enough
-    this->master->io.mode(this->master->pin,Rpi::Gpio::Function::Type::In) ;
+    this->master->io.mode(this->master->in) ;
     this->master->io.sleep(this->master->timing.rc_max) ;
     auto sample_t3 = 0 != (this->master->mask & this->master->io.levels()) ;
     auto t3 = this->master->io.time() ; 
@@ -117,10 +126,12 @@ bool Signaling::read(bool busy)
 	throw Error(Error::Type::Retry,__LINE__) ;
     // wait for end of time-slot period
     this->master->io.wait(t1,this->master->timing.slot_min) ;
+    if (this->master->io.preempted()) 
+	throw Error(Error::Type::Retry,__LINE__) ;
     return sample_t3 ;
 }
 
-void Signaling::write(bool bit) 
+template<typename Io> void BasicSignaling<Io>::write(bool bit)
 {
     //  t0 t1 t2 t3
     // ---+     +---
@@ -129,19 +140,27 @@ void Signaling::write(bool bit)
 
     // tx: short or long Bit Pulse
     auto t0 = this->master->io.time() ;
-    this->master->io.mode(this->master->pin,Rpi::Gpio::Function::Type::Out) ;
+    this->master->io.mode(this->master->out) ;
     auto t1 = this->master->io.time() ;
     auto min = bit
 	? this->master->timing.write_1_min
 	: this->master->timing.write_0_min ;
     this->master->io.wait(t1,min) ; 
-    this->master->io.mode(this->master->pin,Rpi::Gpio::Function::Type::In) ;
+    this->master->io.mode(this->master->in) ;
     auto t3 = this->master->io.time() ; 
     auto max = bit
 	? this->master->timing.write_1_max
 	: this->master->timing.write_0_max ;
     if (t3 - t0 > max) 
 	throw Error(Error::Type::Retry,__LINE__) ;
-    // wait for end of time-slot period
+    // wait for end of time-slot period and the recovery time
     this->master->io.wait(t1,this->master->timing.slot_min) ;
+    this->master->io.wait(t3,this->master->timing.rec_min) ;
+    if (this->master->io.preempted()) 
+	throw Error(Error::Type::Retry,__LINE__) ;
+    // ...the busy-waits return early if the jitter bound is exceeded
+    // (see BangIo::monitor); that is, the slot timing is corrupt
 }
+
+template class Protocol::OneWire::Bang::BasicSignaling<RpiExt::BangIo> ;
+template class Protocol::OneWire::Bang::BasicSignaling<RpiExt::Sim::Io> ;
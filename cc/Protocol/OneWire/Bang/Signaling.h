@@ -7,8 +7,10 @@
 
 namespace Protocol { namespace OneWire { namespace Bang { 
 
-struct Signaling
+template<typename Io> class BasicSignaling
 {
+public:
+
     // reset the bus and return the presence pulse (if any)
     bool init() ;
 
@@ -37,14 +39,18 @@ struct Signaling
 	    this->write(set[i]) ;
     }
     
-    Signaling(Master *master) : master(master) {}
+    BasicSignaling(BasicMaster<Io> *master) : master(master) {}
 
 private:
 
     bool read(bool busy) ;
 
-    Master *master ;
+    BasicMaster<Io> *master ;
+} ;
 
-} ; } } }
+using Signaling = BasicSignaling<RpiExt::BangIo> ;
+// ...the one on a virtual bus is BasicSignaling<RpiExt::Sim::Io>
+    
+} } }
 
 #endif // INCLUDE_Protocol_OneWire_Bang_Signaling_h
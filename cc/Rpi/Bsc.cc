@@ -0,0 +1,110 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Bsc.h"
+#include "ArmTimer.h"
+
+static Rpi::Peripheral::PNo pno(Rpi::Bsc::Index i)
+{
+    if (i.value() == 0)
+	return Rpi::Peripheral::PNo::make<0x205>() ;
+    return Rpi::Peripheral::PNo::make<0x804>() ;
+}
+
+Rpi::Bsc::Bsc(Peripheral *p,Index i)
+    : page(p->page(pno(i))),counter(ArmTimer(p).counter().p) {}
+
+uint16_t Rpi::Bsc::getDivider() const
+{
+    return static_cast<uint16_t>(this->page->at<0x14/4>()) ;
+}
+
+void Rpi::Bsc::setDivider(uint16_t i)
+{
+    this->page->at<0x14/4>() = i ;
+}
+
+uint32_t Rpi::Bsc::execute(Transfer *transfer,size_t n,uint32_t timeout)
+{
+    uint32_t status = 0 ;
+    for (auto t=transfer ; t!=transfer+n ; ++t)
+	status |= this->run(t,timeout) ;
+    return status ;
+}
+
+uint32_t Rpi::Bsc::run(Transfer *t,uint32_t timeout)
+{
+    if (t->ntx > 16)
+	throw Error("Bsc:transfer exceeds FIFO size") ;
+
+    auto t0 = (*this->counter) ;
+    auto check = [this,t0,timeout]
+    {
+	if ((*this->counter) - t0 > timeout)
+	    throw Error("Bsc:transfer timed out") ;
+    } ;
+    // ...called by each busy-wait
+
+    // reset
+    this->setControl(I2cen | Clear) ;
+    this->setStatus(this->getStatus() & (Clkt | Err | Done)) ;
+    // ...only the flags that are set (write 1 to clear)
+    this->setAddr(t->addr) ;
+
+    // write (the whole data fits into the FIFO)
+    if (t->ntx > 0 || t->nrx == 0)
+    {
+	this->setDlen(static_cast<uint16_t>(t->ntx)) ;
+	for (size_t i=0 ; i<t->ntx ; ++i)
+	    this->write(t->tx[i]) ;
+	this->setControl(I2cen | St) ;
+	if (t->nrx > 0)
+	{
+	    // wait until the write is underway: a read that is
+	    // started now follows with a repeated START
+	    while (0 == (this->getStatus() & (Ta | Done | Err | Clkt)))
+		check() ;
+	}
+	else
+	{
+	    while (0 == (this->getStatus() & (Done | Err | Clkt)))
+		check() ;
+	}
+    }
+
+    // read
+    uint32_t incomplete = 0 ;
+    if (t->nrx > 0 && 0 == (this->getStatus() & (Err | Clkt)))
+    {
+	this->setStatus(Done) ;
+	// ...in case the write completed already (see header)
+	this->setDlen(static_cast<uint16_t>(t->nrx)) ;
+	this->setControl(I2cen | St | Read) ;
+	while (0 == (this->getStatus() & (Ta | Rxd | Err | Clkt)))
+	    check() ;
+	// ...the read is underway: DONE (w/o TA) signals its end now
+	size_t i = 0 ;
+	while (i < t->nrx)
+	{
+	    auto status = this->getStatus() ;
+	    if (0 != (status & Rxd))
+		t->rx[i++] = this->read() ;
+	    else if (0 != (status & (Err | Clkt)))
+		break ;
+	    else if (0 != (status & Done) && 0 == (status & Ta))
+		break ;
+	    else check() ;
+	    // ...since the FIFO is drained along, there is no limit
+	    //    for the number of bytes to read
+	}
+	while (Ta == (this->getStatus() & (Ta | Err | Clkt)))
+	    check() ;
+	if (i != t->nrx)
+	    incomplete = Incomplete ;
+	// ...e.g. a stale DONE of the write: the rx buffer isn't valid
+    }
+
+    auto status = this->getStatus() ;
+    this->setStatus(status & (Clkt | Err | Done)) ;
+    t->status = (status & (Err | Clkt)) | incomplete ;
+    return t->status ;
+}
@@ -0,0 +1,216 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#ifndef INCLUDE_Rpi_Bsc_h
+#define INCLUDE_Rpi_Bsc_h
+
+// --------------------------------------------------------------------
+//
+// Broadcom Serial Controller (BSC) -- I2C Master
+//
+// See BCM2835 ARM Peripherals: chapter 3
+//
+// BSC0 is at page 0x205, BSC1 at page 0x804. (BSC2 at page 0x805 is
+// dedicated to HDMI and not covered here.) The pins have to be set
+// up beforehand: e.g. GPIO 2+3 (alt-0) for BSC1.
+//
+// --------------------------------------------------------------------
+//
+// Short Description
+//
+// A transfer is set up by the slave address (A), the number of bytes
+// (DLEN) and the direction (C.READ); it is started by C.ST. The
+// controller generates START, the address byte, the data bytes (to/
+// from the FIFO) and STOP by itself. The FIFO is 16 bytes deep and is
+// used for both directions. There is a single transfer at a time.
+//
+// The SCL frequency is core-clock / CDIV (the core-clock is normally
+// 250 MHz). CDIV is rounded down to an even number; zero stands for
+// 32768. The default is 0x5dc (1500: 166 kHz).
+//
+// --------------------------------------------------------------------
+//
+// Combined write-read transfer (repeated START)
+//
+// The controller doesn't support repeated STARTs by itself. However,
+// if a new transfer is started (C.ST) while the current one is still
+// active (S.TA) the controller issues a repeated START instead of a
+// STOP when the current transfer ends. So a register is read by: (1)
+// a write transfer of the register's address, (2) poll S.TA, (3) a
+// read transfer that is started before the write transfer completes.
+//
+// If the process is suspended between (2) and (3) for longer than the
+// write transfer takes, the controller issues a STOP and the read is
+// done as a separate transfer (with a START). This is fine for most
+// devices (which keep the register address) but not for all of them.
+//
+// --------------------------------------------------------------------
+
+#include "Peripheral.h"
+#include <Neat/Enum.h>
+
+namespace Rpi {
+
+struct Bsc
+{
+  using Index = Neat::Enum<unsigned,1> ; // 0:BSC0 1:BSC1
+
+  Bsc(Peripheral *p,Index i) ;
+
+  // control (C) register @ 0x0
+
+  enum : uint32_t
+  {
+    Read  = (1u <<  0), // RW read transfer (else write)
+    Clear = (3u <<  4), // WO clear the FIFO
+    St    = (1u <<  7), // WO start transfer
+    Intd  = (1u <<  8), // RW interrupt on done
+    Intt  = (1u <<  9), // RW interrupt on TX
+    Intr  = (1u << 10), // RW interrupt on RX
+    I2cen = (1u << 15), // RW I2C enable
+  } ;
+
+  uint32_t getControl() const
+  {
+    return this->page->at<0x0/4>() ;
+  }
+
+  void setControl(uint32_t w)
+  {
+    this->page->at<0x0/4>() = w ;
+  }
+
+  // status (S) register @ 0x4
+
+  enum : uint32_t
+  {
+    Ta    = (1u << 0), // RO transfer active
+    Done  = (1u << 1), // RC transfer done (write 1 to clear)
+    Txw   = (1u << 2), // RO FIFO is less than full and a write is underway
+    Rxr   = (1u << 3), // RO FIFO is or more full and a read is underway
+    Txd   = (1u << 4), // RO FIFO can accept data
+    Rxd   = (1u << 5), // RO FIFO contains data
+    Txe   = (1u << 6), // RO FIFO is empty
+    Rxf   = (1u << 7), // RO FIFO is full
+    Err   = (1u << 8), // RC slave address not acknowledged
+    Clkt  = (1u << 9), // RC slave held SCL down too long (see CLKT)
+  } ;
+
+  enum : uint32_t
+  {
+    Incomplete = (1u << 31), // not a register bit: fewer bytes read than requested
+  } ;
+
+  uint32_t getStatus() const
+  {
+    return this->page->at<0x4/4>() ;
+  }
+
+  void setStatus(uint32_t w)
+  {
+    this->page->at<0x4/4>() = w ;
+  }
+
+  // data length (DLEN) register @ 0x8
+
+  uint16_t getDlen() const
+  {
+    return static_cast<uint16_t>(this->page->at<0x8/4>()) ;
+  }
+
+  void setDlen(uint16_t i)
+  {
+    this->page->at<0x8/4>() = i ;
+  }
+
+  // slave address (A) register @ 0xc
+
+  using Addr = Neat::Enum<unsigned,0x7f> ;
+
+  Addr getAddr() const
+  {
+    return Addr::coset(this->page->at<0xc/4>()) ;
+  }
+
+  void setAddr(Addr a)
+  {
+    this->page->at<0xc/4>() = a.value() ;
+  }
+
+  // data FIFO register @ 0x10
+
+  uint8_t read()
+  {
+    return static_cast<uint8_t>(this->page->at<0x10/4>()) ;
+  }
+
+  void write(uint8_t byte)
+  {
+    this->page->at<0x10/4>() = byte ;
+  }
+
+  // clock divider (DIV) register @ 0x14
+
+  uint16_t getDivider() const ;
+
+  void setDivider(uint16_t) ;
+
+  // data delay (DEL) register @ 0x18: falling and rising edge delay
+  // (in core-clock cycles) before the data is sampled/changed
+
+  uint32_t getDelay() const
+  {
+    return this->page->at<0x18/4>() ;
+  }
+
+  void setDelay(uint32_t w)
+  {
+    this->page->at<0x18/4>() = w ;
+  }
+
+  // clock stretch timeout (CLKT) register @ 0x1c (in SCL cycles; zero
+  // disables the timeout)
+
+  uint16_t getTimeout() const
+  {
+    return static_cast<uint16_t>(this->page->at<0x1c/4>()) ;
+  }
+
+  void setTimeout(uint16_t i)
+  {
+    this->page->at<0x1c/4>() = i ;
+  }
+
+  // helper: run transfers by polling in a busy loop
+
+  struct Transfer
+  {
+    Addr addr ;
+    uint8_t const *tx ; size_t ntx ; // 0..16 bytes to write first...
+    uint8_t       *rx ; size_t nrx ; // ...then the bytes to read
+    uint32_t status ; // Err|Clkt|Incomplete: set by execute(); zero on success
+
+    Transfer(Addr addr,uint8_t const *tx,size_t ntx,uint8_t *rx,size_t nrx)
+	: addr(addr),tx(tx),ntx(ntx),rx(rx),nrx(nrx),status(0) {}
+  } ;
+  // ...if both, a combined write-read transfer is done (see above);
+  //    if neither, an empty write transfer (i.e. an address probe)
+
+  // the transfers are run back to back (the first error doesn't stop
+  // the subsequent ones); returns the or-ed status. Each transfer
+  // must complete within the timeout (in ARM counter ticks; e.g.
+  // 100ms at 250 MHz); throws otherwise (e.g. if the controller isn't
+  // clocked or if CLKT is zero and the slave holds SCL down)
+  uint32_t execute(Transfer *transfer,size_t n,uint32_t timeout=25000000) ;
+
+private:
+
+  std::shared_ptr<Page> page ;
+
+  uint32_t volatile const *counter ; // ARM counter (for the timeout)
+
+  uint32_t run(Transfer *transfer,uint32_t timeout) ;
+} ;
+
+}
+
+#endif // INCLUDE_Rpi_Bsc_h
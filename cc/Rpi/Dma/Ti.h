@@ -53,6 +53,57 @@ namespace Ti
 	w %= NoWideBursts::make<0>() ; // +++ can be overwritten by client +++
 	return w ;
     }
+
+    // ---- transfers without destination pacing ----
+    //
+    // with 32-bit words and safe settings (WaitResp, NoWideBursts)
+
+    // between fixed addresses (not paced): e.g. a control word to a
+    // peripheral register or a peripheral register to memory
+    static inline Word fixed()
+    {
+	Word w ;
+	w %= Inten       ::make<0>() ;
+	w %= Tdmode      ::make<0>() ;
+	w %= WaitResp    ::make<1>() ; // play it safe
+
+	w %= SrcInc      ::make<0>() ;
+	w %= SrcWidth    ::make<0>() ; // only 32-bit words
+	w %= SrcDreq     ::make<0>() ;
+	w %= SrcIgnore   ::make<0>() ;
+
+	w %= DestInc     ::make<0>() ;
+	w %= DestWidth   ::make<0>() ; // play it safe
+	w %= DestDreq    ::make<0>() ;
+	w %= DestIgnore  ::make<0>() ;
+
+	w %= BurstLength ::make<0>() ;
+	w %= Permap      ::make<0>() ;
+	w %= Waits       ::make<0>() ;
+	w %= NoWideBursts::make<1>() ; // play it safe
+
+	return w ;
+    }
+
+    // a memory block to a fixed address (not paced): e.g. to a
+    // peripheral's FIFO
+    static inline Word fromMemory()
+    {
+	auto w = fixed() ;
+	w %= SrcInc::make<1>() ; // buffer gets incremented
+	return w ;
+    }
+
+    // a fixed address to a memory block, paced by the source: e.g.
+    // from a peripheral's FIFO (make(permap) paces the destination)
+    static inline Word fromPeripheral(Permap permap)
+    {
+	auto w = fixed() ;
+	w %= DestInc::make<1>() ; // buffer gets incremented
+	w %= permap ;
+	w %= SrcDreq::make<1>() ; // paced by peripheral
+	return w ;
+    }
 } } }
 
 #endif // INCLUDE_Rpi_Dma_Ti_h
@@ -28,6 +28,58 @@ void Rpi::Gpio::Function::set(Base gpio,Pin pin,Type mode)
     // [todo] read back and check if the same (race conditions)
 }
 
+void Rpi::Gpio::Function::set(Base gpio,uint32_t pins,Type mode)
+{
+    Switch(pins,mode).apply(gpio) ;
+}
+
+Rpi::Gpio::Function::Update::Update(Pin pin,Type mode)
+{
+    this->bank = pin.value()/10u ;
+    auto r = 3u * (pin.value()%10u) ;
+    this->keep = ~(7u << r) ;
+    this->bits = TypeEnum(mode).n() << r ;
+}
+
+Rpi::Gpio::Function::Switch& Rpi::Gpio::Function::Switch::add(Pin pin,Type mode)
+{
+    Update u(pin,mode) ;
+    for (size_t i=0 ; i<this->n ; ++i)
+    {
+	auto &v = this->v[i] ;
+	if (v.bank == u.bank)
+	{
+	    v.bits = (v.bits & u.keep) | u.bits ;
+	    v.keep &= u.keep ;
+	    return *this ;
+	}
+    }
+    this->v[this->n++] = u ;
+    return *this ;
+}
+
+Rpi::Gpio::Function::Switch& Rpi::Gpio::Function::Switch::add(uint32_t pins,Type mode)
+{
+    for (unsigned i=0 ; pins != 0 ; ++i,pins>>=1)
+    {
+	if (pins & 1u)
+	    this->add(Pin::coset(i),mode) ;
+    }
+    return *this ;
+}
+
+Rpi::Gpio::Function::Switch Rpi::Gpio::Function::Switch::freeze(Base gpio) const
+{
+    auto copy = (*this) ;
+    for (size_t i=0 ; i<copy.n ; ++i)
+    {
+	auto &u = copy.v[i] ;
+	u.bits |= gpio.ptr()[u.bank] & u.keep ;
+	u.keep = 0 ;
+    }
+    return copy ;
+}
+
 std::vector<Rpi::Gpio::Function::Record> const& Rpi::Gpio::Function::records() 
 {
     static std::vector<Record> recordV = {
@@ -24,7 +24,66 @@ namespace Rpi { namespace Gpio { namespace Function
     Type get(Base gpio,Pin pin) ;
     void set(Base gpio,Pin pin,Type type) ;
     // ...[todo] these access gpio private's pointer
-    // ...[todo] better map pin -> (0..5,mask=uint32_t)
+
+    void set(Base gpio,uint32_t pins,Type type) ;
+    // ...one read-modify-write per touched GPFSEL register
+    
+    // A read-modify-write of a single GPFSEL register, computed in
+    // advance (i.e. there is no pin -> bank translation anymore)
+    struct Update
+    {
+	Update(Pin pin,Type type) ;
+	
+	void apply(Base gpio) const
+	{
+	    auto p = gpio.ptr() + this->bank ;
+	    if (this->keep == 0) (*p) = this->bits ;
+	    else                 (*p) = ((*p) & this->keep) | this->bits ;
+	}
+
+	unsigned bank ; // 0..5 (GPFSEL0..5)
+	uint32_t keep ; // bits that remain (zero: a plain store)
+	uint32_t bits ; // bits to set
+	
+    private:
+
+	friend class Switch ;
+
+	Update() : bank(0),keep(~0u),bits(0) {}
+    } ;
+
+    // A function-select change of any number of pins; the changes are
+    // merged into one Update per touched GPFSEL register
+    struct Switch
+    {
+	Switch() : n(0) {}
+
+	Switch(Pin pin,Type type) : n(0) { this->add(pin,type) ; }
+	
+	Switch(uint32_t pins,Type type) : n(0) { this->add(pins,type) ; }
+	
+	Switch& add(Pin pin,Type type) ;
+
+	Switch& add(uint32_t pins,Type type) ;
+
+	void apply(Base gpio) const
+	{
+	    for (auto &u : *this)
+		u.apply(gpio) ;
+	}
+
+	Switch freeze(Base gpio) const ;
+	// ...returns a Switch that replaces all touched registers by a
+	// single store each: the current function of all other pins is
+	// captured now; hence it must not change while in use
+
+	Update const* begin() const { return this->v ; }
+	Update const*   end() const { return this->v + this->n ; }
+
+    private:
+
+	Update v[Pin::max/10+1] ; size_t n ;
+    } ;
     
     enum class Device : unsigned
     { 
@@ -34,14 +34,15 @@ private:
 
     friend class Peripheral ;
 
-    static Page::shared_ptr load(Posix::Fd *fd,size_t pno) ; 
+    Posix::MMap::shared_ptr mmap ; // the whole peripheral window
     
-    Posix::MMap::shared_ptr mmap ;
+    volatile uint32_t *p ;
 
-    Page(Posix::MMap::shared_ptr mmap) : mmap(mmap) {}
+    Page(Posix::MMap::shared_ptr mmap,size_t pno)
+	: mmap(mmap),p(mmap->as<volatile uint32_t*>() + pno * nwords) {}
 
-    volatile uint32_t      * front()       { return reinterpret_cast<volatile uint32_t*>(mmap->front()) ; }
-    volatile uint32_t const* front() const { return reinterpret_cast<volatile uint32_t*>(mmap->front()) ; }
+    volatile uint32_t      * front()       { return p ; }
+    volatile uint32_t const* front() const { return p ; }
 
 } ; }
 
@@ -43,30 +43,58 @@ Posix::Fd::uoff_t Rpi::Peripheral::by_cpuinfo()
     throw Error("Peripheral:no ARM found in /proc/cpuinfo") ;
 }
 
+static auto exists = false ;
+// ...there is only a single peripheral window (real or shadow)
+
+static Posix::MMap::shared_ptr map(Posix::Fd *fd,size_t base_page)
+{
+    auto bpp = Neat::promote<Posix::Fd::uoff_t::Unsigned>(Rpi::Page::nbytes) ;
+    auto nbytes = Neat::safe_mult(base_page,bpp) ;
+    auto offset = Posix::Fd::uoff_t::make(nbytes) ;
+    auto length = (Rpi::Peripheral::PNo::max+1u) * Rpi::Page::nbytes ;
+    return Posix::MMap::make(fd,offset,length,Posix::MMap::Prot::RW,false) ;
+    // note: the mapping persists even though the file gets closed
+}
+// ...[todo]
+// --open with O_SYNC or not? Does it make a difference for reading from
+//   RAM, writing to RAM, accessing peripherals?!
+// --does a MAP_SHARED mapping of physical memory make any difference?!
+// --the window covers also undocumented pages; these must not be
+//   accessed (a mapping alone doesn't do any harm though)
+
 std::shared_ptr<Rpi::Peripheral> Rpi::Peripheral::make(Posix::Fd::uoff_t addr)
 {
-    static auto exists = false ;
     if (exists)
 	throw Error("Peripheral:multiple initialisations") ;
     if (0 != (addr.as_unsigned() % Page::nbytes))
 	throw Error("Peripheral:base address is not page aligned") ;
     auto base_page = addr.as_unsigned() / Page::nbytes ;
     auto mem = Posix::Fd::open("/dev/mem",Posix::Fd::Open::RW) ;
-    auto self = new Peripheral(base_page,mem,Map()) ;
+    auto self = new Peripheral(base_page,map(mem.get(),base_page)) ;
+    exists = true ;
+    return std::shared_ptr<Peripheral>(self) ;
+}
+
+std::shared_ptr<Rpi::Peripheral> Rpi::Peripheral::shadow(Posix::Fd::shared_ptr file)
+{
+    if (exists)
+	throw Error("Peripheral:multiple initialisations") ;
+    auto nbytes = Neat::make_safe(PNo::max+1u) * Page::nbytes ;
+    using T = Posix::Fd::uoff_t ;
+    auto length = T::make(Neat::promote<T::Unsigned>(nbytes)) ;
+    if (file->size().as_unsigned() < length.as_unsigned())
+	file->truncate(length) ;
+    auto self = new Peripheral(0,map(file.get(),0)) ;
     exists = true ;
     return std::shared_ptr<Peripheral>(self) ;
 }
 
 std::shared_ptr<Rpi::Page const> Rpi::Peripheral::page(PNo no) const
 {
-    auto i = this->map.find(no.value()) ;
-    if (i == this->map.end())
-    {
-	auto ofs = Neat::make_safe(this->base_page)+no.value() ;
-	auto page = Page::load(this->mem.get(),ofs) ;
-	i = this->map.insert(std::make_pair(no.value(),page)).first ;
-    }
-    return i->second ;
+    auto &page = this->table[no.value()] ;
+    if (!page)
+	page.reset(new Page(this->mmap,no.value())) ;
+    return page ;
 }
 
 std::shared_ptr<Rpi::Page> Rpi::Peripheral::page(PNo no)
@@ -78,15 +106,12 @@ uint32_t volatile const & Rpi::Peripheral::at(size_t i) const
 {
     if (0 != (i % 4))
 	throw Error("Peripheral:address is not word aligned") ;
-    i /= 4 ;
-    auto ofs = Rpi::Page::Index::make(i % 0x400) ;
-    i /= 0x400 ;
-    auto pno = Rpi::Peripheral::PNo::make(i) ;
-    return this->page(pno)->at(ofs) ; 
+    if (i >= this->mmap->size())
+	throw Error("Peripheral:address is out of range") ;
+    return this->window[i/4] ; 
 }
 
 uint32_t volatile & Rpi::Peripheral::at(size_t i)
 {
     return Neat::clip_const(Neat::as_const(this)->at(i)) ;
 }
-    
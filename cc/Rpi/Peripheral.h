@@ -50,14 +50,20 @@
 #include <Neat/Bit/Word.h>
 #include <Neat/Enum.h>
 #include <Posix/Fd.h> // uoff_t
+#include <Posix/MMap.h>
 
-#include <map>
+#include <vector>
 
 namespace Rpi { struct Peripheral
 {
     static std::shared_ptr<Peripheral> make(Posix::Fd::uoff_t addr) ;
     // ...shared_ptr so it can easily be passed around incl. ownership
 
+    static std::shared_ptr<Peripheral> shadow(Posix::Fd::shared_ptr file) ;
+    // ...the file takes the place of /dev/mem: it is grown (sparse) to
+    //    cover all 0x1000 pages; so the register access can be run and
+    //    profiled off-target. Rpi::Shadow emulates some side-effects.
+
     // figure out the physical ARM address automatically...
     static Posix::Fd::uoff_t by_devtree() ;
     static Posix::Fd::uoff_t by_cpuinfo() ;
@@ -80,29 +86,34 @@ namespace Rpi { struct Peripheral
 
     template<typename Traits> Register::Pointer<Traits> at()
     {
-	return & page(Traits::PageNo)->at(Traits::Index) ;
-	// ...that's a fairly expensive call (compared with base.at())
+	return window + Traits::PageNo.value() * Page::nwords + Traits::Index.value() ;
+	// ...a constant offset since the whole window is mapped
     }
 
     template<uint32_t P> Register::Base<P> page()
     {
-	return & page(PNo::make<P>())->at<0>() ;
+	static_assert(P <= PNo::max,"") ;
+	return window + P * Page::nwords ;
     }
 
 private:
 
-    using Map = std::map<unsigned,std::shared_ptr<Page>> ;
+    using Table = std::vector<std::shared_ptr<Page>> ;
+    // ...indexed by page number (filled on demand)
       
     size_t base_page ;
 
-    Posix::Fd::shared_ptr mem ; // file descriptor for "/dev/mem"
+    Posix::MMap::shared_ptr mmap ; // covers all 0x1000 pages
+
+    volatile uint32_t *window ; // front of mmap
   
-    mutable Map map ;
+    mutable Table table ;
 
-    Peripheral(size_t base_page,Posix::Fd::shared_ptr mem,Map &&map)
+    Peripheral(size_t base_page,Posix::MMap::shared_ptr mmap)
 	: base_page(base_page)
-	, mem            (mem)
-	, map (std::move(map))
+	, mmap          (mmap)
+	, window(mmap->as<volatile uint32_t*>())
+	, table  (PNo::max+1)
 	{ }
 } ; }
 
@@ -0,0 +1,341 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Shadow.h"
+#include <chrono>
+#if defined(__x86_64__) && defined(__linux__)
+#include <signal.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock ;
+
+    struct Counter : Rpi::Shadow::Hook
+    {
+	Counter(uint32_t volatile *lo,uint32_t volatile *hi,double frequency)
+	    : lo(lo),hi(hi),frequency(frequency),t0(Clock::now()) {}
+
+	void apply() override
+	{
+	    auto dt = std::chrono::duration<double>(Clock::now()-t0).count() ;
+	    auto ticks = static_cast<uint64_t>(dt * frequency) ;
+	    if (hi != nullptr)
+		(*hi) = static_cast<uint32_t>(ticks >> 32) ;
+	    (*lo) = static_cast<uint32_t>(ticks) ;
+	}
+
+    private:
+
+	uint32_t volatile *lo,*hi ; double frequency ; Clock::time_point t0 ;
+    } ;
+
+    struct Stepper : Rpi::Shadow::Hook
+    {
+	Stepper(uint32_t volatile *lo,uint32_t volatile *hi,uint32_t step)
+	    : lo(lo),hi(hi),step(step),ticks(0) {}
+
+	void apply() override
+	{
+	    ticks += step ;
+	    if (hi != nullptr)
+		(*hi) = static_cast<uint32_t>(ticks >> 32) ;
+	    (*lo) = static_cast<uint32_t>(ticks) ;
+	}
+
+    private:
+
+	uint32_t volatile *lo,*hi ; uint32_t step ; uint64_t ticks ;
+    } ;
+
+    struct Gpio : Rpi::Shadow::Hook
+    {
+	Gpio(Rpi::Peripheral *rpi)
+	{
+	    for (size_t i=0 ; i<2 ; ++i)
+	    {
+		raise[i] = &rpi->at(0x20001c + 4*i) ;
+		clear[i] = &rpi->at(0x200028 + 4*i) ;
+		level[i] = &rpi->at(0x200034 + 4*i) ;
+	    }
+	}
+
+	void apply() override
+	{
+	    for (size_t i=0 ; i<2 ; ++i)
+	    {
+		auto r = __atomic_exchange_n(raise[i],0u,__ATOMIC_RELAXED) ;
+		auto c = __atomic_exchange_n(clear[i],0u,__ATOMIC_RELAXED) ;
+		// ...the client may write again in the meantime
+		if (r != 0 || c != 0)
+		    (*level[i]) = ((*level[i]) | r) & ~c ;
+	    }
+	}
+
+    private:
+
+	uint32_t volatile *raise[2],*clear[2],*level[2] ;
+    } ;
+
+    struct Force : Rpi::Shadow::Hook
+    {
+	Force(uint32_t volatile *p,uint32_t set,uint32_t clear)
+	    : p(p),set(set),clear(clear) {}
+
+	void apply() override
+	{
+	    auto w = (*p) ;
+	    if (((w | set) & ~clear) != w)
+		(*p) = (w | set) & ~clear ;
+	}
+
+    private:
+
+	uint32_t volatile *p ; uint32_t set,clear ;
+    } ;
+}
+
+Rpi::Shadow::Hook::shared_ptr Rpi::Shadow::armCounter(Peripheral *rpi,double frequency)
+{
+    return Hook::shared_ptr(new Counter(&rpi->at(0x00b420),nullptr,frequency)) ;
+}
+
+Rpi::Shadow::Hook::shared_ptr Rpi::Shadow::timer(Peripheral *rpi)
+{
+    return Hook::shared_ptr(new Counter(&rpi->at(0x003004),&rpi->at(0x003008),1e6)) ;
+}
+
+Rpi::Shadow::Hook::shared_ptr Rpi::Shadow::armCounter(Peripheral *rpi,Step step)
+{
+    return Hook::shared_ptr(new Stepper(&rpi->at(0x00b420),nullptr,step.ticks)) ;
+}
+
+Rpi::Shadow::Hook::shared_ptr Rpi::Shadow::timer(Peripheral *rpi,Step step)
+{
+    return Hook::shared_ptr(new Stepper(&rpi->at(0x003004),&rpi->at(0x003008),step.ticks)) ;
+}
+
+Rpi::Shadow::Hook::shared_ptr Rpi::Shadow::gpio(Peripheral *rpi)
+{
+    return Hook::shared_ptr(new Gpio(rpi)) ;
+}
+
+Rpi::Shadow::Hook::shared_ptr Rpi::Shadow::force(Peripheral *rpi,size_t ofs,uint32_t set,uint32_t clear)
+{
+    return Hook::shared_ptr(new Force(&rpi->at(ofs),set,clear)) ;
+}
+
+// the FIFO status flags (see flags)
+static struct { size_t ofs ; uint32_t set,clear ; } const flagTable[] =
+{
+    { 0x20c004,0x2    ,0x1   }, // PWM STA: EMPT1 but not FULL1
+    { 0x204000,0x50000,0x0   }, // SPI0 CS: DONE and TXD
+} ;
+// ...the BSC isn't emulated: a transfer would need an I2C slave; so
+//    Rpi::Bsc::execute() times out
+
+// ----[ trap mode ]---------------------------------------------------
+
+#if defined(__x86_64__) && defined(__linux__)
+
+namespace
+{
+    // a trapped page of the peripheral window
+    struct Page
+    {
+	size_t ofs ; // byte-offset in the window
+
+	// applied before a read of the (byte-offset) address
+	std::vector<std::pair<size_t,Rpi::Shadow::Hook::shared_ptr>> reads ;
+
+	// applied after each access to the page
+	std::vector<Rpi::Shadow::Hook::shared_ptr> hooks ;
+    } ;
+
+    // the state of the trapped window (there is a single one at most)
+    struct Trap
+    {
+	char *base ; // of the peripheral window
+
+	std::vector<Page> pages ;
+
+	Page *pending ; // the page of the access that is single-stepped
+
+	struct sigaction segv,trap ; // the previous handlers
+
+	Page* page(size_t ofs)
+	{
+	    for (auto &page: this->pages)
+		if (page.ofs == ofs)
+		    return &page ;
+	    this->pages.push_back(Page{ofs,{},{}}) ;
+	    return &this->pages.back() ;
+	}
+
+	void protect(Page const &page,int prot)
+	{
+	    mprotect(this->base + page.ofs,Rpi::Page::nbytes,prot) ;
+	}
+    } ;
+
+    Trap *active = nullptr ;
+
+    constexpr greg_t TrapFlag = 0x100 ; // EFLAGS.TF: single-step
+
+    void restore(int signo)
+    {
+	// not ours: fall back to the previous handler, the access (or
+	// the trap) is repeated on return
+	sigaction(signo,signo == SIGSEGV ? &active->segv : &active->trap,nullptr) ;
+    }
+
+    // an access to a trapped page: unprotect the page, apply the read
+    // hooks and single-step the instruction
+    void onSegv(int,siginfo_t *info,void *context)
+    {
+	auto a = static_cast<char*>(info->si_addr) ;
+	auto ofs = static_cast<size_t>(a - active->base) ;
+	Page *hit = nullptr ;
+	if (a >= active->base)
+	    for (auto &page: active->pages)
+		if (ofs - page.ofs < Rpi::Page::nbytes)
+		    hit = &page ;
+	if (hit == nullptr || active->pending != nullptr)
+	{
+	    restore(SIGSEGV) ;
+	    return ;
+	}
+	active->protect(*hit,PROT_READ | PROT_WRITE) ;
+	auto uc = static_cast<ucontext_t*>(context) ;
+	auto write = 0 != (uc->uc_mcontext.gregs[REG_ERR] & 0x2) ;
+	if (!write)
+	    for (auto const &r: hit->reads)
+		if (r.first == (ofs & ~size_t(3)))
+		    r.second->apply() ;
+	active->pending = hit ;
+	uc->uc_mcontext.gregs[REG_EFL] |= TrapFlag ;
+    }
+
+    // the access is done: apply the page's hooks (so each write is seen
+    // on its own and in order) and protect the page again
+    void onTrap(int,siginfo_t*,void *context)
+    {
+	auto page = active->pending ;
+	if (page == nullptr)
+	{
+	    restore(SIGTRAP) ;
+	    return ;
+	}
+	for (auto &hook: page->hooks)
+	    hook->apply() ;
+	active->protect(*page,PROT_NONE) ;
+	active->pending = nullptr ;
+	auto uc = static_cast<ucontext_t*>(context) ;
+	uc->uc_mcontext.gregs[REG_EFL] &= ~TrapFlag ;
+    }
+}
+
+Rpi::Shadow::shared_ptr Rpi::Shadow::trap(std::shared_ptr<Peripheral> rpi,Step arm,Step timer)
+{
+    if (active != nullptr)
+	throw Error("Shadow:window is trapped already") ;
+    std::unique_ptr<Trap> t(new Trap) ;
+    t->base = reinterpret_cast<char*>(const_cast<uint32_t*>(&rpi->at(0))) ;
+    t->pages.reserve(8) ; // ...the pointers remain valid
+    t->page(0x00b000)->reads.push_back({ 0x00b420,armCounter(rpi.get(),arm) }) ;
+    t->page(0x003000)->reads.push_back({ 0x003004,Shadow::timer(rpi.get(),timer) }) ;
+    t->page(0x200000)->hooks.push_back(gpio(rpi.get())) ;
+    for (auto const &f: flagTable)
+    {
+	auto hook = force(rpi.get(),f.ofs,f.set,f.clear) ;
+	hook->apply() ;
+	t->page(f.ofs & ~size_t(Rpi::Page::nbytes-1))->hooks.push_back(hook) ;
+    }
+    t->pending = nullptr ;
+
+    struct sigaction sa ;
+    sigemptyset(&sa.sa_mask) ;
+    sa.sa_flags = SA_SIGINFO ;
+    sa.sa_sigaction = &onSegv ;
+    if (0 != sigaction(SIGSEGV,&sa,&t->segv))
+	throw Error("Shadow:sigaction(SIGSEGV) failed") ;
+    sa.sa_sigaction = &onTrap ;
+    if (0 != sigaction(SIGTRAP,&sa,&t->trap))
+    {
+	sigaction(SIGSEGV,&t->segv,nullptr) ;
+	throw Error("Shadow:sigaction(SIGTRAP) failed") ;
+    }
+    active = t.release() ;
+    for (auto const &page: active->pages)
+	active->protect(page,PROT_NONE) ;
+
+    shared_ptr self(new Shadow(rpi,{})) ;
+    self->trapped = true ;
+    return self ;
+}
+
+void Rpi::Shadow::release()
+{
+    for (auto const &page: active->pages)
+	active->protect(page,PROT_READ | PROT_WRITE) ;
+    sigaction(SIGSEGV,&active->segv,nullptr) ;
+    sigaction(SIGTRAP,&active->trap,nullptr) ;
+    delete active ;
+    active = nullptr ;
+}
+
+#else
+
+Rpi::Shadow::shared_ptr Rpi::Shadow::trap(std::shared_ptr<Peripheral>,Step,Step)
+{
+    throw Error("Shadow:trap mode is not supported on this host") ;
+}
+
+void Rpi::Shadow::release() {}
+
+#endif
+
+// --------------------------------------------------------------------
+
+std::vector<Rpi::Shadow::Hook::shared_ptr> Rpi::Shadow::defaults(Peripheral *rpi)
+{
+    auto v = flags(rpi) ;
+    v.insert(v.begin(),{ armCounter(rpi,250e6),timer(rpi),gpio(rpi) }) ;
+    return v ;
+}
+
+std::vector<Rpi::Shadow::Hook::shared_ptr> Rpi::Shadow::flags(Peripheral *rpi)
+{
+    std::vector<Hook::shared_ptr> v ;
+    for (auto const &f: flagTable)
+	v.push_back(force(rpi,f.ofs,f.set,f.clear)) ;
+    return v ;
+}
+
+Rpi::Shadow::shared_ptr Rpi::Shadow::start(std::shared_ptr<Peripheral> rpi,std::vector<Hook::shared_ptr> const &hooks)
+{
+    shared_ptr self(new Shadow(rpi,hooks)) ;
+    self->thread = std::thread(&Shadow::run,self.get()) ;
+    return self ;
+}
+
+void Rpi::Shadow::run()
+{
+    while (!this->done.load(std::memory_order_relaxed))
+    {
+	for (auto &hook: this->hooks)
+	    hook->apply() ;
+	std::this_thread::yield() ;
+	// ...give the client a chance on single-core hosts
+    }
+}
+
+Rpi::Shadow::~Shadow()
+{
+    this->done = true ;
+    if (this->thread.joinable())
+	this->thread.join() ;
+    if (this->trapped)
+	release() ;
+}
@@ -0,0 +1,117 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// Emulation of a few peripheral side-effects for a shadow window (see
+// Peripheral::shadow). This is no hardware simulation. It is just good
+// enough to run (and to profile) the bit-banging code off-target.
+//
+// A background thread applies all hooks over and over again. That is,
+// the side-effects become visible with some (arbitrary) delay. The
+// thread should have a core of its own; otherwise each busy-wait on
+// the counter lasts (at least) a time-slice.
+//
+// In the trap mode (see trap) there is no such thread: the pages of
+// the emulated registers are protected, and each access to them is
+// trapped (SIGSEGV) and single-stepped (SIGTRAP) in the caller's
+// thread. A counter advances by a fixed step on each read (instead of
+// by the steady clock) and the hooks are applied after each access;
+// e.g. GPSET and GPCLR writes get into GPLEV in the order they were
+// written. So the results (e.g. instruction counts) don't depend on
+// the host's load. This takes two signals per access though, and it
+// is available on x86-64 Linux hosts only (for single-threaded
+// clients).
+//
+// Provided hooks:
+// * ARM free-running counter (00b:420) driven by the steady clock
+// * System Timer (003:004-00b) at 1 MHz
+// * ...both counters alternatively advanced per read (see Step)
+// * GPIO: GPSET/GPCLR are folded into GPLEV (and cleared); the thread
+//   folds the writes since its last round at once (sets first)
+// * bits that are forced to a level (e.g. FIFO status flags)
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_Rpi_Shadow_h
+#define INCLUDE_Rpi_Shadow_h
+
+#include "Peripheral.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace Rpi { struct Shadow
+{
+    struct Hook
+    {
+	using shared_ptr = std::shared_ptr<Hook> ;
+
+	virtual void apply() = 0 ;
+
+	virtual ~Hook() {}
+    } ;
+
+    static Hook::shared_ptr armCounter(Peripheral *rpi,double frequency) ;
+
+    static Hook::shared_ptr timer(Peripheral *rpi) ;
+
+    // the number of counter ticks to advance per apply() (i.e. per
+    // read in the trap mode)
+    struct Step
+    {
+	uint32_t ticks ;
+	explicit Step(uint32_t ticks) : ticks(ticks) {}
+    } ;
+
+    static Hook::shared_ptr armCounter(Peripheral *rpi,Step step) ;
+
+    static Hook::shared_ptr timer(Peripheral *rpi,Step step) ;
+
+    static Hook::shared_ptr gpio(Peripheral *rpi) ;
+
+    static Hook::shared_ptr force(Peripheral *rpi,size_t ofs,uint32_t set,uint32_t clear) ;
+    // ...ofs is a byte-offset as for Peripheral::at(ofs)
+
+    static std::vector<Hook::shared_ptr> defaults(Peripheral *rpi) ;
+    // ...ARM counter (250 MHz), timer, GPIO and the FIFO status
+    //    flags of PWM (always empty) and SPI0 (always done)
+
+    static std::vector<Hook::shared_ptr> flags(Peripheral *rpi) ;
+    // ...only the FIFO status flags (as in defaults)
+
+    using shared_ptr = std::shared_ptr<Shadow> ;
+
+    static shared_ptr start(std::shared_ptr<Peripheral> rpi,std::vector<Hook::shared_ptr> const &hooks) ;
+    // ...the thread runs until the object gets destroyed (and it
+    //    keeps the peripheral window alive till then)
+
+    static shared_ptr trap(std::shared_ptr<Peripheral> rpi,Step arm,Step timer) ;
+    // ...without thread: the counters advance per read (by the given
+    //    steps), the GPIO and flags hooks are applied after each access
+    //    (see above); the trap is released with the object
+
+    ~Shadow() ;
+
+    Shadow           (Shadow const&) = delete ;
+    Shadow& operator=(Shadow const&) = delete ;
+
+private:
+
+    std::shared_ptr<Peripheral> rpi ;
+    
+    std::vector<Hook::shared_ptr> hooks ;
+
+    std::atomic<bool> done ;
+
+    std::thread thread ;
+
+    bool trapped ; // see trap
+
+    Shadow(std::shared_ptr<Peripheral> rpi,std::vector<Hook::shared_ptr> const &hooks)
+	: rpi(rpi),hooks(hooks),done(false),trapped(false) {}
+
+    static void release() ;
+
+    void run() ;
+
+} ; }
+
+#endif // INCLUDE_Rpi_Shadow_h
@@ -4,3 +4,231 @@
 
 // the implementation is located in the header in order
 // to give the compiler a better chance to optimize
+
+constexpr unsigned RpiExt::Bang::Preempted ;
+
+constexpr unsigned RpiExt::Bang::MaxDepth ;
+
+void RpiExt::Bang::validate(std::vector<Command> const &v)
+{
+    using Choice = Command::Choice ;
+    for (auto const &c: v)
+    {
+	uint32_t target ;
+	switch (c.choice)
+	{
+	case Choice::Branch: target = c.value.branch.target ; break ;
+	case Choice::Jump:   target = c.value.jump.target   ; break ;
+	case Choice::Repeat: target = c.value.repeat.target ; break ;
+	default: continue ;
+	}
+	if (target > v.size())
+	    throw Error("jump target out of range") ;
+    }
+}
+
+RpiExt::Bang::Program RpiExt::Bang::compile(std::vector<Command> const &v)
+{
+    using Choice = Command::Choice ;
+    using Op = Command::Op ;
+    namespace Gpio = Rpi::Register::Gpio ;
+
+    static Program::Handler const assumeV[2][6] = {
+	{ xAssume<Op::Eq,false>,xAssume<Op::Ge,false>,xAssume<Op::Gt,false>,
+	  xAssume<Op::Le,false>,xAssume<Op::Lt,false>,xAssume<Op::Ne,false>, },
+	{ xAssume<Op::Eq,true>,xAssume<Op::Ge,true>,xAssume<Op::Gt,true>,
+	  xAssume<Op::Le,true>,xAssume<Op::Lt,true>,xAssume<Op::Ne,true>, },
+    } ;
+    static Program::Handler const branchV[2][6] = {
+	{ xBranch<Op::Eq,false>,xBranch<Op::Ge,false>,xBranch<Op::Gt,false>,
+	  xBranch<Op::Le,false>,xBranch<Op::Lt,false>,xBranch<Op::Ne,false>, },
+	{ xBranch<Op::Eq,true>,xBranch<Op::Ge,true>,xBranch<Op::Gt,true>,
+	  xBranch<Op::Le,true>,xBranch<Op::Lt,true>,xBranch<Op::Ne,true>, },
+    } ;
+    static Program::Handler const compareV[2][6] = {
+	{ xCompare<Op::Eq,false>,xCompare<Op::Ge,false>,xCompare<Op::Gt,false>,
+	  xCompare<Op::Le,false>,xCompare<Op::Lt,false>,xCompare<Op::Ne,false>, },
+	{ xCompare<Op::Eq,true>,xCompare<Op::Ge,true>,xCompare<Op::Gt,true>,
+	  xCompare<Op::Le,true>,xCompare<Op::Lt,true>,xCompare<Op::Ne,true>, },
+    } ;
+    // ...[relative][op] in the order of the Op enum
+    
+    validate(v) ;
+    
+    Program program ;
+    program.v.reserve(v.size()+1) ;
+
+    std::vector<size_t> map(v.size()+1) ;
+    // ...command index -> instruction index (to resolve targets)
+    std::vector<std::pair<size_t,uint32_t>> jumps ;
+    // ...(instruction index,command target)
+    auto jump = [&program,&jumps](Instruction const &i,uint32_t target)
+    {
+	jumps.push_back(std::make_pair(program.v.size(),target)) ;
+	program.v.push_back(i) ;
+    } ;
+    
+    for (size_t k=0 ; k<v.size() ; ++k)
+    {
+	map[k] = program.v.size() ;
+	auto &value = v[k].value ;
+	auto m = [&v,k](unsigned i) -> ptrdiff_t
+	{
+	    return (v[k].relative & (1u << i)) ? -1 : 0 ;
+	} ;
+	// ...the operand mask of the i-th data pointer (see Instruction)
+	auto r = (v[k].relative != 0) ? 1 : 0 ;
+	// ...the handler that adds the data offset (or the one that
+	//    doesn't)
+	switch (v[k].choice)
+	{
+	case Choice::Advance:
+	{
+	    Instruction i(xAdvance) ;
+	    i.d = value.advance.stride ;
+	    program.v.push_back(i) ;
+	    break ;
+	}
+	case Choice::Branch:
+	{
+	    Instruction i(branchV[r][static_cast<unsigned>(value.branch.op)]) ;
+	    i.x = value.branch.x ; i.mx = m(0) ;
+	    i.u = value.branch.y ;
+	    jump(i,value.branch.target) ;
+	    break ;
+	}
+	case Choice::Jump:
+	{
+	    jump(Instruction(xJump),value.jump.target) ;
+	    break ;
+	}
+	case Choice::Loop:
+	{
+	    Instruction i(xLoop) ;
+	    i.u = value.loop.count ;
+	    program.v.push_back(i) ;
+	    break ;
+	}
+	case Choice::Repeat:
+	{
+	    jump(Instruction(xRepeat),value.repeat.target) ;
+	    break ;
+	}
+	case Choice::Assume:
+	{
+	    Instruction i(assumeV[r][static_cast<unsigned>(value.assume.op)]) ;
+	    i.x = value.assume.x ; i.mx = m(0) ;
+	    i.u = value.assume.y ;
+	    i.w = value.assume.error ;
+	    program.v.push_back(i) ;
+	    break ;
+	}
+	case Choice::Compare:
+	{
+	    Instruction i(compareV[r][static_cast<unsigned>(value.compare.op)]) ;
+	    i.x = value.compare.x ; i.mx = m(0) ;
+	    i.u = value.compare.y ;
+	    i.b = value.compare.success ; i.mp = m(1) ;
+	    program.v.push_back(i) ;
+	    break ;
+	}
+	case Choice::Duration:
+	{
+	    Instruction i(r ? xDuration<true> : xDuration<false>) ;
+	    i.x = value.duration.t0 ; i.mx = m(0) ;
+	    i.y = value.duration.t1 ; i.my = m(1) ;
+	    i.p = value.duration.span ; i.mp = m(2) ;
+	    program.v.push_back(i) ;
+	    break ;
+	}
+	case Choice::Levels:
+	{
+	    Instruction i(r ? xLevels<true> : xLevels<false>) ;
+	    i.r = this->core.port.gpio.at<Gpio::Input::Bank0>().value() ;
+	    i.p = value.levels.pins ; i.mp = m(0) ;
+	    program.v.push_back(i) ;
+	    break ;
+	}
+	case Choice::Mode:
+	{
+	    auto const &update = value.mode.update ;
+	    Instruction i(update.keep == 0 ? xStore : xModify) ;
+	    i.r = this->core.port.gpio.ptr() + update.bank ;
+	    i.u = (update.keep == 0) ? update.bits : update.keep ;
+	    i.v = update.bits ;
+	    program.v.push_back(i) ;
+	    break ;
+	}
+	case Choice::Recent:
+	{
+	    Instruction i(r ? xRecent<true> : xRecent<false>) ;
+	    i.p = value.recent.ticks ; i.mp = m(0) ;
+	    program.v.push_back(i) ;
+	    break ;
+	}
+	case Choice::Reset:
+	{
+	    Instruction i(xStore) ;
+	    i.r = this->core.port.gpio.at<Gpio::Output::Clear0>().value() ;
+	    i.u = value.reset.pins ;
+	    program.v.push_back(i) ;
+	    break ;
+	}
+	case Choice::Set:
+	{
+	    Instruction i(xStore) ;
+	    i.r = this->core.port.gpio.at<Gpio::Output::Raise0>().value() ;
+	    i.u = value.set.pins ;
+	    program.v.push_back(i) ;
+	    break ;
+	}
+	case Choice::Sleep:
+	{
+	    if (value.sleep.span == 0)
+		break ; // ...a no-op (as in execute())
+	    Instruction i(xSleep) ;
+	    i.u = value.sleep.span ;
+	    program.v.push_back(i) ;
+	    break ;
+	}
+	case Choice::Time:
+	{
+	    Instruction i(r ? xTime<true> : xTime<false>) ;
+	    i.p = value.time.ticks ; i.mp = m(0) ;
+	    program.v.push_back(i) ;
+	    break ;
+	}
+	case Choice::Wait:
+	{
+	    Instruction i(r ? xWait<true> : xWait<false>) ;
+	    i.x = value.wait.t0 ; i.mx = m(0) ;
+	    i.u = value.wait.span ;
+	    program.v.push_back(i) ;
+	    break ;
+	}
+	case Choice::WaitFor:
+	{
+	    Instruction i(r ? xWaitFor<true> : xWaitFor<false>) ;
+	    i.r = this->core.port.gpio.at<Gpio::Input::Bank0>().value() ;
+	    i.x = value.waitFor.t0 ; i.mx = m(0) ;
+	    i.u = value.waitFor.span ;
+	    i.v = value.waitFor.mask ;
+	    i.w = value.waitFor.cond ;
+	    i.p = value.waitFor.t1 ; i.mp = m(1) ;
+	    program.v.push_back(i) ;
+	    break ;
+	}
+	default: assert(false) ; abort() ;
+	}
+    }
+    map[v.size()] = program.v.size() ;
+    program.v.push_back(Instruction(xHalt)) ;
+    
+    for (auto const &j: jumps)
+    {
+	auto &i = program.v[j.first] ;
+	i.d = static_cast<ptrdiff_t>(map[j.second]) - static_cast<ptrdiff_t>(j.first) ;
+	// ...relative, so the program may be copied
+    }
+    return program ;
+}
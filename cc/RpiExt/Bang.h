@@ -17,23 +17,51 @@
 #include <assert.h>
 #include <deque>
 #include <vector>
+#include <Neat/Error.h>
 #include <Rpi/ArmTimer.h>
 #include <Rpi/Gpio/Function.h>
+#include <RpiExt/Jitter.h>
 
 namespace RpiExt {
 
 struct Bang
 {
+    struct Error : Neat::Error
+    {
+	Error(std::string const &s) : Neat::Error("RpiExt:Bang:" + s) {}
+    } ;
+    
+    // a data pointer of a command: absolute (a plain pointer converts
+    // implicitly) or relative to the data offset (see slot() and the
+    // Advance command)
+    template<typename T> struct Ptr
+    {
+	T *p ; bool relative ;
+	Ptr(T *p) : p(p),relative(false) {}
+	template<typename U> Ptr(Ptr<U> const &q) : p(q.p),relative(q.relative) {}
+	// ...e.g. to a pointer to const
+    } ;
+
+    template<typename T> static Ptr<T> slot(T *p)
+    {
+	Ptr<T> ptr(p) ; ptr.relative = true ; return ptr ;
+    }
+    
     struct Command
     {
 	enum class Choice
 	{
+	    Advance,    // add stride to the data offset
 	    Assume,     // stop if condition isn't true
+	    Branch,     // continue at target if condition is true
 	    Compare,    // execute comparison
 	    Duration,   // save the difference of two time-stamps
+	    Jump,       // continue at target
 	    Levels,     // get pin level
+	    Loop,       // set the loop counter
 	    Mode,       // set pin function mode
 	    Recent,     // get last recorded timer tick
+	    Repeat,     // continue at target unless the loop counter expires
 	    Reset,      // set GPIO pin level to Low
 	    Set,        // set GPIO pin level to High
 	    Sleep,      // sleep for a number of ticks based on current time
@@ -45,7 +73,29 @@ struct Bang
 	Choice choice ;
 	
 	enum class Op { Eq,Ge,Gt,Le,Lt,Ne } ;
+
+	// Addressing: a data pointer (i.e. x, t0, t1, pins, ticks, span
+	// and success) is either absolute or relative to the data offset
+	// (see Ptr), which is zero when a script is started. Advance
+	// moves the offset, so the same commands may fill an array of
+	// records (by relative pointers) and still share variables (by
+	// absolute pointers). Only the commands with a relative pointer
+	// pay for the offset (see Program).
+	//
+	// Control flow: a target is the index of a command within the
+	// script (the script's size at most). Loop opens a loop with the
+	// given count (not zero) and saves the data offset; Repeat jumps
+	// back to its target until the count expires, then the loop is
+	// closed and the offset restored. Loops nest up to MaxDepth.
 	
+	class Advance
+	{
+	    friend Command ;
+	    friend Bang ;
+	    ptrdiff_t stride ;
+	    Advance(ptrdiff_t stride) : stride(stride) {}
+	} ;
+	    
 	class Assume
 	{
 	    friend Command ;
@@ -58,6 +108,18 @@ struct Bang
 		: x(x),op(op),y(y),error(error) {}
 	} ;
 	    
+	class Branch
+	{
+	    friend Command ;
+	    friend Bang ;
+	    uint32_t const *x ;
+	    Op op ;
+	    uint32_t y ;
+	    uint32_t target ;
+	    Branch(uint32_t const*x,Op op,uint32_t y,uint32_t target)
+		: x(x),op(op),y(y),target(target) {}
+	} ;
+	    
 	class Compare
 	{
 	    friend Command ;
@@ -81,6 +143,14 @@ struct Bang
 		: t0(t0),t1(t1),span(span) {}
 	} ;
 	    
+	class Jump
+	{
+	    friend Command ;
+	    friend Bang ;
+	    uint32_t target ;
+	    Jump(uint32_t target) : target(target) {}
+	} ;
+	    
 	class Levels
 	{
 	    friend Command ;
@@ -89,13 +159,21 @@ struct Bang
 	    Levels(uint32_t *pins) : pins(pins) {}
 	} ;
 	    
+	class Loop
+	{
+	    friend Command ;
+	    friend Bang ;
+	    uint32_t count ;
+	    Loop(uint32_t count) : count(count) {}
+	} ;
+	    
 	class Mode
 	{
 	    friend Command ;
 	    friend Bang ;
-	    Rpi::Pin pin ;
-	    Rpi::Gpio::Function::Type mode ;
-	    Mode(Rpi::Pin pin,Rpi::Gpio::Function::Type mode) : pin(pin), mode(mode) {}
+	    Rpi::Gpio::Function::Update update ;
+	    Mode(Rpi::Gpio::Function::Update const &update) : update(update) {}
+	    // ...the GPFSEL bank and bits are resolved on enqueue
 	} ;
 	    
 	class Recent
@@ -106,6 +184,14 @@ struct Bang
 	    Recent(uint32_t *ticks) : ticks(ticks) {}
 	} ;
 	    
+	class Repeat
+	{
+	    friend Command ;
+	    friend Bang ;
+	    uint32_t target ;
+	    Repeat(uint32_t target) : target(target) {}
+	} ;
+	    
 	class Reset
 	{
 	    friend Command ;
@@ -170,12 +256,17 @@ struct Bang
 	    
 	    friend Bang ;
 	    
+	    Advance       advance ;
 	    Assume         assume ;
+	    Branch         branch ;
 	    Compare       compare ;
 	    Duration     duration ;
+	    Jump             jump ;
 	    Levels         levels ;
+	    Loop             loop ;
 	    Mode             mode ;
 	    Recent         recent ;
+	    Repeat         repeat ;
 	    Reset           reset ;
 	    Set               set ;
 	    Sleep           sleep ;
@@ -183,12 +274,17 @@ struct Bang
 	    Wait             wait ;
 	    WaitFor       waitFor ;
 	    
+	    Value(Advance    const&    advance) : advance      (advance) {}
 	    Value(Assume     const&     assume) : assume        (assume) {}
+	    Value(Branch     const&     branch) : branch        (branch) {}
 	    Value(Compare    const&    compare) : compare      (compare) {}
 	    Value(Duration   const&   duration) : duration    (duration) {}
+	    Value(Jump       const&       jump) : jump            (jump) {}
 	    Value(Levels     const&     levels) : levels        (levels) {}
+	    Value(Loop       const&       loop) : loop            (loop) {}
 	    Value(Mode       const&       mode) : mode            (mode) {}
 	    Value(Recent     const&     recent) : recent        (recent) {}
+	    Value(Repeat     const&     repeat) : repeat        (repeat) {}
 	    Value(Reset      const&      reset) : reset          (reset) {}
 	    Value(Set        const&        set) : set              (set) {}
 	    Value(Sleep      const&      sleep) : sleep          (sleep) {}
@@ -199,45 +295,89 @@ struct Bang
 	
 	Value value ;
 
-	Command(Choice choice,Value value)
-	    : choice(choice),value(value) {}
+	uint8_t relative ; // bit k: the k-th data pointer is relative
+
+	Command(Choice choice,Value value,uint8_t relative=0)
+	    : choice(choice),value(value),relative(relative) {}
+
+	template<typename T> static uint8_t rel(Ptr<T> const &p,unsigned k)
+	{
+	    return static_cast<uint8_t>(p.relative ? (1u << k) : 0u) ;
+	}
+
+	static Command advance(ptrdiff_t stride)
+	{
+	    return Command(Choice::Advance,Advance(stride)) ;
+	}
 
-	static Command assume(uint32_t const* x,
+	static Command assume(Ptr<uint32_t const> x,
 			      Command::Op    op,
 			      uint32_t        y,
 			      unsigned    error)
 	{
-	    return Command(Choice::Assume,Assume(x,op,y,error)) ;
+	    return Command(Choice::Assume,Assume(x.p,op,y,error),rel(x,0)) ;
 	}
 
-	static Command compare(uint32_t const* x,
+	static Command branch(Ptr<uint32_t const> x,
+			      Command::Op    op,
+			      uint32_t        y,
+			      uint32_t   target)
+	{
+	    return Command(Choice::Branch,Branch(x.p,op,y,target),rel(x,0)) ;
+	}
+
+	static Command compare(Ptr<uint32_t const> x,
 			       Command::Op    op,
 			       uint32_t        y,
-			       bool     *success)
+			       Ptr<bool> success)
+	{
+	    return Command(Choice::Compare,Compare(x.p,op,y,success.p),
+			   rel(x,0) | rel(success,1)) ;
+	}
+
+	static Command duration(Ptr<uint32_t> t0,Ptr<uint32_t> t1,Ptr<uint32_t> span)
 	{
-	    return Command(Choice::Compare,Compare(x,op,y,success)) ;
+	    return Command(Choice::Duration,Duration(t0.p,t1.p,span.p),
+			   rel(t0,0) | rel(t1,1) | rel(span,2)) ;
 	}
 
-	static Command duration(uint32_t *t0,uint32_t *t1,uint32_t *span)
+	static Command jump(uint32_t target)
 	{
-	    return Command(Choice::Duration,Duration(t0,t1,span)) ;
+	    return Command(Choice::Jump,Jump(target)) ;
 	}
 
-	static Command levels(uint32_t *pins)
+	static Command levels(Ptr<uint32_t> pins)
 	{
-	    return Command(Choice::Levels,Levels(pins)) ;
+	    return Command(Choice::Levels,Levels(pins.p),rel(pins,0)) ;
+	}
+
+	static Command loop(uint32_t count)
+	{
+	    if (count == 0)
+		throw Error("loop count must not be zero") ;
+	    return Command(Choice::Loop,Loop(count)) ;
 	}
 
 	static Command mode(Rpi::Pin pin,Rpi::Gpio::Function::Type mode)
 	{
-	    return Command(Choice::Mode,Mode(pin,mode)) ;
+	    return Command(Choice::Mode,Mode(Rpi::Gpio::Function::Update(pin,mode))) ;
 	}
 
-	static Command recent(uint32_t *ticks)
+	static Command mode(Rpi::Gpio::Function::Update const &update)
 	{
-	    return Command(Choice::Recent,Recent(ticks)) ;
+	    return Command(Choice::Mode,Mode(update)) ;
+	}
+
+	static Command recent(Ptr<uint32_t> ticks)
+	{
+	    return Command(Choice::Recent,Recent(ticks.p),rel(ticks,0)) ;
 	}
     
+	static Command repeat(uint32_t target)
+	{
+	    return Command(Choice::Repeat,Repeat(target)) ;
+	}
+
 	static Command reset(uint32_t pins) 
 	{
 	    return Command(Choice::Reset,Reset(pins)) ;
@@ -253,64 +393,56 @@ struct Bang
 	    return Command(Choice::Sleep,Sleep(span)) ;
 	}
 
-	static Command time(uint32_t *ticks)
+	static Command time(Ptr<uint32_t> ticks)
 	{
-	    return Command(Choice::Time,Time(ticks)) ;
+	    return Command(Choice::Time,Time(ticks.p),rel(ticks,0)) ;
 	}
     
-	static Command wait(uint32_t const *t0,uint32_t span)
+	static Command wait(Ptr<uint32_t const> t0,uint32_t span)
 	{
-	    return Command(Choice::Wait,Wait(t0,span)) ;
+	    return Command(Choice::Wait,Wait(t0.p,span),rel(t0,0)) ;
 	}
 
-	static Command waitFor(uint32_t const *t0,
+	static Command waitFor(Ptr<uint32_t const> t0,
 			       uint32_t      span,
 			       uint32_t      mask,
 			       uint32_t      cond,
-			       uint32_t       *t1)
+			       Ptr<uint32_t>   t1)
 	{
-	    return Command(Choice::WaitFor,WaitFor(t0,span,mask,cond,t1)) ;
+	    return Command(Choice::WaitFor,WaitFor(t0.p,span,mask,cond,t1.p),
+			   rel(t0,0) | rel(t1,1)) ;
 	}
 	
     } ;
 
-    Bang(Rpi::Peripheral *rpi)
-    : timer         (Rpi::ArmTimer(rpi))
-    , gpio(rpi->page<Rpi::Register::Gpio::PageNo>())
-    , t(timer.counter().read())
-    {}
+    Bang(Rpi::Peripheral *rpi) : core(Hw(rpi)) {}
+
+    // throws if a jump target is out of range; called by compile()
+    // and Enqueue::vector() (i.e. once per script, not per execute())
+    static void validate(std::vector<Command> const &v) ;
+
+    // the number of loops that may be nested
+    static constexpr unsigned MaxDepth = 4 ;
+
+    // the error code returned by execute() if the jitter bound got
+    // exceeded (don't use it for Assume)
+    static constexpr unsigned Preempted = ~0u ;
+
+    // track the gaps between the counter reads of a transaction (see
+    // Jitter); the transaction is aborted if the bound is exceeded
+    void monitor(Jitter *jitter)
+    {
+	this->core.monitor(jitter) ;
+    }
 
     void execute(Command const &c)
     {
-	using Choice = Command::Choice ;
-	switch (c.choice)
-	{
-	case Choice::Assume     :     assume(c.value.    assume) ; break ;
-	case Choice::Compare    :    compare(c.value.   compare) ; break ;
-	case Choice::Duration   :   duration(c.value.  duration) ; break ;
-	case Choice::Levels     :     levels(c.value.    levels) ; break ;
-	case Choice::Mode       :       mode(c.value.      mode) ; break ;
-	case Choice::Recent     :     recent(c.value.    recent) ; break ;
-	case Choice::Reset      :      reset(c.value.     reset) ; break ;
-	case Choice::Set        :        set(c.value.       set) ; break ;
-	case Choice::Sleep      :      sleep(c.value.     sleep) ; break ;
-	case Choice::Time       :       time(c.value.      time) ; break ;
-	case Choice::Wait       :       wait(c.value.      wait) ; break ;
-	case Choice::WaitFor    :    waitFor(c.value.   waitFor) ; break ;
-	default: assert(false) ; abort() ;
-	}
+	this->core.execute(c) ;
     }
     
     unsigned execute(std::vector<Command> const &v)
     {
-	this->error = 0 ;
-	for (auto const &c: v)
-	{
-	    this->execute(c) ;
-	    if (this->error != 0)
-		return this->error ;
-	}
-	return 0 ;
+	return this->core.execute(v) ;
     }
 
     struct Stack
@@ -348,10 +480,23 @@ struct Bang
 
 	std::vector<Command> vector() const
 	{
-	    return std::vector<Command>(q.begin(),q.end()) ;
+	    std::vector<Command> v(q.begin(),q.end()) ;
+	    validate(v) ;
+	    return v ;
 	}
+
+	uint32_t label() const
+	{
+	    return static_cast<uint32_t>(q.size()) ;
+	}
+	// ...the target of the next command to be enqueued
 	
-	void assume(uint32_t const *x,
+	void advance(ptrdiff_t stride)
+	{
+	    q.push_back(Command::advance(stride)) ;
+	}
+
+	void assume(Ptr<uint32_t const> x,
 		    Command::Op    op,
 		    uint32_t        y,
 		    unsigned    error)
@@ -359,24 +504,42 @@ struct Bang
 	    q.push_back(Command::assume(x,op,y,error)) ;
 	}
 
-	void compare(uint32_t const *x,
+	void branch(Ptr<uint32_t const> x,
+		    Command::Op    op,
+		    uint32_t        y,
+		    uint32_t   target)
+	{
+	    q.push_back(Command::branch(x,op,y,target)) ;
+	}
+
+	void compare(Ptr<uint32_t const> x,
 		     Command::Op    op,
 		     uint32_t        y,
-		     bool     *success)
+		     Ptr<bool> success)
 	{
 	    q.push_back(Command::compare(x,op,y,success)) ;
 	}
 
-	void duration(uint32_t *t0,uint32_t *t1,uint32_t *span)
+	void duration(Ptr<uint32_t> t0,Ptr<uint32_t> t1,Ptr<uint32_t> span)
 	{
 	    q.push_back(Command::duration(t0,t1,span)) ;
 	}
 
-	void levels(uint32_t *pins)
+	void jump(uint32_t target)
+	{
+	    q.push_back(Command::jump(target)) ;
+	}
+
+	void levels(Ptr<uint32_t> pins)
 	{
 	    q.push_back(Command::levels(pins)) ;
 	}
 
+	void loop(uint32_t count)
+	{
+	    q.push_back(Command::loop(count)) ;
+	}
+
 	void low(Rpi::Pin pin)
 	{
 	    q.push_back(Command::reset(1u<<pin.value())) ; // [todo] drop
@@ -388,16 +551,28 @@ struct Bang
 	    q.push_back(Command::mode(pin,mode)) ;
 	}
 
+	void mode(Rpi::Gpio::Function::Switch const &s)
+	{
+	    for (auto &u : s)
+		q.push_back(Command::mode(u)) ;
+	    // ...one command per touched GPFSEL register
+	}
+
 	void off(Rpi::Pin pin)
 	{
 	    q.push_back(Command::mode(pin,Rpi::Gpio::Function::Type::In)) ;
 	}
 
-	void recent(uint32_t *ticks)
+	void recent(Ptr<uint32_t> ticks)
 	{
 	    q.push_back(Command::recent(ticks)) ;
 	}
 
+	void repeat(uint32_t target)
+	{
+	    q.push_back(Command::repeat(target)) ;
+	}
+
 	void reset(uint32_t pins) 
 	{
 	    q.push_back(Command::reset(pins)) ;
@@ -413,143 +588,580 @@ struct Bang
 	    q.push_back(Command::sleep(span)) ;
 	}
     
-	void time(uint32_t *ticks)
+	void time(Ptr<uint32_t> ticks)
 	{
 	    q.push_back(Command::time(ticks)) ;
 	}
     
-	void wait(uint32_t const *t0,uint32_t span)
+	void wait(Ptr<uint32_t const> t0,uint32_t span)
 	{
 	    q.push_back(Command::wait(t0,span)) ;
 	}
 
-	void waitFor(uint32_t const *t0,
+	void waitFor(Ptr<uint32_t const> t0,
 		     uint32_t      span,
 		     Rpi::Pin       pin,
 		     bool          high,
-		     uint32_t       *t1)
+		     Ptr<uint32_t>   t1)
 	{
 	    auto mask = 1u<<pin.value() ;
 	    auto cond = high ? mask : 0u ;
 	    q.push_back(Command::waitFor(t0,span,mask,cond,t1)) ;
 	}
 	
-	void waitFor(uint32_t const *t0,
+	void waitFor(Ptr<uint32_t const> t0,
 		     uint32_t      span,
 		     uint32_t      mask,
 		     uint32_t      cond,
-		     uint32_t       *t1)
+		     Ptr<uint32_t>   t1)
 	{
 	    q.push_back(Command::waitFor(t0,span,mask,cond,t1)) ;
 	}
     } ;
   
+    // A Command vector lowered into a compact instruction stream
+    // ("threaded code"): each instruction carries the address of its
+    // handler (no dispatch switch), the comparison operators are
+    // resolved to dedicated handlers and the GPIO registers to plain
+    // pointers. The last instruction halts; so there is no bounds
+    // check either. Jumps are resolved to relative distances. The
+    // program is bound to the peripheral window of the Bang instance
+    // that compiled it.
+    
+    struct Program
+    {
+	struct Instruction ;
+	
+	using Handler = Instruction const* (*)(Bang*,Instruction const*) ;
+	// ...returns the next instruction (nullptr: stop)
+	
+	struct Instruction
+	{
+	    Handler f ;
+	    uint32_t volatile *r ; // register (if any)
+	    uint32_t const    *x ; // 1st operand (if any)
+	    uint32_t const    *y ; // 2nd operand (if any)
+	    union
+	    {
+		uint32_t *p ;
+		bool     *b ;
+	    } ;                    // result (if any)
+	    uint32_t u,v,w ;       // immediate operands (if any)
+	    ptrdiff_t d ;          // jump distance or stride (if any)
+	    ptrdiff_t mx,my,mp ;   // all ones if x,y,p is relative (else 0)
+	    // ...only looked at if the command has a relative pointer
+
+	    Instruction(Handler f) : f(f),r(nullptr),x(nullptr),y(nullptr),p(nullptr),u(0),v(0),w(0),d(0),mx(0),my(0),mp(0) {}
+	} ;
+
+	size_t size() const { return this->v.size() ; }
+	
+    private:
+
+	friend Bang ;
+
+	std::vector<Instruction> v ;
+    } ;
+
+    Program compile(std::vector<Command> const &v) ;
+
+    unsigned execute(Program const &program)
+    {
+	this->core.start() ;
+	auto ip = program.v.data() ;
+	do ip = ip->f(this,ip) ; while (ip != nullptr) ;
+	return this->core.error ;
+    }
+
+    // The interpreter of a script. The Port is the bus backend: the
+    // peripheral (see Hw below) or a virtual bus (see Virtual). It
+    // provides:
+    //
+    //   uint32_t counter() ; // read the ARM counter
+    //   uint32_t levels() ;  // read the GPIO levels
+    //   void set(uint32_t pins) ;
+    //   void reset(uint32_t pins) ;
+    //   void mode(Rpi::Gpio::Function::Update const&) ;
+    //   void idle(uint32_t t0,uint32_t span,bool levels) ;
+    //
+    // idle() is called by the busy-waits before each counter read
+    // (levels: the loop reads the levels as well). It may skip the
+    // iterations that can't see a change until t0+span.
+
+    template<typename Port> class Interpreter
+    {
+    public:
+
+	Interpreter(Port const &port)
+	    : port(port),t(this->port.counter()),l(0),error(0),offset(0)
+	    , pc(0),depth(0),relative(0),jitter(nullptr)
+	{}
+
+	// see Bang::monitor
+	void monitor(Jitter *jitter)
+	{
+	    this->jitter = jitter ;
+	}
+
+	void execute(Command const &c)
+	{
+	    using Choice = Command::Choice ;
+	    this->relative = c.relative ;
+	    switch (c.choice)
+	    {
+	    case Choice::Advance    :    advance(c.value.   advance) ; break ;
+	    case Choice::Assume     :     assume(c.value.    assume) ; break ;
+	    case Choice::Branch     :     branch(c.value.    branch) ; break ;
+	    case Choice::Compare    :    compare(c.value.   compare) ; break ;
+	    case Choice::Duration   :   duration(c.value.  duration) ; break ;
+	    case Choice::Jump       :       jump(c.value.      jump) ; break ;
+	    case Choice::Levels     :     levels(c.value.    levels) ; break ;
+	    case Choice::Loop       :       loop(c.value.      loop) ; break ;
+	    case Choice::Mode       :       mode(c.value.      mode) ; break ;
+	    case Choice::Recent     :     recent(c.value.    recent) ; break ;
+	    case Choice::Repeat     :     repeat(c.value.    repeat) ; break ;
+	    case Choice::Reset      :      reset(c.value.     reset) ; break ;
+	    case Choice::Set        :        set(c.value.       set) ; break ;
+	    case Choice::Sleep      :      sleep(c.value.     sleep) ; break ;
+	    case Choice::Time       :       time(c.value.      time) ; break ;
+	    case Choice::Wait       :       wait(c.value.      wait) ; break ;
+	    case Choice::WaitFor    :    waitFor(c.value.   waitFor) ; break ;
+	    default: assert(false) ; abort() ;
+	    }
+	}
+
+	// the script isn't validated (see Bang::validate): a jump
+	// target beyond the end just stops the script
+	unsigned execute(std::vector<Command> const &v)
+	{
+	    this->start() ;
+	    this->pc = 0 ;
+	    while (this->pc < v.size())
+	    {
+		this->execute(v[this->pc++]) ;
+		if (this->error != 0)
+		    return this->error ;
+	    }
+	    return 0 ;
+	}
+
+    private:
+
+	friend Bang ; // ...the Program's handlers
+
+	Port port ;
+
+	uint32_t t ; // last read time-stamp
+	uint32_t l ; // last read GPIO level
+
+	unsigned error ; // todo: provide script line & error message
+
+	ptrdiff_t offset ; // added to the relative data pointers (see Advance)
+
+	size_t pc ; // index of the next command (script)
+
+	struct Frame
+	{
+	    uint32_t count ; ptrdiff_t offset ; // ...when the loop opened
+	} ;
+	
+	Frame frame[MaxDepth] ; unsigned depth ; // the open loops
+
+	uint8_t relative ; // of the command in progress (see Command)
+
+	Jitter *jitter ; // optional (see monitor)
+
+	void start()
+	{
+	    this->error = 0 ;
+	    this->offset = 0 ;
+	    this->depth = 0 ;
+	    if (this->jitter != nullptr)
+		this->jitter->start(this->port.counter()) ;
+	}
+
+	// read the counter; false if preempted (see Jitter)
+	bool poll()
+	{
+	    this->t = this->port.counter() ;
+	    if (this->jitter == nullptr || this->jitter->next(this->t))
+		return true ;
+	    this->error = Preempted ;
+	    return false ;
+	}
+
+	// read the counter and restart the gap measurement (see Jitter)
+	void restart()
+	{
+	    this->t = this->port.counter() ;
+	    if (this->jitter != nullptr)
+		this->jitter->start(this->t) ;
+	}
+
+	// the k-th data pointer of the command in progress
+	template<typename T> T* rel(T *p,unsigned k) const
+	{
+	    return at(p,(this->relative & (1u << k)) ? -1 : 0) ;
+	}
+
+	// add the data offset if m is all ones (m is zero otherwise)
+	template<typename T> T* at(T *p,ptrdiff_t m) const
+	{
+	    return reinterpret_cast<T*>(reinterpret_cast<char*>(const_cast<typename std::remove_const<T>::type*>(p)) + (this->offset & m)) ;
+	}
+
+	void open(uint32_t count)
+	{
+	    if (this->depth == MaxDepth)
+		throw Error("loops nested too deep") ;
+	    this->frame[this->depth++] = Frame { count,this->offset } ;
+	}
+
+	// true if the innermost loop goes on (else it's closed); a
+	// Repeat without a Loop doesn't repeat
+	bool again()
+	{
+	    if (this->depth == 0)
+		return false ;
+	    auto &f = this->frame[this->depth-1] ;
+	    if (f.count > 1)
+	    {
+		--f.count ;
+		return true ;
+	    }
+	    this->offset = f.offset ;
+	    --this->depth ;
+	    return false ;
+	}
+
+	void advance(Command::Advance const &c)
+	{
+	    this->offset += c.stride ;
+	}
+
+	void assume(Command::Assume const &c)
+	{
+	    if (!test(*rel(c.x,0),c.op,c.y))
+		this->error = c.error ;
+	}
+
+	void branch(Command::Branch const &c)
+	{
+	    if (test(*rel(c.x,0),c.op,c.y))
+		this->pc = c.target ;
+	}
+
+	void compare(Command::Compare const &c)
+	{
+	    (*rel(c.success,1)) = test(*rel(c.x,0),c.op,c.y) ;
+	}
+
+	void duration(Command::Duration const &c)
+	{
+	    (*rel(c.span,2)) = (*rel(c.t1,1)) - (*rel(c.t0,0)) ;
+	}
+
+	void jump(Command::Jump const &c)
+	{
+	    this->pc = c.target ;
+	}
+
+	void levels(Command::Levels const &c)
+	{
+	    (*rel(c.pins,0)) = this->port.levels() ;
+	}
+
+	void loop(Command::Loop const &c)
+	{
+	    this->open(c.count) ;
+	}
+
+	void repeat(Command::Repeat const &c)
+	{
+	    if (this->again())
+		this->pc = c.target ;
+	}
+
+	void mode(Command::Mode const &c)
+	{
+	    this->port.mode(c.update) ;
+	}
+
+	void reset(Command::Reset const &c)
+	{
+	    this->port.reset(c.pins) ;
+	}
+
+	void set(Command::Set const &c)
+	{
+	    this->port.set(c.pins) ;
+	}
+
+	void time(Command::Time const &c)
+	{
+	    this->poll() ;
+	    (*rel(c.ticks,0)) = this->t ;
+	}
+
+	void recent(Command::Recent const &c)
+	{
+	    (*rel(c.ticks,0)) = this->t ;
+	}
+
+	void sleep(Command::Sleep const &c)
+	{
+	    if (c.span > 0)
+	    {
+		this->restart() ;
+		auto t0 = this->t ;
+		while (this->t - t0 < c.span)
+		{
+		    this->port.idle(t0,c.span,false) ;
+		    if (!this->poll())
+			return ;
+		}
+	    }
+	}
+
+	void wait(Command::Wait const &c)
+	{
+	    auto t0 = (*rel(c.t0,0)) ;
+	    while (this->t - t0 < c.span)
+	    {
+		this->port.idle(t0,c.span,false) ;
+		if (!this->poll())
+		    return ;
+	    }
+	}
+
+	void waitFor(Command::WaitFor const &c)
+	{
+	    auto t0 = (*rel(c.t0,0)) ;
+	    do
+	    {
+		this->l = this->port.levels() ;
+		if (c.cond == (this->l & c.mask))
+		{
+		    (*rel(c.t1,1)) = this->t ;
+		    this->restart() ;
+		    return ;
+		}
+		if (!this->poll())
+		    return ;
+		this->port.idle(t0,c.span,true) ;
+	    }
+	    while (this->t - t0 <= c.span) ;
+	}
+    } ;
+
+    // executes scripts in virtual time (see RpiExt/Sim/Bang.h)
+    struct Virtual ;
+
 private:
 
-    Rpi::ArmTimer timer ; 
-    Rpi::Register::Base<Rpi::Register::Gpio::PageNo> gpio ;
+    // the peripheral as bus backend (see Interpreter)
+    struct Hw
+    {
+	Hw(Rpi::Peripheral *rpi)
+	    : timer(rpi),gpio(rpi->page<Rpi::Register::Gpio::PageNo>())
+	    , p(timer.counter().p)
+	{}
 
-    uint32_t t ; // last read time-stamp
-    uint32_t l ; // last read GPIO level
+	uint32_t counter() const
+	{
+	    return (*this->p) ;
+	}
+
+	uint32_t levels()
+	{
+	    return (*this->gpio.at<Rpi::Register::Gpio::Input::Bank0>().value()) ;
+	}
+
+	void set(uint32_t pins)
+	{
+	    (*this->gpio.at<Rpi::Register::Gpio::Output::Raise0>().value()) = pins ;
+	}
 
-    unsigned error ; // todo: provide script line & error message
+	void reset(uint32_t pins)
+	{
+	    (*this->gpio.at<Rpi::Register::Gpio::Output::Clear0>().value()) = pins ;
+	}
+
+	void mode(Rpi::Gpio::Function::Update const &update)
+	{
+	    update.apply(this->gpio) ;
+	}
+
+	void idle(uint32_t,uint32_t,bool) {}
+	// ...nothing to skip in real time
+
+	Rpi::ArmTimer timer ;
+	Rpi::Register::Base<Rpi::Register::Gpio::PageNo> gpio ;
+	uint32_t volatile const *p ; // ARM counter (for Program)
+    } ;
 
-    void assume(Command::Assume const &c)
+    Interpreter<Hw> core ;
+
+    static bool test(uint32_t x,Command::Op op,uint32_t y)
     {
-	switch (c.op)
+	switch (op)
 	{
-	case Command::Op::Eq: if ((*c.x) == c.y) return ; break ;
-	case Command::Op::Ge: if ((*c.x) >= c.y) return ; break ;
-	case Command::Op::Gt: if ((*c.x) >  c.y) return ; break ;
-	case Command::Op::Le: if ((*c.x) <= c.y) return ; break ;
-	case Command::Op::Lt: if ((*c.x) <  c.y) return ; break ;
-	case Command::Op::Ne: if ((*c.x) != c.y) return ; break ;
+	case Command::Op::Eq: return x == y ;
+	case Command::Op::Ge: return x >= y ;
+	case Command::Op::Gt: return x >  y ;
+	case Command::Op::Le: return x <= y ;
+	case Command::Op::Lt: return x <  y ;
+	case Command::Op::Ne: return x != y ;
 	}
-	this->error = c.error ;
+	return false ;
     }
 
-    void compare(Command::Compare const &c)
+    // the Program's handlers
+
+    using Instruction = Program::Instruction ;
+
+    template<Command::Op op> static bool test(uint32_t x,uint32_t y)
     {
-	switch (c.op)
+	switch (op) // ...resolved at compile-time
 	{
-	case Command::Op::Eq: (*c.success) = (*c.x) == c.y ; break ;
-	case Command::Op::Ge: (*c.success) = (*c.x) >= c.y ; break ;
-	case Command::Op::Gt: (*c.success) = (*c.x) >  c.y ; break ;
-	case Command::Op::Le: (*c.success) = (*c.x) <= c.y ; break ;
-	case Command::Op::Lt: (*c.success) = (*c.x) <  c.y ; break ;
-	case Command::Op::Ne: (*c.success) = (*c.x) != c.y ; break ;
+	case Command::Op::Eq: return x == y ;
+	case Command::Op::Ge: return x >= y ;
+	case Command::Op::Gt: return x >  y ;
+	case Command::Op::Le: return x <= y ;
+	case Command::Op::Lt: return x <  y ;
+	case Command::Op::Ne: return x != y ;
 	}
+	return false ;
     }
 
-    void duration(Command::Duration const &c)
+    static Instruction const* xAdvance(Bang *self,Instruction const *i)
     {
-	(*c.span) = (*c.t1) - (*c.t0) ;
+	self->core.offset += i->d ;
+	return i+1 ;
     }
 
-    void levels(Command::Levels const &c)
+    // the data pointer plus the data offset if R (and p is relative)
+    template<bool R,typename T> static T* at(Bang *self,T *p,ptrdiff_t m)
     {
-	auto input = this->gpio.at<Rpi::Register::Gpio::Input::Bank0>().value() ;
-	(*c.pins) = (*input) ;
+	return R ? self->core.at(p,m) : p ;
     }
 
-    void mode(Command::Mode const &c)
+    template<Command::Op op,bool R> static Instruction const* xAssume(Bang *self,Instruction const *i)
     {
-	Rpi::Gpio::Function::set(this->gpio,c.pin,c.mode) ;
+	if (test<op>(*at<R>(self,i->x,i->mx),i->u))
+	    return i+1 ;
+	self->core.error = i->w ;
+	return (i->w == 0) ? i+1 : nullptr ;
+	// ...as execute(): an error code of zero doesn't stop
     }
 
-    void reset(Command::Reset const &c)
+    template<Command::Op op,bool R> static Instruction const* xBranch(Bang *self,Instruction const *i)
     {
-	auto clear = this->gpio.at<Rpi::Register::Gpio::Output::Clear0>().value() ;
-	(*clear) = c.pins ;
+	if (test<op>(*at<R>(self,i->x,i->mx),i->u))
+	    return i + i->d ;
+	return i+1 ;
     }
-    
-    void set(Command::Set const &c)
+
+    template<Command::Op op,bool R> static Instruction const* xCompare(Bang *self,Instruction const *i)
     {
-	auto raise = this->gpio.at<Rpi::Register::Gpio::Output::Raise0>().value() ;
-	(*raise) = c.pins ;
+	(*at<R>(self,i->b,i->mp)) = test<op>(*at<R>(self,i->x,i->mx),i->u) ;
+	return i+1 ;
     }
 
-    void time(Command::Time const &c)
+    template<bool R> static Instruction const* xDuration(Bang *self,Instruction const *i)
     {
-	(*c.ticks) = this->t = this->timer.counter().read() ;
+	(*at<R>(self,i->p,i->mp)) = (*at<R>(self,i->y,i->my)) - (*at<R>(self,i->x,i->mx)) ;
+	return i+1 ;
     }
 
-    void recent(Command::Recent const &c)
+    static Instruction const* xJump(Bang*,Instruction const *i)
     {
-	(*c.ticks) = this->t ;
+	return i + i->d ;
     }
 
-    void sleep(Command::Sleep const &c)
+    template<bool R> static Instruction const* xLevels(Bang *self,Instruction const *i)
     {
-	if (c.span > 0)
-	{
-	    auto t0 = this->t = this->timer.counter().read() ;
-	    while (this->t - t0 < c.span)
-		this->t = this->timer.counter().read() ;
-	}
+	(*at<R>(self,i->p,i->mp)) = (*i->r) ;
+	return i+1 ;
     }
 
-    void wait(Command::Wait const &c)
+    static Instruction const* xLoop(Bang *self,Instruction const *i)
     {
-	while (this->t - (*c.t0) < c.span) 
-	    this->t = this->timer.counter().read() ;
+	self->core.open(i->u) ;
+	return i+1 ;
     }
-    
-    void waitFor(Command::WaitFor const &c)
+
+    static Instruction const* xModify(Bang*,Instruction const *i)
+    {
+	(*i->r) = ((*i->r) & i->u) | i->v ;
+	return i+1 ;
+    }
+
+    template<bool R> static Instruction const* xRecent(Bang *self,Instruction const *i)
+    {
+	(*at<R>(self,i->p,i->mp)) = self->core.t ;
+	return i+1 ;
+    }
+
+    static Instruction const* xRepeat(Bang *self,Instruction const *i)
+    {
+	return self->core.again() ? i + i->d : i+1 ;
+    }
+
+    static Instruction const* xStore(Bang*,Instruction const *i)
+    {
+	(*i->r) = i->u ; // Reset, Set and Mode (if frozen)
+	return i+1 ;
+    }
+
+    static Instruction const* xSleep(Bang *self,Instruction const *i)
     {
-	auto input = this->gpio.at<Rpi::Register::Gpio::Input::Bank0>().value() ;
+	self->core.restart() ;
+	auto t0 = self->core.t ;
+	while (self->core.t - t0 < i->u)
+	    if (!self->core.poll())
+		return nullptr ;
+	return i+1 ;
+    }
+
+    template<bool R> static Instruction const* xTime(Bang *self,Instruction const *i)
+    {
+	auto success = self->core.poll() ;
+	(*at<R>(self,i->p,i->mp)) = self->core.t ;
+	return success ? i+1 : nullptr ;
+    }
+
+    template<bool R> static Instruction const* xWait(Bang *self,Instruction const *i)
+    {
+	auto t0 = (*at<R>(self,i->x,i->mx)) ;
+	while (self->core.t - t0 < i->u) 
+	    if (!self->core.poll())
+		return nullptr ;
+	return i+1 ;
+    }
+
+    template<bool R> static Instruction const* xWaitFor(Bang *self,Instruction const *i)
+    {
+	auto t0 = (*at<R>(self,i->x,i->mx)) ;
 	do
 	{
-	    this->l = (*input) ;
-	    if (c.cond == (this->l & c.mask))
+	    self->core.l = (*i->r) ;
+	    if (i->w == (self->core.l & i->v))
 	    {
-		(*c.t1) = this->t ;
-		this->t = this->timer.counter().read() ;
-		return ;
+		(*at<R>(self,i->p,i->mp)) = self->core.t ;
+		self->core.restart() ;
+		return i+1 ;
 	    }
-	    this->t = this->timer.counter().read() ;
+	    if (!self->core.poll())
+		return nullptr ;
 	}
-	while (this->t - (*c.t0) <= c.span) ;
+	while (self->core.t - t0 <= i->u) ;
+	return i+1 ;
+    }
+
+    static Instruction const* xHalt(Bang*,Instruction const*)
+    {
+	return nullptr ;
     }
     
 } ; }
@@ -6,6 +6,7 @@
 #include <arm/arm.h>
 #include <Rpi/ArmTimer.h>
 #include <Rpi/Gpio/Function.h>
+#include <RpiExt/Jitter.h>
 
 namespace RpiExt {
 
@@ -58,6 +59,35 @@ struct BangIo
 	Rpi::Gpio::Function::set(this->gpio,pin,mode) ;
     }
 
+    void mode(Rpi::Gpio::Function::Update const &update)
+    {
+	update.apply(this->gpio) ;
+    }
+
+    void mode(Rpi::Gpio::Function::Switch const &s)
+    {
+	s.apply(this->gpio) ;
+    }
+
+    // track the gaps between counter reads in busy-waits (see
+    // Jitter); if the bound is exceeded, all waits return immediately
+    // until resume() is called
+    void monitor(Jitter *jitter)
+    {
+	this->jitter = jitter ;
+	this->overrun = false ;
+    }
+
+    bool preempted() const
+    {
+	return this->overrun ;
+    }
+
+    void resume()
+    {
+	this->overrun = false ;
+    }
+
     uint32_t recent() const
     {
 	return this->t ;
@@ -79,21 +109,26 @@ struct BangIo
     {
 	if (span > 0)
 	{
-	    auto t0 = this->t = this->timer.counter().read() ;
+	    auto t0 = this->time() ;
 	    while (this->t - t0 < span)
-		this->t = this->timer.counter().read() ;
+		if (!this->poll())
+		    return ;
 	}
     }
 
     uint32_t time()
     {
-	return this->t = this->timer.counter().read() ;
+	this->t = this->timer.counter().read() ;
+	if (this->jitter != nullptr)
+	    this->jitter->start(this->t) ;
+	return this->t ;
     }
 
     void wait(uint32_t t0,uint32_t span)
     {
 	while (this->t - t0 < span) 
-	    this->t = this->timer.counter().read() ;
+	    if (!this->poll())
+		return ;
     }
     
     uint32_t waitForEvent(uint32_t t0,uint32_t span,uint32_t mask)
@@ -109,7 +144,8 @@ struct BangIo
 		return events ;
 	    }
 	    arm::dmb() ; // since we got strange values
-	    this->t = this->timer.counter().read() ;
+	    if (!this->poll())
+		return 0 ;
 	}
 	while (this->t - t0 <= span) ;
 	return 0 ;
@@ -126,17 +162,14 @@ struct BangIo
 	    if (cond == (l & mask))
 	    {
 		auto tx = this->t ;
-		this->t = this->timer.counter().read() ;
+		this->time() ;
 		return tx ;
 	    }
-	    this->t = this->timer.counter().read() ;
+	    if (!this->poll())
+		return this->t ;
 	}
 	while (this->t - t0 <= span) ;
 	return this->t ;
-	// [todo] we might want to record also the gap between two
-	// subsequent timings and return the maximum of these values
-	// in order to ease the detection of involuntary context
-	// switches or other kinds of thread interruption
     }
 
     BangIo(Rpi::Peripheral *rpi)
@@ -144,6 +177,8 @@ struct BangIo
 	, gpio(rpi->page<Rpi::Register::Gpio::PageNo>())
 	  
 	, t         (timer.counter().read())
+	, jitter                   (nullptr)
+	, overrun                    (false)
 	{ }
 
 private:
@@ -154,6 +189,19 @@ private:
 
     uint32_t t ; // last read time-stamp
     uint32_t l ; // last read GPIO level
+
+    Jitter *jitter ; // optional (see monitor)
+    
+    bool overrun ; // the jitter bound got exceeded
+
+    // read the counter in a busy-wait; false if preempted
+    bool poll()
+    {
+	this->t = this->timer.counter().read() ;
+	if (this->jitter != nullptr && !this->jitter->next(this->t))
+	    this->overrun = true ;
+	return !this->overrun ;
+    }
 } ; }
 	
 #endif // INCLUDE_RpiExt_BangIo_h
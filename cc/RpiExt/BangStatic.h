@@ -0,0 +1,154 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// Compile-time bit-banging scripts: the counterpart to RpiExt::Bang
+// for transactions whose sequence is fixed. A script is a type (a
+// sequence of operations), which is expanded (and inlined) by the
+// compiler; that is, there is no interpreter at all.
+//
+// The operations refer by index to values that are only known at
+// run-time: pin masks, time spans (ticks) and data words. All of
+// them are provided by the Context. Data bits (e.g. a channel
+// number or a 16-bit word to shift-out) go into Context::data.
+//
+// Example (shift-out the 4 lower bits of data, MSB first):
+//
+//   enum { Clk,Din } ; enum { Hi,Lo } ;
+//   template<unsigned I> using Bit = Seq<
+//     Put<Din,3-I>,Sleep<Lo>,Set<Clk>,Sleep<Hi>,Reset<Clk>> ;
+//   using Script = For<Bit,0,4> ;
+//   ...
+//   Script::run(context) ;
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_RpiExt_BangStatic_h
+#define INCLUDE_RpiExt_BangStatic_h
+
+#include <Rpi/ArmTimer.h>
+#include <Rpi/Peripheral.h>
+
+namespace RpiExt { namespace BangStatic {
+
+struct Context
+{
+    Context(Rpi::Peripheral *rpi,
+	    uint32_t const *pins,
+	    uint32_t const *ticks,
+	    uint32_t        *vars)
+	: raise  (rpi->at<Rpi::Register::Gpio::Output::Raise0>().value())
+	, clear  (rpi->at<Rpi::Register::Gpio::Output::Clear0>().value())
+	, level  (rpi->at<Rpi::Register::Gpio:: Input:: Bank0>().value())
+	, counter(Rpi::ArmTimer(rpi).counter().p)
+	, pins(pins),ticks(ticks),vars(vars),data(0)
+	, t(*counter)
+	{ }
+
+    uint32_t volatile       *  raise ;
+    uint32_t volatile       *  clear ;
+    uint32_t volatile const *  level ;
+    uint32_t volatile const *counter ;
+
+    uint32_t const * pins ; // pin masks
+    uint32_t const *ticks ; // time spans
+    uint32_t       * vars ; // data words (results and time-stamps)
+
+    uint32_t data ; // variable data bits (see Put)
+
+    uint32_t t ; // last read time-stamp
+} ;
+
+// ---- primitive operations ----
+
+template<unsigned P> struct Set // set pins[P] High
+{
+    static void run(Context &c) { (*c.raise) = c.pins[P] ; }
+} ;
+
+template<unsigned P> struct Reset // set pins[P] Low
+{
+    static void run(Context &c) { (*c.clear) = c.pins[P] ; }
+} ;
+
+template<unsigned P,unsigned B> struct Put // set pins[P] to data bit B
+{
+    static void run(Context &c)
+    {
+	if (c.data & (1u << B)) (*c.raise) = c.pins[P] ;
+	else                    (*c.clear) = c.pins[P] ;
+    }
+} ;
+
+template<unsigned V> struct Levels // vars[V] := pin levels
+{
+    static void run(Context &c) { c.vars[V] = (*c.level) ; }
+} ;
+
+template<unsigned V> struct Time // vars[V] := current time
+{
+    static void run(Context &c) { c.vars[V] = c.t = (*c.counter) ; }
+} ;
+
+template<unsigned V> struct Recent // vars[V] := last read time
+{
+    static void run(Context &c) { c.vars[V] = c.t ; }
+} ;
+
+template<unsigned T> struct Sleep // for ticks[T] based on current time
+{
+    static void run(Context &c)
+    {
+	if (c.ticks[T] == 0)
+	    return ; // ...as RpiExt::Bang
+	auto t0 = c.t = (*c.counter) ;
+	while (c.t - t0 < c.ticks[T])
+	    c.t = (*c.counter) ;
+    }
+} ;
+
+template<unsigned V,unsigned T> struct Wait // until vars[V] + ticks[T]
+{
+    static void run(Context &c)
+    {
+	auto t0 = c.vars[V] ;
+	while (c.t - t0 < c.ticks[T])
+	    c.t = (*c.counter) ;
+    }
+} ;
+
+// ---- composition ----
+
+struct Nop
+{
+    static void run(Context&) {}
+} ;
+
+template<typename... Ops> struct Seq ;
+
+template<> struct Seq<>
+{
+    static void run(Context&) {}
+} ;
+
+template<typename Op,typename... Ops> struct Seq<Op,Ops...>
+{
+    static void run(Context &c) { Op::run(c) ; Seq<Ops...>::run(c) ; }
+} ;
+
+template<bool B,typename Op> struct If // compile-time condition
+{
+    static void run(Context &c) { Op::run(c) ; }
+} ;
+
+template<typename Op> struct If<false,Op> : Nop {} ;
+
+template<template<unsigned> class F,unsigned I,unsigned N> struct For
+{
+    // F<I>,F<I+1>,...,F<N-1>
+    static void run(Context &c) { F<I>::run(c) ; For<F,I+1,N>::run(c) ; }
+} ;
+
+template<template<unsigned> class F,unsigned N> struct For<F,N,N> : Nop {} ;
+
+} }
+
+#endif // INCLUDE_RpiExt_BangStatic_h
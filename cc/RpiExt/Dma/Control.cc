@@ -1,7 +1,6 @@
 // BSD 2-Clause License, see github.com/ma16/rpio
 
 #include "Control.h"
-#include <iomanip>
 
 void RpiExt::Dma::Control::add(Rpi::Dma::Ti::Word ti,
 			       Rpi::Bus::Address src,
@@ -29,24 +28,12 @@ void RpiExt::Dma::Control::add(Rpi::Dma::Ti::Word ti,
 			       uint32_t       nbytes,
 			       uint32_t       stride)
 {
-    auto block = this->allocator->allocate(32) ; 
-
-    auto p = block->as<uint32_t volatile(*)[8]>() ;
-    (*p)[0] = ti.value() ;
-    (*p)[1] = src.value() ;
-    (*p)[2] = dst.value() ;
-    (*p)[3] = nbytes ;
-    (*p)[4] = stride ;
-    (*p)[5] = 0 ; // next block
-    (*p)[6] = 0 ; // Reserved - set to zero.
-    (*p)[7] = 0 ; // Reserved - set to zero.
+    auto block = this->pool->allocate() ;
+    block.set(ti,src,dst,nbytes,stride) ;
     
     // link previous block (if any)
     if (!this->blocks.empty())
-    {
-	auto p = this->blocks.back()->as<uint32_t volatile(*)[8]>() ;
-	(*p)[5] = block->phys(0).first.value() ;
-    }
+	this->blocks.back().link(block) ;
 
     blocks.push_back(block) ;
     
@@ -3,20 +3,19 @@
 // --------------------------------------------------------------------
 // This is a very limited implementation to manage DMA control-blocks.
 // 
-// It is based on blocks of Rpi::Bus::Memory. Such a block is allocated
-// for each DMA-control-block. Also, such a block is required to define
-// a buffer that shall be transferred to or from a peripheral.
-//
-// Since Rpi::Bus::Memory comes in size of pages, there will be quite
-// some waste due to the low payload ratio.
+// The control-blocks are taken from a Dma::Pool (i.e. packed into
+// pages of Rpi::Bus::Memory). A block of Rpi::Bus::Memory is still
+// required to define a buffer that shall be transferred to or from a
+// peripheral.
 // --------------------------------------------------------------------
 
 #ifndef INCLUDE_RpiExt_Dma_Control_h
 #define INCLUDE_RpiExt_Dma_Control_h
 
-#include <deque>
+#include "Pool.h"
 #include <Rpi/Bus/Memory.h>
 #include <Rpi/Dma.h>
+#include <vector>
 
 namespace RpiExt { namespace Dma {
 
@@ -29,8 +28,17 @@ struct Control
 
     using Allocator = Rpi::Bus::Memory::Allocator ;
 	
-    Control(Allocator::shared_ptr allocator) : allocator(allocator) {}
+    Control(Allocator::shared_ptr allocator)
+	: pool(std::make_shared<Pool>(allocator)) {}
     // ...the allocator is used to allocate DMA control blocks
+
+    Control(Pool::shared_ptr pool) : pool(pool) {}
+    // ...the blocks are returned to the pool on destruction
+
+    ~Control() { this->pool->release(this->blocks) ; }
+
+    Control(Control const&) = delete ;
+    Control& operator=(Control const&) = delete ;
   
     // read buffer from peripheral (register)
     void add(Rpi::Dma::Ti::Word ti,
@@ -47,14 +55,14 @@ struct Control
     {
 	if (blocks.empty())
 	    throw Error("empty list of control-blocks") ;
-	return blocks.front()->phys(0).first ;
+	return blocks.front().addr ;
     }
   
 private:
   
-    Allocator::shared_ptr allocator ;
+    Pool::shared_ptr pool ;
 
-    std::deque<Rpi::Bus::Memory::shared_ptr> blocks ;
+    std::vector<Pool::Cb> blocks ;
 
     void add(Rpi::Dma::Ti::Word ti,
 	     Rpi::Bus::Address src,
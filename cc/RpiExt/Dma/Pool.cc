@@ -0,0 +1,77 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Pool.h"
+
+using Pool = RpiExt::Dma::Pool ;
+
+Pool::Pool(Allocator::shared_ptr allocator,size_t chunk)
+    : allocator(allocator),chunk(chunk),nblocks(0)
+{
+    if (chunk == 0)
+	throw Error("chunk size must not be zero") ;
+}
+
+Pool::Cb Pool::allocate()
+{
+    if (this->free.empty())
+	this->grow(1) ;
+    auto cb = this->free.back() ;
+    this->free.pop_back() ;
+    cb.unlink() ;
+    return cb ;
+}
+
+std::vector<Pool::Cb> Pool::allocate(size_t n)
+{
+    if (this->free.size() < n)
+	this->grow(n - this->free.size()) ;
+    std::vector<Cb> chain ; chain.reserve(n) ;
+    for (size_t i=0 ; i<n ; ++i)
+    {
+	chain.push_back(this->free.back()) ;
+	this->free.pop_back() ;
+    }
+    relink(chain) ;
+    return chain ;
+}
+
+void Pool::release(Cb const &cb)
+{
+    this->free.push_back(cb) ;
+}
+
+void Pool::release(std::vector<Cb> const &chain)
+{
+    // reverse order: a later allocate(n) gets the same sequence
+    for (auto i=chain.rbegin() ; i!=chain.rend() ; ++i)
+	this->free.push_back(*i) ;
+}
+
+void Pool::relink(std::vector<Cb> const &chain)
+{
+    for (size_t i=1 ; i<chain.size() ; ++i)
+	chain[i-1].link(chain[i]) ;
+    if (!chain.empty())
+	chain.back().unlink() ;
+}
+
+void Pool::grow(size_t n)
+{
+    if (n < this->chunk)
+	n = this->chunk ;
+    auto memory = this->allocator->allocate(32 * n) ;
+    auto p = memory->as<uint32_t volatile*>() ;
+    // the blocks are pushed in reverse order, so they are popped in
+    // ascending order (i.e. consecutive in memory)
+    for (size_t i=n ; i>0 ; --i)
+    {
+	auto section = memory->phys(32 * (i-1)) ;
+	if ((section.first.value() & 0x1f) != 0)
+	    throw Error("control block not 32-byte aligned") ;
+	if (section.second < 32)
+	    throw Error("control block not contiguous in bus memory") ;
+	this->free.push_back(Cb(p + 8 * (i-1),section.first)) ;
+    }
+    this->chunks.push_back(memory) ;
+    this->nblocks += n ;
+}
@@ -0,0 +1,103 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// A pool of DMA control-blocks.
+//
+// Rpi::Bus::Memory is allocated in large chunks (of pages) which are
+// carved into 32-byte control-blocks. Released blocks are put on a
+// free list and reused. Hence, a chain of thousands of blocks takes
+// a few kilobytes (instead of a page per block) and only a few TLB
+// entries.
+//
+// The blocks are written in place (in bus memory); the pool doesn't
+// keep any copy. Linking and relinking just updates the NEXTCONBK
+// word of a block.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_RpiExt_Dma_Pool_h
+#define INCLUDE_RpiExt_Dma_Pool_h
+
+#include <Rpi/Bus/Memory.h>
+#include <Rpi/Dma.h>
+#include <vector>
+
+namespace RpiExt { namespace Dma {
+
+struct Pool
+{
+    struct Error : Neat::Error
+    {
+	Error(std::string const &s) : Neat::Error("RpiExt:Dma:Pool:" + s) {}
+    } ;
+
+    using Allocator = Rpi::Bus::Memory::Allocator ;
+
+    using shared_ptr = std::shared_ptr<Pool> ;
+
+    Pool(Allocator::shared_ptr allocator,size_t chunk=128) ;
+    // ...chunk: the (minimum) number of blocks per allocation; the
+    // default (128 x 32 bytes) makes a page
+
+    struct Cb // a control-block in the pool
+    {
+	uint32_t volatile *p ; // virtual address of the 8 words
+	Rpi::Bus::Address addr ; // bus address
+
+	Cb(uint32_t volatile *p,Rpi::Bus::Address addr) : p(p),addr(addr) {}
+
+	void set(Rpi::Dma::Ti::Word ti,
+		 Rpi::Bus::Address src,
+		 Rpi::Bus::Address dst,
+		 uint32_t nbytes,
+		 uint32_t stride=0) const
+	{
+	    p[0] = ti.value() ;
+	    p[1] = src.value() ;
+	    p[2] = dst.value() ;
+	    p[3] = nbytes ;
+	    p[4] = stride ;
+	    p[5] = 0 ; // next block
+	    p[6] = 0 ; // Reserved - set to zero.
+	    p[7] = 0 ; // Reserved - set to zero.
+	}
+
+	void link(Cb const &next) const { p[5] = next.addr.value() ; }
+
+	void unlink() const { p[5] = 0 ; } // ...end of chain
+    } ;
+
+    // get a single (unlinked) block
+    Cb allocate() ;
+
+    // get n blocks linked in order (the last one terminates the
+    // chain); blocks of a fresh chunk are consecutive in memory
+    std::vector<Cb> allocate(size_t n) ;
+
+    // return block(s) to the free list; the DMA must not use them
+    // anymore
+    void release(Cb const &cb) ;
+    void release(std::vector<Cb> const &chain) ;
+
+    // link the blocks in the given order (the last one terminates)
+    static void relink(std::vector<Cb> const &chain) ;
+
+    size_t capacity() const { return this->nblocks ; }
+
+    size_t available() const { return this->free.size() ; }
+
+private:
+
+    Allocator::shared_ptr allocator ; size_t chunk ;
+
+    std::vector<Rpi::Bus::Memory::shared_ptr> chunks ;
+
+    std::vector<Cb> free ; // in reverse order of allocation
+
+    size_t nblocks ;
+
+    void grow(size_t n) ;
+} ;
+
+} }
+
+#endif // INCLUDE_RpiExt_Dma_Pool_h
@@ -0,0 +1,91 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// Records the gaps between subsequent ARM counter reads in busy-wait
+// loops (see Bang, BangIo and Serialize).
+//
+// A busy-wait reads the counter every few cycles. A large gap means
+// the thread got suspended (involuntary context switch, interrupt,
+// cache or TLB fault). If the gap exceeds the bound, the transaction
+// is aborted early (instead of running to completion with a corrupt
+// timing).
+//
+// The gaps are collected in a histogram of 33 buckets: bucket 0 for
+// a gap of zero ticks and bucket i for gaps in [2^(i-1),2^i).
+//
+// The measurement is restarted (i.e. the gap is not recorded) at the
+// start of a transaction, at the first read of a Sleep and at the read
+// that follows a matched level (WaitFor); the level got already caught
+// then. All other reads in busy-waits are recorded.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_RpiExt_Jitter_h
+#define INCLUDE_RpiExt_Jitter_h
+
+#include <cstdint>
+#include <cstring>
+
+namespace RpiExt {
+
+struct Jitter
+{
+    static constexpr unsigned Buckets = 33 ;
+
+    // bound: maximum gap (ticks) tolerated; zero for no limit
+    Jitter(uint32_t bound=0) : bound(bound) { this->reset() ; }
+
+    uint32_t bound ;
+
+    // clear statistics
+    void reset()
+    {
+	this->last = 0 ;
+	this->max_ = 0 ;
+	this->count_ = 0 ;
+	std::memset(this->hist,0,sizeof(this->hist)) ;
+    }
+
+    // (re)start gap measurement at time-stamp t
+    void start(uint32_t t)
+    {
+	this->last = t ;
+    }
+
+    // record the gap to time-stamp t; false if the bound is exceeded
+    bool next(uint32_t t)
+    {
+	auto gap = t - this->last ;
+	this->last = t ;
+	++this->hist[bucket(gap)] ;
+	++this->count_ ;
+	if (this->max_ < gap)
+	    this->max_ = gap ;
+	return (this->bound == 0) || (gap <= this->bound) ;
+    }
+
+    uint32_t max() const { return this->max_ ; }
+
+    uint64_t count() const { return this->count_ ; }
+
+    uint64_t histogram(unsigned i) const { return this->hist[i] ; }
+
+    static unsigned bucket(uint32_t gap)
+    {
+	if (gap == 0)
+	    return 0 ;
+	return 32u - static_cast<unsigned>(__builtin_clz(gap)) ;
+    }
+
+private:
+
+    uint32_t last ; // last read time-stamp
+    uint32_t max_ ; // largest gap so far
+
+    uint64_t count_ ; // number of gaps
+
+    uint64_t hist[Buckets] ;
+} ;
+
+}
+
+#endif // INCLUDE_RpiExt_Jitter_h
@@ -2,9 +2,10 @@
 
 // --------------------------------------------------------------------
 // PWM can be employed in DMA or Poll mode. Here, PWM is used in Poll
-// mode only. That is, the FIFO is topped-up whenever there is space
-// until all data has been written. The status of the FIFO is polled
-// in a busy loop to detect whether there is space or not.
+// mode (except for Pwm::Stream). That is, the FIFO is topped-up
+// whenever there is space until all data has been written. The status
+// of the FIFO is polled in a busy loop to detect whether there is
+// space or not.
 //
 // All the functions here assume that PWM is properly set-up. That
 // includes an enabled peripheral (PWEN=1).
@@ -55,6 +56,9 @@ struct Pwm
     // set control register and repeat until BERR=0
     void setControl(typename Rpi::Register::Pwm::Control::Traits::WriteWord w) ;
 
+    struct Stream ;
+    // ...continuous transfer by DMA (see RpiExt/PwmStream.h)
+
     Pwm(Rpi::Peripheral *rpi)
 	: timer(rpi)
 	, base(rpi->page<Rpi::Register::Pwm::PageNo>()) {}
@@ -0,0 +1,145 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "PwmStream.h"
+
+using Stream = RpiExt::Pwm::Stream ;
+
+Stream::Stream(Rpi::Peripheral *rpi,
+	       Rpi::Dma::Ctrl::Index index,
+	       Rpi::Bus::Memory::Allocator *allocator,
+	       size_t nbuffers,
+	       size_t nwords)
+    : memory(allocator->allocate(4 * nbuffers * nwords))
+    , channel(Rpi::Dma::Ctrl(rpi).channel(index))
+    , n(nwords),m(nbuffers),running(false)
+    , head(0),tail(0),underrun(0),low(nbuffers)
+{
+    if (nbuffers < 2)
+	throw Error("at least two buffers are required") ;
+    if (nwords == 0 || nwords >= (1u << 28))
+	throw Error("buffer size out of range") ;
+    // ...TXFR_LEN is 30 bits wide
+
+    // each buffer is split into sections of contiguous bus memory
+    struct Section { size_t buffer ; uint32_t addr ; uint32_t nbytes ; } ;
+    std::vector<Section> sections ;
+    for (size_t i=0 ; i<nbuffers ; ++i)
+    {
+	auto ofs = 4 * nwords * i ;
+	auto end = ofs + 4 * nwords ;
+	while (ofs < end)
+	{
+	    auto phys = this->memory->phys(ofs) ;
+	    if (phys.second == 0)
+		throw Error("buffer not in bus memory") ;
+	    auto nbytes = (phys.second < end - ofs) ? phys.second : end - ofs ;
+	    sections.push_back({ i,phys.first.value(),static_cast<uint32_t>(nbytes) }) ;
+	    ofs += nbytes ;
+	}
+    }
+
+    // one control block per section; the last one links to the first
+    this->blocks = allocator->allocate(32 * sections.size()) ;
+    for (size_t i=0 ; i<sections.size() ; ++i)
+    {
+	auto phys = this->blocks->phys(32 * i) ;
+	if ((phys.first.value() & 0x1f) != 0 || phys.second < 32)
+	    throw Error("control block not 32-byte aligned") ;
+	this->cbAddr.push_back(phys.first.value()) ;
+	this->cbBuffer.push_back(sections[i].buffer) ;
+    }
+    auto ti = Rpi::Dma::Ti::make(Rpi::Dma::Ti::Pwm) ;
+    auto cb = this->blocks->as<uint32_t volatile*>() ;
+    for (size_t i=0 ; i<sections.size() ; ++i,cb+=8)
+    {
+	cb[0] = ti.value() ;
+	cb[1] = sections[i].addr ;
+	cb[2] = Rpi::Register::Pwm::Fifo::Address.value() ;
+	cb[3] = sections[i].nbytes ;
+	cb[4] = 0 ;
+	cb[5] = this->cbAddr[(i+1) % sections.size()] ; // ...a ring
+	cb[6] = 0 ;
+	cb[7] = 0 ;
+    }
+    
+    this->buffer = this->memory->as<uint32_t volatile*>() ;
+    for (size_t i=0 ; i<nbuffers*nwords ; ++i)
+	this->buffer[i] = 0 ;
+}
+
+size_t Stream::space() const
+{
+    // when running, the buffer in progress can't be filled
+    auto next = this->running && (this->tail <= this->head)
+	? this->head + 1 : this->tail ;
+    auto limit = this->running
+	? this->head + this->nbuffers() : this->nbuffers() ;
+    return (limit > next) ? static_cast<size_t>(limit - next) : 0 ;
+}
+
+bool Stream::put(uint32_t const *words)
+{
+    if (this->space() == 0)
+	return false ;
+    if (this->running && (this->tail <= this->head))
+	this->tail = this->head + 1 ;
+    // ...skip the buffers the DMA has already passed
+    auto p = this->buffer + (this->tail % this->nbuffers()) * this->n ;
+    for (size_t i=0 ; i<this->n ; ++i)
+	p[i] = words[i] ;
+    ++this->tail ;
+    return true ;
+}
+
+void Stream::start(Rpi::Dma::Cs cs)
+{
+    if (this->running)
+	throw Error("already running") ;
+    this->channel.setup(Rpi::Bus::Address(this->cbAddr[0]),cs) ;
+    this->head = 0 ;
+    this->running = true ;
+    this->channel.start() ;
+}
+
+void Stream::stop()
+{
+    this->channel.stop() ;
+    this->running = false ;
+    this->head = this->tail = 0 ;
+}
+
+Stream::Status Stream::poll()
+{
+    if (this->running)
+    {
+	auto addr = this->channel.getCb().value() ;
+	auto nbuffers = this->nbuffers() ;
+	for (size_t i=0 ; i<this->cbAddr.size() ; ++i)
+	{
+	    if (this->cbAddr[i] != addr)
+		continue ;
+	    auto k = this->cbBuffer[i] ;
+	    auto cur = this->head % nbuffers ;
+	    auto next = this->head + (k + nbuffers - cur) % nbuffers ;
+	    // ...complete turns in between can't be detected
+	    if (next >= this->tail && next > this->head)
+	    {
+		// the DMA entered buffers that weren't refilled
+		auto from = (this->tail > this->head) ? this->tail : this->head + 1 ;
+		this->underrun += next + 1 - from ;
+	    }
+	    this->head = next ;
+	    break ;
+	}
+	// ...the address may be zero (DMA stopped) or in transition
+    }
+    Status status ;
+    status.played = this->head ;
+    status.underrun = this->underrun ;
+    status.headroom = (this->tail > this->head + 1)
+	? static_cast<size_t>(this->tail - this->head - 1) : 0 ;
+    if (this->running && status.headroom < this->low)
+	this->low = status.headroom ;
+    status.low = this->low ;
+    return status ;
+}
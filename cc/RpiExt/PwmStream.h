@@ -0,0 +1,101 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// Continuous PWM output by DMA: a ring of N buffers (of the same size)
+// with one control block per section of contiguous bus memory (that is
+// usually one per buffer); the last block links to the first one.
+// Hence, the DMA never stops (and never needs to be restarted).
+//
+// The producer refills the buffers behind the DMA's read position.
+// The read position is derived from the channel's CONBLK_AD register
+// (the block in progress, hence its buffer) whenever the stream is
+// polled. The stream must be polled at least once per turn of the
+// ring; otherwise turns are missed.
+//
+// If the DMA enters a buffer that wasn't refilled since the last turn
+// (an underrun), the old data is sent again. Such buffers are counted
+// and skipped by the producer.
+//
+// The PWM must be set up beforehand: serializer (or PWM) mode, USEF=1,
+// DMA enabled (DMAC.ENAB=1) and a sensible DREQ threshold.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_RpiExt_PwmStream_h
+#define INCLUDE_RpiExt_PwmStream_h
+
+#include "Pwm.h"
+#include <Rpi/Bus/Memory.h>
+#include <Rpi/Dma/Ctrl.h>
+#include <vector>
+
+namespace RpiExt {
+
+struct Pwm::Stream
+{
+    struct Error : Neat::Error
+    {
+	Error(std::string const &s) : Neat::Error("RpiExt:Pwm:Stream:" + s) {}
+    } ;
+
+    Stream(Rpi::Peripheral *rpi,
+	   Rpi::Dma::Ctrl::Index index,
+	   Rpi::Bus::Memory::Allocator *allocator,
+	   size_t nbuffers,
+	   size_t nwords) ;
+    // ...the buffers are initialized with zeros
+
+    // copy nwords to the next buffer; returns false if there is none
+    // (i.e. all the buffers ahead of the DMA are filled)
+    bool put(uint32_t const *words) ;
+
+    // the number of buffers that can be filled now
+    size_t space() const ;
+
+    // start the DMA at the first buffer (the buffers may be filled
+    // before)
+    void start(Rpi::Dma::Cs cs=Rpi::Dma::Cs()) ;
+
+    void stop() ;
+
+    struct Status
+    {
+	uint64_t   played ; // number of buffers completed
+	uint64_t underrun ; // number of buffers sent again
+	size_t   headroom ; // filled buffers ahead of the DMA
+	size_t   low ;      // the least headroom seen (when polled)
+    } ;
+
+    // update the read position
+    Status poll() ;
+
+    size_t nbuffers() const { return this->m ; }
+
+    size_t nwords() const { return this->n ; }
+
+private:
+
+    Rpi::Bus::Memory::shared_ptr memory ; // the buffers
+    Rpi::Bus::Memory::shared_ptr blocks ; // the control blocks
+
+    Rpi::Dma::Channel channel ;
+    // ...(destructed before the memory) stops the DMA
+    
+    size_t n ; // words per buffer
+    size_t m ; // number of buffers
+
+    std::vector<uint32_t> cbAddr ; // bus address of each block
+    std::vector<size_t> cbBuffer ; // the buffer of each block
+
+    uint32_t volatile *buffer ; // (virtual) address of the first buffer
+
+    bool running ;
+
+    uint64_t head ; // the buffer in progress (turns included)
+    uint64_t tail ; // the next buffer to fill (turns included)
+
+    uint64_t underrun ; size_t low ;
+} ;
+
+}
+
+#endif // INCLUDE_RpiExt_PwmStream_h
@@ -2,27 +2,49 @@
 
 #include "Serialize.h"
 
+uint32_t RpiExt::Serialize::poll()
+{
+    auto t = this->timer.counter().read() ;
+    if (this->jitter != nullptr && !this->jitter->next(t))
+	this->overrun = true ;
+    return t ;
+}
+
 bool RpiExt::Serialize::send(uint32_t *t0,Edge const &edge)
 {
-    auto t1 = this->timer.counter().read() ;
+    auto t1 = this->poll() ;
     while (t1 - (*t0) < edge.t_min)
-	t1 = this->timer.counter().read() ;
-
-    auto hi = (edge.level == Rpi::Register::Gpio::Output::Level::Hi) ;
-    if (hi) (*this->raise) = edge.pins ;
-    else    (*this->clear) = edge.pins ;
+    {
+	if (this->overrun)
+	    return false ;
+	t1 = this->poll() ;
+    }
     
-    auto t2 = this->timer.counter().read() ;
-    auto success = t2 - (*t0) <= edge.t_max ;
+    namespace Output = Rpi::Register::Gpio::Output ;
+    auto hi = (edge.level == Output::Level::Hi) ;
+    if (hi) (*this->gpio.at<Output::Raise0>().value()) = edge.pins ;
+    else    (*this->gpio.at<Output::Clear0>().value()) = edge.pins ;
+    
+    auto t2 = this->poll() ;
+    auto success = t2 - (*t0) <= edge.t_max && !this->overrun ;
     (*t0) = t2 ;
     return success ;
 }
 
+uint32_t RpiExt::Serialize::start()
+{
+    auto t = this->timer.counter().read() ;
+    this->overrun = false ;
+    if (this->jitter != nullptr)
+	this->jitter->start(t) ;
+    return t ;
+}
+
 bool RpiExt::Serialize::send(std::vector<Edge> const &v)
 {
     auto success = true ;
     auto p = v.cbegin() ;
-    auto t = this->timer.counter().read() ;
+    auto t = this->start() ;
     while (success && (p != v.end()))
     {
 	success = this->send(&t,*p++) ;
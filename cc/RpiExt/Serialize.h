@@ -27,6 +27,10 @@
 //
 // For the next tuple, the timer values are re-used: t0=t2,t1=t3.
 //
+// The tuples may also be pulled one by one from a source (see pull).
+// The next tuple is then generated while the current level is hold;
+// i.e. there is no need to materialize the whole sequence beforehand.
+//
 // A bit-banged operation may fail any time due to process suspension.
 // Besides, cache faults and interrupts may occur. The caller may try
 // again from the beginning, if a maximum timing was exceeded. Anyway,
@@ -38,6 +42,7 @@
 
 #include <Rpi/ArmTimer.h>
 #include <Rpi/Register.h>
+#include <RpiExt/Jitter.h>
 #include <vector>
 
 namespace RpiExt { 
@@ -57,20 +62,50 @@ struct Serialize
     } ;
 
     Serialize(Rpi::Peripheral *rpi)
-	: clear(rpi->at<Rpi::Register::Gpio::Output::Clear0>().value())
-	, raise(rpi->at<Rpi::Register::Gpio::Output::Raise0>().value())
-	, timer(rpi) {}
+	: gpio(rpi->page<Rpi::Register::Gpio::PageNo>())
+	, timer(rpi), jitter(nullptr), overrun(false) {}
 
     bool send(std::vector<Edge> const &v) ;
+
+    // the source is a callable bool(Edge*) that returns false at the
+    // end of the sequence; it's invoked right after the level was set
+    // (i.e. within the next level's minimum period)
+    template<typename Source> bool pull(Source &&source) ;
+
+    // track the gaps between counter reads (see Jitter); send()
+    // fails immediately if the bound is exceeded
+    void monitor(Jitter *jitter) { this->jitter = jitter ; }
+
+    // whether the last send() failed due to the jitter bound
+    bool preempted() const { return this->overrun ; }
   
 private:
 
-    uint32_t volatile * clear ;
-    uint32_t volatile * raise ;
+    Rpi::Register::Base<Rpi::Register::Gpio::PageNo> gpio ;
     Rpi::ArmTimer timer ;
 
+    Jitter *jitter ; bool overrun ;
+
+    uint32_t poll() ;
+
+    uint32_t start() ;
+
     bool send(uint32_t *t0,Edge const &edge) ;
     
-} ; } 
+} ;
+
+template<typename Source> bool Serialize::pull(Source &&source)
+{
+    Edge edge(0,0,0,Rpi::Register::Gpio::Output::Level::Lo) ;
+    auto success = true ;
+    auto t = this->start() ;
+    while (success && source(&edge))
+    {
+	success = this->send(&t,edge) ;
+    }
+    return success ;
+}
+
+} 
 
 #endif // INCLUDE_RpiExt_Serialize_h
@@ -0,0 +1,63 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// Executes a Bang script on a virtual bus (see Sim::Bus); that is, in
+// virtual time and against device models. It is the same interpreter
+// as Bang::execute(std::vector<Command> const&) with Sim::Port as bus
+// backend. Compiled Programs are bound to a peripheral window and
+// can't be executed.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_RpiExt_Sim_Bang_h
+#define INCLUDE_RpiExt_Sim_Bang_h
+
+#include "Bus.h"
+#include <RpiExt/Bang.h>
+
+namespace RpiExt {
+
+namespace Sim {
+
+// the virtual bus as bus backend (see Bang::Interpreter)
+struct Port
+{
+    Port(Bus *bus) : bus(bus) {}
+
+    uint32_t counter() { return this->bus->counter() ; }
+
+    uint32_t levels() { return this->bus->levels() ; }
+
+    void set(uint32_t pins) { this->bus->set(pins) ; }
+
+    void reset(uint32_t pins) { this->bus->reset(pins) ; }
+
+    void mode(Rpi::Gpio::Function::Update const &update)
+    {
+	this->bus->mode(update) ;
+    }
+
+    void idle(uint32_t t0,uint32_t span,bool levels)
+    {
+	auto cost = this->bus->cost().counter ;
+	if (levels)
+	    cost += this->bus->cost().read ;
+	this->bus->skip(cost,t0,span) ;
+    }
+
+private:
+
+    Bus *bus ;
+} ;
+
+}
+
+struct Bang::Virtual : Bang::Interpreter<Sim::Port>
+{
+    Virtual(Sim::Bus *bus) : Interpreter(Sim::Port(bus)) {}
+} ;
+// ...don't monitor() a virtual bus: skipped busy-waits look like
+//    preemptions (there is no preemption in virtual time anyway)
+
+}
+
+#endif // INCLUDE_RpiExt_Sim_Bang_h
@@ -0,0 +1,168 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Bus.h"
+#include <cassert>
+
+constexpr uint64_t RpiExt::Sim::Model::Never ;
+
+RpiExt::Sim::Bus::Bus(Cost const &cost)
+    : c(cost),t(0),output(0),latch(0),wire(~0u),status(0)
+{
+    for (auto &r : this->fsel) r = 0 ;
+    for (auto &r : this->detectA) r = 0 ;
+}
+
+void RpiExt::Sim::Bus::attach(Model *model)
+{
+    this->models.push_back(model) ;
+    this->refresh() ;
+}
+
+uint32_t RpiExt::Sim::Bus::counter()
+{
+    this->elapse(this->c.counter) ;
+    return static_cast<uint32_t>(this->t) ;
+}
+
+uint32_t RpiExt::Sim::Bus::levels()
+{
+    this->elapse(this->c.read) ;
+    this->refresh() ;
+    return this->wire ;
+}
+
+void RpiExt::Sim::Bus::set(uint32_t pins)
+{
+    this->elapse(this->c.write) ;
+    this->latch |= pins ;
+    this->refresh() ;
+}
+
+void RpiExt::Sim::Bus::reset(uint32_t pins)
+{
+    this->elapse(this->c.write) ;
+    this->latch &= ~pins ;
+    this->refresh() ;
+}
+
+void RpiExt::Sim::Bus::mode(Rpi::Gpio::Function::Update const &update)
+{
+    this->elapse(this->c.write) ;
+    auto &r = this->fsel[update.bank] ;
+    if (update.keep == 0) r = update.bits ;
+    else                  r = (r & update.keep) | update.bits ;
+    this->output = 0 ;
+    for (unsigned pin=0 ; pin<32 ; ++pin)
+    {
+	auto type = (this->fsel[pin/10] >> (3*(pin%10))) & 0x7u ;
+	if (type == static_cast<unsigned>(Rpi::Gpio::Function::Type::Out))
+	    this->output |= 1u << pin ;
+    }
+    this->refresh() ;
+}
+
+void RpiExt::Sim::Bus::detect(uint32_t pins,Rpi::Register::Gpio::Event::Type type,bool enable)
+{
+    this->elapse(this->c.write) ;
+    using Type = Rpi::Register::Gpio::Event::Type ;
+    auto i = 0u ;
+    switch (type)
+    {
+    case Type::     Rise: case Type::AsyncRise: i = 0 ; break ;
+    case Type::     Fall: case Type::AsyncFall: i = 1 ; break ;
+    case Type::     High: i = 2 ; break ;
+    case Type::      Low: i = 3 ; break ;
+    }
+    if (enable) this->detectA[i] |=  pins ;
+    else        this->detectA[i] &= ~pins ;
+    this->refresh() ;
+}
+
+uint32_t RpiExt::Sim::Bus::events(uint32_t mask)
+{
+    this->elapse(this->c.read) ;
+    this->refresh() ;
+    auto events = mask & this->status ;
+    if (events != 0)
+    {
+	this->elapse(this->c.write) ;
+	this->status &= ~events ;
+	this->refresh() ; // ...High and Low are raised again
+    }
+    return events ;
+}
+
+void RpiExt::Sim::Bus::elapse(uint64_t ticks)
+{
+    auto target = this->t + ticks ;
+    auto n = this->next() ;
+    while (n <= target)
+    {
+	assert(n >= this->t) ;
+	this->t = n ;
+	this->refresh() ;
+	auto m = this->next() ;
+	assert(m > n) ; // ...the model must advance
+	n = m ;
+    }
+    this->t = target ;
+}
+
+uint64_t RpiExt::Sim::Bus::next() const
+{
+    auto n = Model::Never ;
+    for (auto m : this->models)
+    {
+	auto x = m->next() ;
+	if (x < n)
+	    n = x ;
+    }
+    return n ;
+}
+
+uint32_t RpiExt::Sim::Bus::wait(uint32_t t,uint32_t t0,uint32_t span)
+{
+    if (t - t0 >= span)
+	return t ;
+    auto e = static_cast<uint32_t>(this->t) - t0 ;
+    auto r = (e < span) ? span - e : 0u ;
+    if (this->c.counter == 0)
+	this->elapse(r) ;
+    else if (r > this->c.counter)
+	this->elapse(uint64_t(r - 1) / this->c.counter * this->c.counter) ;
+    // ...all reads but the last one
+    t = this->counter() ;
+    while (t - t0 < span)
+	t = this->counter() ;
+    return t ;
+}
+
+void RpiExt::Sim::Bus::skip(uint32_t cost,uint32_t t0,uint32_t span)
+{
+    if (cost == 0)
+	return ;
+    auto e = static_cast<uint32_t>(this->t) - t0 ;
+    if (e >= span)
+	return ;
+    auto until = this->t + (span - e) ;
+    auto n = this->next() ;
+    if (n < until)
+	until = n ;
+    auto k = (until - this->t) / cost ;
+    if (k > 1)
+	this->elapse((k-1) * cost) ;
+}
+
+void RpiExt::Sim::Bus::refresh()
+{
+    auto levels = (this->latch & this->output) | ~this->output ;
+    for (auto m : this->models)
+	levels = m->update(this->t,levels) ;
+    auto rise = levels & ~this->wire ;
+    auto fall = ~levels & this->wire ;
+    this->status |= this->detectA[0] & rise ;
+    this->status |= this->detectA[1] & fall ;
+    this->status |= this->detectA[2] & levels ;
+    this->status |= this->detectA[3] & ~levels ;
+    this->wire = levels ;
+}
@@ -0,0 +1,145 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// A deterministic virtual-time GPIO bus to execute bit-banging code
+// off-target (see Bang::Virtual and Sim::Io) against behavioral
+// device models.
+//
+// Time is counted in ARM counter ticks. It advances only by the
+// (configurable) costs of the peripheral accesses; a busy-wait is
+// skipped at once. The result is reproducible and independent of
+// the build host's load.
+//
+// Pin levels: a pin in Output mode is driven by the output latch
+// (Set/Reset). Any other pin is considered to be pulled-up. The
+// device models apply their own drivers on top of that.
+//
+// The GPIO event detection (Rise, Fall, High, Low) is emulated for
+// the levels as they come up on the bus. The asynchronous variants
+// behave the same as the synchronous ones.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_RpiExt_Sim_Bus_h
+#define INCLUDE_RpiExt_Sim_Bus_h
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <Rpi/Gpio/Function.h>
+#include <Rpi/Register.h>
+
+namespace RpiExt { namespace Sim {
+
+struct Model
+{
+    static constexpr uint64_t Never = std::numeric_limits<uint64_t>::max() ;
+
+    // the bus levels (i.e. the host's drivers, the pull-ups and the
+    // drivers of the models attached before) at time t; t doesn't
+    // decrease; returns the levels with the model's drivers applied
+    virtual uint32_t update(uint64_t t,uint32_t levels) = 0 ;
+
+    // the next time the model changes its drivers on its own (if any)
+    virtual uint64_t next() const { return Never ; }
+
+    // the time a transaction needs at least (with the datasheet's
+    // timing) for all the transactions seen so far
+    virtual uint64_t minimum() const = 0 ;
+
+    struct Violation
+    {
+	uint64_t t ; char const *what ;
+	Violation(uint64_t t,char const *what) : t(t),what(what) {}
+    } ;
+
+    std::vector<Violation> const& violations() const { return this->v ; }
+
+    virtual ~Model() {}
+
+protected:
+
+    void violate(uint64_t t,char const *what)
+    {
+	this->v.push_back(Violation(t,what)) ;
+    }
+
+private:
+
+    std::vector<Violation> v ;
+} ;
+
+struct Bus
+{
+    struct Cost // in ticks (rough defaults, see Throughput)
+    {
+	uint32_t counter ; // read the ARM counter
+	uint32_t    read ; // read a GPIO register
+	uint32_t   write ; // write a GPIO register
+
+	Cost(uint32_t counter=12,uint32_t read=12,uint32_t write=4)
+	    : counter(counter),read(read),write(write) {}
+    } ;
+
+    Bus(Cost const &cost=Cost()) ;
+
+    void attach(Model *model) ;
+
+    uint64_t now() const { return this->t ; }
+
+    Cost const& cost() const { return this->c ; }
+
+    // ---- the peripheral accesses (each at its cost) ----
+
+    uint32_t counter() ;
+
+    uint32_t levels() ;
+
+    void set(uint32_t pins) ;
+
+    void reset(uint32_t pins) ;
+
+    void mode(Rpi::Gpio::Function::Update const &update) ;
+
+    void detect(uint32_t pins,Rpi::Register::Gpio::Event::Type type,bool enable) ;
+
+    uint32_t events(uint32_t mask) ; // read and clear
+
+    // ---- virtual time ----
+
+    // advance the time (the models may change their drivers)
+    void elapse(uint64_t ticks) ;
+
+    // the time of the next change on the bus (if there is none by
+    // the host); that is, polls before that time can be skipped
+    uint64_t next() const ;
+
+    // busy-wait: read the counter until (counter - t0) >= span; t is
+    // the counter value read last; the last read value is returned
+    uint32_t wait(uint32_t t,uint32_t t0,uint32_t span) ;
+
+    // skip the iterations of a polling loop (with the given cost per
+    // iteration) that can't see any change (until t0+span at most)
+    void skip(uint32_t cost,uint32_t t0,uint32_t span) ;
+
+private:
+
+    Cost c ;
+
+    uint64_t t ; // current time
+
+    uint32_t fsel[6] ; // GPFSEL0..5
+    uint32_t output ;  // pins in Output mode
+    uint32_t latch ;   // output latch
+    uint32_t wire ;    // the levels on the bus
+
+    uint32_t detectA[4] ; // enabled event detection (Rise,Fall,High,Low)
+    uint32_t status ;     // event status
+
+    std::vector<Model*> models ;
+
+    void refresh() ;
+} ;
+
+} }
+
+#endif // INCLUDE_RpiExt_Sim_Bus_h
@@ -0,0 +1,133 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// The counterpart of RpiExt::BangIo on a virtual bus (see Sim::Bus):
+// the same methods with the same semantics; however, in virtual time.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_RpiExt_Sim_Io_h
+#define INCLUDE_RpiExt_Sim_Io_h
+
+#include "Bus.h"
+
+namespace RpiExt { namespace Sim {
+
+struct Io
+{
+    void detect(Rpi::Pin pin,Rpi::Register::Gpio::Event::Type type,bool enable=true)
+    {
+	this->bus->detect(1u << pin.value(),type,enable) ;
+    }
+
+    uint32_t events(uint32_t mask)
+    {
+	return this->bus->events(mask) ;
+    }
+
+    uint32_t levels()
+    {
+	return this->bus->levels() ;
+    }
+
+    void mode(Rpi::Pin pin,Rpi::Gpio::Function::Type mode)
+    {
+	this->bus->mode(Rpi::Gpio::Function::Update(pin,mode)) ;
+    }
+
+    void mode(Rpi::Gpio::Function::Update const &update)
+    {
+	this->bus->mode(update) ;
+    }
+
+    void mode(Rpi::Gpio::Function::Switch const &s)
+    {
+	for (auto &u : s)
+	    this->bus->mode(u) ;
+    }
+
+    bool preempted() const { return false ; }
+
+    void resume() {}
+    // ...there is no preemption in virtual time (see BangIo::monitor)
+
+    uint32_t recent() const
+    {
+	return this->t ;
+    }
+
+    void reset(uint32_t pins)
+    {
+	this->bus->reset(pins) ;
+    }
+
+    void set(uint32_t pins)
+    {
+	this->bus->set(pins) ;
+    }
+
+    void sleep(uint32_t span)
+    {
+	if (span > 0)
+	{
+	    auto t0 = this->time() ;
+	    this->t = this->bus->wait(t0,t0,span) ;
+	}
+    }
+
+    uint32_t time()
+    {
+	return this->t = this->bus->counter() ;
+    }
+
+    void wait(uint32_t t0,uint32_t span)
+    {
+	this->t = this->bus->wait(this->t,t0,span) ;
+    }
+
+    uint32_t waitForEvent(uint32_t t0,uint32_t span,uint32_t mask)
+    {
+	auto cost = this->bus->cost().read + this->bus->cost().counter ;
+	do
+	{
+	    auto events = this->bus->events(mask) ;
+	    if (events != 0)
+		return events ;
+	    this->t = this->bus->counter() ;
+	    this->bus->skip(cost,t0,span) ;
+	}
+	while (this->t - t0 <= span) ;
+	return 0 ;
+    }
+
+    uint32_t waitForLevel(uint32_t t0,uint32_t span,uint32_t mask,uint32_t cond)
+    {
+	auto cost = this->bus->cost().read + this->bus->cost().counter ;
+	do
+	{
+	    this->l = this->bus->levels() ;
+	    if (cond == (this->l & mask))
+	    {
+		auto tx = this->t ;
+		this->t = this->bus->counter() ;
+		return tx ;
+	    }
+	    this->t = this->bus->counter() ;
+	    this->bus->skip(cost,t0,span) ;
+	}
+	while (this->t - t0 <= span) ;
+	return this->t ;
+    }
+
+    Io(Bus *bus) : bus(bus),t(bus->counter()),l(0) {}
+
+private:
+
+    Bus *bus ;
+
+    uint32_t t ; // last read time-stamp
+    uint32_t l ; // last read GPIO level
+} ;
+
+} }
+
+#endif // INCLUDE_RpiExt_Sim_Io_h
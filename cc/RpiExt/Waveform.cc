@@ -0,0 +1,240 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+#include "Waveform.h"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <thread>
+
+RpiExt::Waveform::Waveform(Pacing const &pacing)
+    : pacing(pacing),words(1,0),model{0,0},t_edge(0)
+{
+    if (pacing.period == 0)
+	throw Error("zero period") ;
+    if (pacing.threshold == 0)
+	throw Error("zero threshold") ;
+    this->delay(pacing.threshold) ;
+    // ...fill the FIFO up to the threshold; all following words are
+    //    paced
+}
+
+void RpiExt::Waveform::step(Model *m,Cb const &cb) const
+{
+    auto period = uint64_t(this->pacing.period) ;
+    auto limit = (this->pacing.threshold - 1) * period ;
+    // ...the DREQ is asserted if the FIFO drains within this time
+    m->t += this->pacing.overhead ;
+    auto ti = Rpi::Dma::Ti::Word::coset(cb.ti) ;
+    if (0 == Rpi::Dma::Ti::DestDreq(ti).count())
+	return ;
+    uint64_t nwords = cb.len / sizeof(uint32_t) ;
+    // the words that are taken at once (below the threshold)
+    while (nwords > 0 && m->tq <= m->t + limit)
+    {
+	m->tq = std::max(m->tq,m->t) + period ;
+	--nwords ;
+    }
+    // each other word waits for the FIFO to drain by one word
+    if (nwords > 0)
+    {
+	m->t = m->tq + (nwords-1) * period - limit ;
+	m->tq += nwords * period ;
+    }
+}
+
+void RpiExt::Waveform::add(Edge const &edge)
+{
+    // the least delay (if any) so the edge doesn't come too early
+    auto target = this->t_edge + edge.t_min ;
+    auto overhead = uint64_t(this->pacing.overhead) ;
+    if (this->model.t + overhead < target)
+    {
+	auto period = uint64_t(this->pacing.period) ;
+	auto limit = (this->pacing.threshold - 1) * period ;
+	auto m = this->model ;
+	m.t += overhead ; // ...the delay's block
+	uint64_t nwords = 1 ;
+	if (m.t + overhead < target)
+	{
+	    // the words that are taken at once
+	    nwords = 0 ;
+	    while (m.tq <= m.t + limit)
+	    {
+		m.tq = std::max(m.tq,m.t) + period ;
+		++nwords ;
+	    }
+	    // the edge's time with one further word
+	    auto t = m.tq - limit + overhead ;
+	    ++nwords ;
+	    // ...and each further word takes a period
+	    if (t < target)
+		nwords += (target - t + period - 1) / period ;
+	}
+	if (nwords >= (1u << 28))
+	    throw Error("delay out of range") ;
+	this->delay(static_cast<uint32_t>(nwords)) ;
+    }
+
+    namespace Output = Rpi::Register::Gpio::Output ;
+    auto hi = (edge.level == Output::Level::Hi) ;
+    Cb cb ;
+    cb.ti = Rpi::Dma::Ti::WaitResp::make<1>().word().value() ;
+    // ...the write completes before the next block is fetched
+    cb.src = this->word(edge.pins) ;
+    cb.dst = hi ? Output::Raise0::Address.value() : Output::Clear0::Address.value() ;
+    cb.len = sizeof(uint32_t) ;
+    cb.stride = 0 ;
+    cb.next = 0 ;
+    cb.reserved[0] = cb.reserved[1] = 0 ;
+    this->chain.push_back(cb) ;
+    this->step(&this->model,cb) ;
+    this->t_edge = this->model.t ;
+    this->edges.push_back(edge) ;
+}
+
+void RpiExt::Waveform::delay(uint32_t nwords)
+{
+    if (nwords >= (1u << 28))
+	throw Error("delay out of range") ;
+    if (nwords == 0)
+	return ;
+    // ...TXFR_LEN is 30 bits wide
+    auto ti = Rpi::Dma::Ti::make(this->pacing.permap) ;
+    ti %= Rpi::Dma::Ti::SrcInc::make<0>() ; // ...the same zero-word
+    Cb cb ;
+    cb.ti = ti.value() ;
+    cb.src = 0 ;
+    cb.dst = this->pacing.fifo.value() ;
+    cb.len = nwords * sizeof(uint32_t) ;
+    cb.stride = 0 ;
+    cb.next = 0 ;
+    cb.reserved[0] = cb.reserved[1] = 0 ;
+    this->chain.push_back(cb) ;
+    this->step(&this->model,cb) ;
+}
+
+uint32_t RpiExt::Waveform::word(uint32_t value)
+{
+    for (size_t i=1 ; i<this->words.size() ; ++i)
+	if (this->words[i] == value)
+	    return static_cast<uint32_t>(i) ;
+    this->words.push_back(value) ;
+    return static_cast<uint32_t>(this->words.size() - 1) ;
+}
+
+RpiExt::Waveform::Image
+RpiExt::Waveform::link(std::function<uint32_t(size_t)> const &addr) const
+{
+    Image image ;
+    image.chain = this->chain ;
+    auto n = this->chain.size() ;
+    for (size_t i=0 ; i<n ; ++i)
+	image.cbAddr.push_back(addr(i * sizeof(Cb))) ;
+    for (size_t i=0 ; i<this->words.size() ; ++i)
+	image.wordAddr.push_back(addr(n * sizeof(Cb) + i * sizeof(uint32_t))) ;
+    for (size_t i=0 ; i<n ; ++i)
+    {
+	auto &cb = image.chain[i] ;
+	cb.src = image.wordAddr.at(cb.src) ;
+	cb.next = (i+1 < n) ? image.cbAddr[i+1] : 0 ;
+    }
+    return image ;
+}
+
+void RpiExt::Waveform::load(Rpi::Bus::Memory::Allocator *allocator)
+{
+    auto n = this->chain.size() ;
+    auto nbytes = n * sizeof(Cb) + this->words.size() * sizeof(uint32_t) ;
+    auto memory = allocator->allocate(nbytes) ;
+    auto image = this->link([&memory](size_t ofs) {
+	    auto section = memory->phys(ofs) ;
+	    if ((section.first.value() & 0x1f) != 0 && ofs % sizeof(Cb) == 0)
+		throw Error("control block not 32-byte aligned") ;
+	    return section.first.value() ; }) ;
+
+    auto p = memory->as<uint32_t volatile*>() ;
+    for (auto &cb : image.chain)
+    {
+	auto q = reinterpret_cast<uint32_t const*>(&cb) ;
+	for (size_t i=0 ; i<8 ; ++i)
+	    (*p++) = q[i] ;
+    }
+    for (auto w : this->words)
+	(*p++) = w ;
+
+    this->image = image ;
+    this->memory = memory ;
+}
+
+std::vector<RpiExt::Waveform::Event> RpiExt::Waveform::timeline() const
+{
+    auto image = this->memory
+	? this->image
+	: this->link([](size_t ofs) { return static_cast<uint32_t>(0xc0000000u + ofs) ; }) ;
+    // ...an arbitrary (uncached) bus address if not loaded
+
+    std::map<uint32_t,size_t> cbIndex,wordIndex ;
+    for (size_t i=0 ; i<image.cbAddr.size() ; ++i)
+	cbIndex[image.cbAddr[i]] = i ;
+    for (size_t i=0 ; i<image.wordAddr.size() ; ++i)
+	wordIndex[image.wordAddr[i]] = i ;
+
+    namespace Output = Rpi::Register::Gpio::Output ;
+    auto const raise = Output::Raise0::Address.value() ;
+    auto const clear = Output::Clear0::Address.value() ;
+    
+    std::vector<Event> v ;
+    Model m{0,0} ;
+    auto addr = image.cbAddr.empty() ? 0u : image.cbAddr[0] ;
+    size_t count = 0 ;
+    while (addr != 0)
+    {
+	if (++count > image.chain.size())
+	    throw Error("loop in chain") ;
+	auto &cb = image.chain[cbIndex.at(addr)] ;
+	this->step(&m,cb) ;
+	if (cb.dst == raise || cb.dst == clear)
+	{
+	    Event e ;
+	    e.t = m.t ;
+	    e.level = (cb.dst == raise) ? Output::Level::Hi : Output::Level::Lo ;
+	    e.pins = this->words.at(wordIndex.at(cb.src)) ;
+	    v.push_back(e) ;
+	}
+	addr = cb.next ;
+    }
+    return v ;
+}
+
+size_t RpiExt::Waveform::verify() const
+{
+    auto v = this->timeline() ;
+    if (v.size() != this->edges.size())
+	return std::min(v.size(),this->edges.size()) ;
+    uint64_t t0 = 0 ;
+    for (size_t i=0 ; i<v.size() ; ++i)
+    {
+	auto &edge = this->edges[i] ;
+	auto d = v[i].t - t0 ;
+	if (d < edge.t_min || d > edge.t_max)
+	    return i ;
+	if (v[i].level != edge.level || v[i].pins != edge.pins)
+	    return i ;
+	t0 = v[i].t ;
+    }
+    return static_cast<size_t>(-1) ;
+}
+
+void RpiExt::Waveform::submit(Rpi::Dma::Channel *channel,Rpi::Dma::Cs cs)
+{
+    if (!this->memory)
+	throw Error("not loaded") ;
+    channel->setup(Rpi::Bus::Address(this->image.cbAddr.at(0)),cs) ;
+    channel->start() ;
+}
+
+void RpiExt::Waveform::wait(Rpi::Dma::Channel *channel)
+{
+    while (0 != (channel->getCs().active().bits()))
+	std::this_thread::sleep_for(std::chrono::milliseconds(1)) ;
+}
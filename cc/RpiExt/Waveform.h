@@ -0,0 +1,159 @@
+// BSD 2-Clause License, see github.com/ma16/rpio
+
+// --------------------------------------------------------------------
+// A hardware-timed counterpart of RpiExt::Serialize: the same sequence
+// of edges is compiled into a chain of DMA control blocks.
+//
+// * An edge is a single (unpaced) write of the pins word to GPSET0 or
+//   GPCLR0.
+// * A delay is a paced dummy transfer (of zero-words) to the FIFO of
+//   a peripheral that issues a DREQ (e.g. the PWM). Each word takes
+//   one period of the peripheral (e.g. one PWM range cycle).
+// * The peripheral asserts the DREQ as long as its FIFO holds less
+//   words than the threshold; i.e. the words up to the threshold are
+//   taken at once. The chain starts with that many words.
+// * Each control block takes a fixed overhead (the fetch of the block
+//   and its transfer).
+//
+// The CPU isn't involved (no jitter, no preemption); however, the
+// resolution is the period. The delays are sized by a model of the
+// FIFO and the overhead, so each edge meets its t_min; timeline()
+// replays the chain on the same model and verify() checks it against
+// (t_min,t_max) of each edge. The model is only as good as the
+// overhead estimate though: the bus load of other masters isn't
+// accounted for.
+//
+// The peripheral that paces the transfer must be set up beforehand:
+// e.g. the PWM in serializer mode with DMA enabled (DMAC.ENAB=1) and
+// with a range that matches the period.
+// --------------------------------------------------------------------
+
+#ifndef INCLUDE_RpiExt_Waveform_h
+#define INCLUDE_RpiExt_Waveform_h
+
+#include <Rpi/Bus/Memory.h>
+#include <Rpi/Dma/Ctrl.h>
+#include <RpiExt/Serialize.h>
+#include <functional>
+#include <vector>
+
+namespace RpiExt {
+
+struct Waveform
+{
+    struct Error : Neat::Error
+    {
+	Error(std::string const &s) : Neat::Error("RpiExt:Waveform:" + s) {}
+    } ;
+
+    using Edge = Serialize::Edge ;
+
+    struct Pacing
+    {
+	Rpi::Dma::Ti::Permap permap ; // the DREQ
+	Rpi::Bus::Address fifo ;      // the FIFO to write dummy words to
+	uint32_t period ;             // ARM counter ticks per word
+	uint32_t threshold ;          // DREQ while the FIFO holds less words
+	uint32_t overhead ;           // ARM counter ticks per control block
+
+	Pacing(Rpi::Dma::Ti::Permap permap,Rpi::Bus::Address fifo,uint32_t period,uint32_t threshold,uint32_t overhead)
+	    : permap(permap),fifo(fifo),period(period),threshold(threshold),overhead(overhead) {}
+
+	// the PWM's DMAC.DREQ threshold defaults to 7
+	static Pacing pwm(uint32_t period,uint32_t overhead,uint32_t threshold=7)
+	{
+	    return Pacing(Rpi::Dma::Ti::Pwm,Rpi::Register::Pwm::Fifo::Address,period,threshold,overhead) ;
+	}
+    } ;
+
+    Waveform(Pacing const &pacing) ;
+
+    void add(Edge const &edge) ;
+
+    // a source as for Serialize::pull
+    template<typename Source> void addAll(Source &&source)
+    {
+	Edge edge(0,0,0,Rpi::Register::Gpio::Output::Level::Lo) ;
+	while (source(&edge))
+	    this->add(edge) ;
+    }
+
+    // ---- the DMA control block chain ----
+
+    struct Cb
+    {
+	uint32_t ti,src,dst,len,stride,next,reserved[2] ;
+    } ;
+
+    size_t size() const { return this->chain.size() ; }
+
+    Cb const& at(size_t i) const { return this->chain.at(i) ; }
+
+    // copy the chain to bus memory (and link the blocks)
+    void load(Rpi::Bus::Memory::Allocator *allocator) ;
+
+    // ---- offline verification ----
+
+    struct Event
+    {
+	uint64_t t ; // ARM counter ticks since start
+	Rpi::Register::Gpio::Output::Level level ;
+	uint32_t pins ;
+    } ;
+
+    // the GPIO writes as the DMA controller executes the chain (the
+    // chain is walked by its links, i.e. as loaded; or as if it was
+    // loaded to contiguous memory, if not loaded yet)
+    std::vector<Event> timeline() const ;
+
+    // the index of the first edge that doesn't meet its timing
+    // (or size_t(-1) if there is none)
+    size_t verify() const ;
+
+    // ---- execution ----
+
+    void submit(Rpi::Dma::Channel *channel,Rpi::Dma::Cs cs=Rpi::Dma::Cs()) ;
+
+    // poll (every millisecond) until the channel gets inactive
+    static void wait(Rpi::Dma::Channel *channel) ;
+
+private:
+
+    Pacing pacing ;
+
+    std::vector<Cb> chain ; // src: index into words (before linking)
+
+    std::vector<uint32_t> words ; // [0]=zero, [1..]=pins
+
+    std::vector<Edge> edges ; // for verification
+
+    struct Model
+    {
+	uint64_t t ;  // the DMA's progress (ARM counter ticks)
+	uint64_t tq ; // the FIFO runs empty (if no word follows)
+    } ;
+
+    Model model ; uint64_t t_edge ; // ...after the last block and edge
+
+    // the DMA executes the block
+    void step(Model *m,Cb const &cb) const ;
+
+    struct Image // the chain as placed in (bus) memory
+    {
+	std::vector<Cb> chain ;
+	std::vector<uint32_t> cbAddr,wordAddr ;
+    } ;
+
+    Image image ; Rpi::Bus::Memory::shared_ptr memory ;
+
+    void delay(uint32_t nwords) ;
+
+    uint32_t word(uint32_t value) ;
+
+    // place the chain at the given offsets (from the first block)
+    Image link(std::function<uint32_t(size_t ofs)> const &addr) const ;
+} ;
+
+}
+
+#endif // INCLUDE_RpiExt_Waveform_h
@@ -27,7 +27,11 @@ namespace arm
     // of specific stores to the memory system has to be controlled. For
     // example, when a store to an interrupt acknowledge location must
     // be completed before interrupts are enabled.
+#if defined(__arm__)
     __asm__ __volatile__ ("mcr p15,#0,%0,c7,c10,#4" : : "r" (0) : "memory") ;
+#else
+    __atomic_thread_fence(__ATOMIC_SEQ_CST) ; // off-target build host
+#endif
   }
 
   inline void dmb()
@@ -37,7 +41,11 @@ namespace arm
     // any following explicit memory transactions begin. This ensures
     // that data in memory is up to date before any memory transaction
     // that depends on it. 
+#if defined(__arm__)
     __asm__ __volatile__ ("mcr p15,#0,%0,c7,c10,#5" : : "r" (0) : "memory") ;
+#else
+    __atomic_thread_fence(__ATOMIC_SEQ_CST) ; // off-target build host
+#endif
   }
 
   inline void cdcl(void const *begin,void const *end)
@@ -47,7 +55,11 @@ namespace arm
     // transfer stops. This address is at the start of the line
     // containing the last address to be handled by the block transfer.
     // It uses the VA bits [31:5].
+#if defined(__arm__)
     __asm__ __volatile__ ("mcrr p15,#0,%0,%1,c12" : : "r"(end),"r"(begin) : "memory" ) ;
+#else
+    (void)begin ; (void)end ; // off-target build host: nothing to clean
+#endif
   }
 
   inline void cache_flush(void const *begin,void const *end)